@@ -44,6 +44,7 @@
 
 
 #define WM_GRAPHNOTIFY (WM_APP + 1)
+#define WM_MINUI_UPDATE (WM_APP + 2)
 
 namespace minui {
 
@@ -228,6 +229,13 @@ void win_d2d_dw_ds::resize_text() {
 		f.format->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_NEAR);
 		f.format->SetLineSpacing(DWRITE_LINE_SPACING_METHOD_UNIFORM, f.info.line_spacing, f.info.baseline);
 		f.format->SetAutomaticFontAxes(DWRITE_AUTOMATIC_FONT_AXES_OPTICAL_SIZE);
+		// the format is shared by every text layout made with this font, which may be created from several
+		// threads during a parallel layout pass, so it is only configured here
+		f.format->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
+		f.format->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP);
+		f.format->SetReadingDirection(left_to_right ? DWRITE_READING_DIRECTION_LEFT_TO_RIGHT : DWRITE_READING_DIRECTION_RIGHT_TO_LEFT);
+		f.format->SetFlowDirection(DWRITE_FLOW_DIRECTION_TOP_TO_BOTTOM);
+		f.format->SetOpticalAlignment(DWRITE_OPTICAL_ALIGNMENT_NO_SIDE_BEARINGS);
 	}
 }
 void win_d2d_dw_ds::finalize_font_collection() {
@@ -421,6 +429,10 @@ void win_d2d_dw_ds::set_locale(native_string_view id) {
 }
 void win_d2d_dw_ds::set_ltr_mode(bool is_ltr) {
 	left_to_right = is_ltr;
+	for(auto& f : font_collection) {
+		if(f.format)
+			f.format->SetReadingDirection(left_to_right ? DWRITE_READING_DIRECTION_LEFT_TO_RIGHT : DWRITE_READING_DIRECTION_RIGHT_TO_LEFT);
+	}
 	++font_generation;
 }
 native_string_view win_d2d_dw_ds::get_locale_name() {
@@ -444,6 +456,10 @@ void win_d2d_dw_ds::on_dpi_change(float new_dpi) {
 	recreate_dpi_dependent_resource();
 	create_window_size_resources();
 	set_ltr_mode(left_to_right);
+
+	// text measures differently in ems at the new size
+	if(minui_root)
+		minui_root->invalidate_measurements();
 }
 
 void win_d2d_dw_ds::recreate_dpi_dependent_resource() {
@@ -744,6 +760,7 @@ void win_d2d_dw_ds::create_window_size_resources() {
 		return;
 
 	safe_release(back_buffer_target);
+	safe_release(canvas);
 
 	// Resize render target buffers
 	d2d_device_context->SetTarget(nullptr);
@@ -768,7 +785,17 @@ void win_d2d_dw_ds::create_window_size_resources() {
 
 	safe_release(back_buffer);
 
-	if(!back_buffer_target)
+	if(SUCCEEDED(hr)) {
+		D2D1_BITMAP_PROPERTIES1 canvas_properties =
+			D2D1::BitmapProperties1(
+				D2D1_BITMAP_OPTIONS_TARGET,
+				D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_IGNORE),
+				dpi, dpi
+			);
+		hr = d2d_device_context->CreateBitmap(D2D1::SizeU(UINT32(client_x), UINT32(client_y)), nullptr, 0, &canvas_properties, &canvas);
+	}
+
+	if(!back_buffer_target || !canvas)
 		std::abort();
 }
 void win_d2d_dw_ds::d2dsetup() {
@@ -801,23 +828,35 @@ void win_d2d_dw_ds::render() {
 	if(!is_suspended) {
 
 		d2d_device_context->BeginDraw();
-		d2d_device_context->SetTarget(back_buffer_target);
+		d2d_device_context->SetTarget(canvas);
 		d2d_device_context->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
-		d2d_device_context->Clear(D2D1::ColorF(0.5f, 0.5f, 0.5f, 1.0f));
 
-			
+		// the root redraws only its damaged regions, through set_damaged_regions
+		if(minui_root)
+			minui_root->render();
+		else
+			d2d_device_context->Clear(D2D1::ColorF(0.5f, 0.5f, 0.5f, 1.0f));
+		set_clip(screen_space_rect{ 0, 0, 0, 0 }, false);
+		if(damage_layer_pushed) {
+			d2d_device_context->PopLayer();
+			damage_layer_pushed = false;
+		}
 
 		d2d_device_context->SetTransform(D2D1::Matrix3x2F::Identity());
 		if(window_border_size != 0 && !brush_collection.empty()) {
 			d2d_device_context->DrawRectangle(D2D1_RECT_F{ window_border_size / 2.0f, window_border_size / 2.0f, float(client_x) - window_border_size / 2.0f, float(client_y) - window_border_size / 2.0f }, brush_collection[0].brush, float(window_border_size), plain_strokes);
 		}
+
+		// the back buffers are discarded on present, so the whole canvas is copied each frame
+		d2d_device_context->SetTarget(back_buffer_target);
+		d2d_device_context->DrawImage(canvas);
 		d2d_device_context->SetTarget(nullptr);
 		hr = d2d_device_context->EndDraw();
 
-		InvalidateRect(m_hwnd, nullptr, FALSE);
-
-		DXGI_PRESENT_PARAMETERS params{ 0, nullptr, nullptr, nullptr };
+		DXGI_PRESENT_PARAMETERS params{ UINT(dirty_rects.size()), dirty_rects.empty() ? nullptr : dirty_rects.data(), nullptr, nullptr };
 		hr = swap_chain->Present1(1, 0, &params);
+		if(hr == S_OK && minui_root)
+			minui_root->on_frame_presented();
 	} else {
 		DXGI_PRESENT_PARAMETERS params{ 0, nullptr, nullptr, nullptr };
 		hr = swap_chain->Present1(1, DXGI_PRESENT_TEST, &params);
@@ -1409,8 +1448,13 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 						 // do nothing
 						break;
 					}
-					if(app->minui_root && app->minui_root->on_mouse_move(layout_position{ app->to_ui_space(app->left_to_right ? float(GET_X_LPARAM(lParam) - app->window_border_size) : float(app->client_x - GET_X_LPARAM(lParam) - app->window_border_size)), app->to_ui_space(float(GET_Y_LPARAM(lParam) - app->window_border_size)) })) {
-						return 0;
+					// probed once the message queue is empty, so a burst of moves costs one probe; until then, whether
+					// the move is consumed is decided by the last probe
+					if(app->minui_root) {
+						auto pos = layout_position{ app->to_ui_space(app->left_to_right ? float(GET_X_LPARAM(lParam) - app->window_border_size) : float(app->client_x - GET_X_LPARAM(lParam) - app->window_border_size)), app->to_ui_space(float(GET_Y_LPARAM(lParam) - app->window_border_size)) };
+						bool consumed = app->minui_root->post_mouse_move(pos) ? app->minui_root->mouse_over_ui() : app->minui_root->on_mouse_move(pos);
+						if(consumed)
+							return 0;
 					}
 					break;
 				}
@@ -1750,11 +1794,15 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 						break;
 					}
 
-					if(app->minui_root && app->minui_root->on_mouse_scroll(float(GET_WHEEL_DELTA_WPARAM(wParam)) / 120.0f)) {
-						return 0;
-					} else {
-						break;
+					// summed with the rest of the burst and handled once the message queue is empty; until then, whether
+					// the scroll is consumed is decided by the last probe
+					if(app->minui_root) {
+						auto amount = float(GET_WHEEL_DELTA_WPARAM(wParam)) / 120.0f;
+						bool consumed = app->minui_root->post_mouse_scroll(amount) ? app->minui_root->mouse_over_ui() : app->minui_root->on_mouse_scroll(amount);
+						if(consumed)
+							return 0;
 					}
+					break;
 				case WM_NCCALCSIZE:
 					if(app->hide_window_elements && wParam == TRUE)
 						return 0;
@@ -1888,6 +1936,10 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 				case WM_INPUT_DEVICE_CHANGE:
 					app->on_device_change(wParam, (HANDLE)lParam);
 					return 0;
+				case WM_MINUI_UPDATE:
+					if(app->minui_root)
+						app->minui_root->request_update();
+					return 0;
 				case WM_APPCOMMAND:
 				{
 					auto cmd = GET_APPCOMMAND_LPARAM(lParam);
@@ -2120,14 +2172,6 @@ arrangement_result win_d2d_dw_ds::create_text_arragement(text::formatted_text_re
 	arrangement_result result;
 
 	auto text_format = font_collection[font.id].format;
-
-	text_format->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
-	text_format->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP);
-	text_format->SetReadingDirection(left_to_right ? DWRITE_READING_DIRECTION_LEFT_TO_RIGHT : DWRITE_READING_DIRECTION_RIGHT_TO_LEFT);
-	text_format->SetFlowDirection(DWRITE_FLOW_DIRECTION_TOP_TO_BOTTOM);
-	text_format->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_NEAR);
-	text_format->SetOpticalAlignment(DWRITE_OPTICAL_ALIGNMENT_NO_SIDE_BEARINGS);
-	text_format->SetLineSpacing(DWRITE_LINE_SPACING_METHOD_UNIFORM, font_collection[font.id].info.line_spacing, font_collection[font.id].info.baseline);
 	
 	dwrite_factory->CreateTextLayout(text.text_content, text.text_length, text_format, max_width, font_collection[font.id].info.line_spacing, &formatted_text);
 
@@ -2162,6 +2206,12 @@ arrangement_result win_d2d_dw_ds::create_text_arragement(text::formatted_text_re
 	return result;
 }
 
+// the root otherwise keeps replaying what the node drew before
+static void redraw_attached(system_interface& s, ui_node const& n) {
+	if(auto r = static_cast<win_d2d_dw_ds&>(s).minui_root; r)
+		invalidate_render(*r, n);
+}
+
 void dw_static_text_provider::set_text(system_interface& s, text::formatted_text&& t) {
 	if(internal_text.text_content != t.text_content) {
 		internal_text = std::move(t);
@@ -2171,19 +2221,29 @@ void dw_static_text_provider::set_text(system_interface& s, text::formatted_text
 		layout = res.ptr;
 		lines_used = int16_t(res.lines_used);
 		single_line_width = int16_t(res.single_line_width);
+		redraw_attached(s, attached);
 	}
 }
-void dw_static_text_provider::set_alignment(system_interface&, text::content_alignment a) {
+void dw_static_text_provider::set_alignment(system_interface& s, text::content_alignment a) {
+	if(alignment == a)
+		return;
 	alignment = a;
 	requires_update = true;
+	redraw_attached(s, attached);
 }
-void dw_static_text_provider::set_font(system_interface&, text::font_handle f) {
+void dw_static_text_provider::set_font(system_interface& s, text::font_handle f) {
+	if(font == f)
+		return;
 	font = f;
 	requires_update = true;
+	redraw_attached(s, attached);
 }
-void dw_static_text_provider::set_is_multiline(system_interface&, bool m) {
+void dw_static_text_provider::set_is_multiline(system_interface& s, bool m) {
+	if(multiline == m)
+		return;
 	multiline = m;
 	requires_update = true;
+	redraw_attached(s, attached);
 }
 int32_t dw_static_text_provider::get_number_of_displayed_lines(system_interface& s) {
 	return displayed_y_size / int32_t(static_cast<win_d2d_dw_ds&>(s).font_collection[font.id].info.line_spacing);
@@ -2194,9 +2254,12 @@ int32_t dw_static_text_provider::get_number_of_text_lines(system_interface&) {
 int32_t dw_static_text_provider::get_starting_display_line() {
 	return starting_line;
 }
-void dw_static_text_provider::set_starting_display_line(int32_t v) {
+void dw_static_text_provider::set_starting_display_line(system_interface& s, int32_t v) {
+	if(starting_line == int16_t(v))
+		return;
 	starting_line = int16_t(v);
 	requires_rerender = true;
+	redraw_attached(s, attached);
 }
 em dw_static_text_provider::get_single_line_width(system_interface& s) {
 	if(requires_update || !layout) {
@@ -2729,19 +2792,29 @@ void dw_editable_text_provider::set_text(system_interface& s, text::formatted_te
 		internal_text = std::move(t.text_content);
 		requires_update = true;
 		prepare_text(static_cast<win_d2d_dw_ds&>(s));
+		redraw_attached(s, attached);
 	}
 }
-void dw_editable_text_provider::set_alignment(system_interface&, text::content_alignment a) {
+void dw_editable_text_provider::set_alignment(system_interface& s, text::content_alignment a) {
+	if(alignment == a)
+		return;
 	alignment = a;
 	requires_update = true;
+	redraw_attached(s, attached);
 }
-void dw_editable_text_provider::set_font(system_interface&, text::font_handle f) {
+void dw_editable_text_provider::set_font(system_interface& s, text::font_handle f) {
+	if(font == f)
+		return;
 	font = f;
 	requires_update = true;
+	redraw_attached(s, attached);
 }
-void dw_editable_text_provider::set_is_multiline(system_interface&, bool m) {
+void dw_editable_text_provider::set_is_multiline(system_interface& s, bool m) {
+	if(multiline == m)
+		return;
 	multiline = m;
 	requires_update = true;
+	redraw_attached(s, attached);
 }
 int32_t dw_editable_text_provider::get_number_of_displayed_lines(system_interface& s) {
 	return std::max(1, displayed_y_size / int32_t(static_cast<win_d2d_dw_ds&>(s).font_collection[font.id].info.line_spacing));
@@ -2752,9 +2825,12 @@ int32_t dw_editable_text_provider::get_number_of_text_lines(system_interface&) {
 int32_t dw_editable_text_provider::get_starting_display_line() {
 	return starting_line;
 }
-void dw_editable_text_provider::set_starting_display_line(int32_t v) {
+void dw_editable_text_provider::set_starting_display_line(system_interface& s, int32_t v) {
+	if(starting_line == int16_t(v))
+		return;
 	starting_line = int16_t(v);
 	requires_update = true;
+	redraw_attached(s, attached);
 }
 
 struct text_metrics {
@@ -3948,6 +4024,7 @@ void dw_editable_text_provider::set_read_only(system_interface& s, bool is_read_
 			int32_t(static_cast<win_d2d_dw_ds&>(s).font_collection[font.id].info.line_spacing));
 		on_selection_change(static_cast<win_d2d_dw_ds&>(s));
 	}
+	redraw_attached(s, attached);
 }
 ieditable_text::detailed_mouse_test_result dw_editable_text_provider::get_detailed_position(system_interface& s, screen_space_point pt) {
 	if(!layout)
@@ -5253,10 +5330,27 @@ void win_d2d_dw_ds::create_window(int32_t window_x_size, int32_t window_y_size,
 	// run message loop
 	MSG msg;
 
-	while(GetMessage(&msg, NULL, 0, 0)) {
-		if(minui_root->edit_target)
-			TranslateMessage(&msg);
-		DispatchMessage(&msg);
+	while(true) {
+		if(PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+			if(msg.message == WM_QUIT)
+				break;
+			if(minui_root->edit_target)
+				TranslateMessage(&msg);
+			DispatchMessage(&msg);
+			continue;
+		}
+
+		// the queue is empty: do any pending work, then sleep until input, a posted update or the next deadline
+		auto now = root::frame_clock::now();
+		if(minui_root->advance_frame(now))
+			InvalidateRect(m_hwnd, nullptr, FALSE);
+
+		DWORD timeout = INFINITE;
+		if(minui_root->next_wakeup != root::frame_clock::time_point::max()) {
+			auto ms = std::chrono::ceil<std::chrono::milliseconds>(minui_root->next_wakeup - root::frame_clock::now()).count();
+			timeout = DWORD(std::max(ms, decltype(ms)(0)));
+		}
+		MsgWaitForMultipleObjectsEx(0, nullptr, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
 	}
 
 	ts_manager_ptr->Deactivate();
@@ -5926,6 +6020,54 @@ void win_d2d_dw_ds::icon(icon_handle ico, screen_space_rect content_rect, uint16
 void win_d2d_dw_ds::set_line_highlight_mode(bool highlight_on) {
 	rendering_as_highlighted_line = highlight_on;
 }
+void win_d2d_dw_ds::set_clip(screen_space_rect r, bool clip_on) {
+	if(clip_pushed) {
+		d2d_device_context->PopAxisAlignedClip();
+		clip_pushed = false;
+	}
+	if(clip_on) {
+		d2d_device_context->PushAxisAlignedClip(D2D1_RECT_F{ float(r.x), float(r.y), float(r.x + r.width), float(r.y + r.height) }, D2D1_ANTIALIAS_MODE_ALIASED);
+		clip_pushed = true;
+	}
+}
+void win_d2d_dw_ds::post_update_request() {
+	PostMessage(m_hwnd, WM_MINUI_UPDATE, 0, 0);
+}
+void win_d2d_dw_ds::set_damaged_regions(std::span<const screen_space_rect> regions) {
+	dirty_rects.clear();
+	for(auto& r : regions) {
+		dirty_rects.push_back(RECT{ LONG(r.x), LONG(r.y), LONG(r.x + r.width), LONG(r.y + r.height) });
+	}
+
+	// The damaged regions are cleared, and everything drawn until render pops the layer is clipped to
+	// them; the rest of the canvas keeps the previous frame.
+	damage_geometry.clear();
+	for(auto& r : dirty_rects) {
+		auto area = D2D1_RECT_F{ float(r.left), float(r.top), float(r.right), float(r.bottom) };
+		d2d_device_context->PushAxisAlignedClip(area, D2D1_ANTIALIAS_MODE_ALIASED);
+		d2d_device_context->Clear(D2D1::ColorF(0.5f, 0.5f, 0.5f, 1.0f));
+		d2d_device_context->PopAxisAlignedClip();
+
+		ID2D1RectangleGeometry* g = nullptr;
+		if(SUCCEEDED(d2d_factory->CreateRectangleGeometry(area, &g)))
+			damage_geometry.push_back(g);
+	}
+	ID2D1GeometryGroup* group = nullptr;
+	if(SUCCEEDED(d2d_factory->CreateGeometryGroup(D2D1_FILL_MODE_WINDING, damage_geometry.data(), UINT32(damage_geometry.size()), &group))) {
+		d2d_device_context->PushLayer(D2D1::LayerParameters1(D2D1::InfiniteRect(), group, D2D1_ANTIALIAS_MODE_ALIASED), nullptr);
+		damage_layer_pushed = true;
+	}
+	// the layer keeps its own reference to the geometry
+	safe_release(group);
+	for(auto& g : damage_geometry)
+		safe_release(g);
+	damage_geometry.clear();
+}
+void win_d2d_dw_ds::submit_primitives(std::span<const draw_primitive> primitives) {
+	batch.assign(primitives.begin(), primitives.end());
+	batch_sorter.sort(batch, *this);
+	system_interface::submit_primitives(batch);
+}
 
 void win_d2d_dw_ds::load_sound(sound_handle h, native_string_view file_name) {
 	if(h.value < 0)
@@ -2,6 +2,7 @@
 
 #include "../common_files/minui_interfaces.hpp"
 #include "../common_files/minui_text_impl.hpp"
+#include "../common_files/draw_batching.hpp"
 #include "simple_fs_types_win.hpp"
 #include "simple_fs.hpp"
 
@@ -161,7 +162,7 @@ public:
 	int32_t get_number_of_displayed_lines(system_interface&) final;
 	int32_t get_number_of_text_lines(system_interface&) final;
 	int32_t get_starting_display_line() final;
-	void set_starting_display_line(int32_t v) final;
+	void set_starting_display_line(system_interface& s, int32_t v) final;
 	em get_single_line_width(system_interface&) final;
 	em get_line_height(system_interface&) final;
 	void resize_to_width(system_interface& s, int32_t w) final;
@@ -265,7 +266,7 @@ public:
 	int32_t get_number_of_text_lines(system_interface&) final;
 	int32_t get_starting_display_line() final;
 	em get_single_line_width(system_interface&) final;
-	void set_starting_display_line(int32_t v) final;
+	void set_starting_display_line(system_interface& s, int32_t v) final;
 	em get_line_height(system_interface&) final;
 	void resize_to_width(system_interface& s, int32_t w) final;
 
@@ -572,6 +573,7 @@ public:
 
 	bool is_suspended = false;
 	bool rendering_as_highlighted_line = false;
+	bool clip_pushed = false; // an axis aligned clip is active on d2d_device_context
 
 	uint16_t language_generation = 0;
 	uint16_t font_generation = 0;
@@ -583,6 +585,11 @@ public:
 	ID3D11DeviceContext* d3d_device_context = nullptr;
 	ID2D1DeviceContext5* d2d_device_context = nullptr;
 	IDXGISwapChain1* swap_chain = nullptr;
+	std::vector<RECT> dirty_rects; // passed to Present1; empty presents the whole buffer
+	std::vector<ID2D1Geometry*> damage_geometry; // the dirty rectangles, while the layer clipping to them is made
+	bool damage_layer_pushed = false;
+	std::vector<draw_primitive> batch; // submitted primitives, reordered by state
+	draw_batching::sorter batch_sorter;
 
 	IDWriteFactory6* dwrite_factory = nullptr;
 	IDWriteFontSetBuilder2* dw_font_collection_builder = nullptr;
@@ -590,6 +597,7 @@ public:
 	IDWriteRenderingParams3* rendering_params = nullptr;
 
 	ID2D1Bitmap1* back_buffer_target = nullptr;
+	ID2D1Bitmap1* canvas = nullptr; // the frame as last drawn; only its damaged regions are drawn again
 	ID2D1SolidColorBrush* solid_brush = nullptr;
 	ID2D1SolidColorBrush* white_brush = nullptr;
 	ID2D1StrokeStyle* plain_strokes = nullptr;
@@ -648,6 +656,7 @@ public:
 		safe_release(d2d_factory);
 
 		safe_release(back_buffer_target);
+		safe_release(canvas);
 
 		for(auto& ptr : key_letters)
 			safe_release(ptr);
@@ -753,6 +762,11 @@ public:
 	void background(image_handle img, uint16_t brush, screen_space_rect, layout_rect interior, rendering_modifiers display_flags = rendering_modifiers::none, int32_t sub_slot = 0) final;
 	void icon(icon_handle ico, screen_space_rect, uint16_t br, rendering_modifiers display_flags = rendering_modifiers::none, int32_t sub_slot = 0) final;
 	void set_line_highlight_mode(bool highlight_on) final;
+	void set_clip(screen_space_rect r, bool clip_on) final;
+	void set_damaged_regions(std::span<const screen_space_rect> regions) final;
+	void submit_primitives(std::span<const draw_primitive> primitives) final;
+
+	void post_update_request() final;
 
 
 	void stop_ui_animations() final;
@@ -0,0 +1,106 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include "minui_interfaces.hpp"
+
+namespace minui {
+
+// Collects the screen-space regions that changed since the last frame. Regions that overlap or touch are
+// merged as they arrive; past max_regions, the pair whose union adds the least area is merged.
+class damage_tracker {
+	std::vector<screen_space_rect> regions;
+	screen_space_rect bounds{ 0, 0, 0, 0 };
+	bool everything = true; // nothing has been drawn yet
+
+	static bool touches(screen_space_rect const& a, screen_space_rect const& b) {
+		return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height;
+	}
+	static screen_space_rect merge(screen_space_rect const& a, screen_space_rect const& b) {
+		auto x = std::min(a.x, b.x);
+		auto y = std::min(a.y, b.y);
+		return screen_space_rect{ x, y, std::max(a.x + a.width, b.x + b.width) - x, std::max(a.y + a.height, b.y + b.height) - y };
+	}
+	static int64_t area(screen_space_rect const& a) {
+		return int64_t(a.width) * int64_t(a.height);
+	}
+public:
+	uint32_t max_regions = 8;
+
+	// regions are clipped to the bounds; changing them damages everything
+	void set_bounds(screen_space_rect b) {
+		if(b.x != bounds.x || b.y != bounds.y || b.width != bounds.width || b.height != bounds.height) {
+			bounds = b;
+			add_all();
+		}
+	}
+	void add_all() {
+		everything = true;
+		regions.clear();
+		regions.push_back(bounds);
+	}
+	void add(screen_space_rect r) {
+		if(everything)
+			return;
+
+		if(bounds.width > 0 && bounds.height > 0) {
+			auto x0 = std::max(r.x, bounds.x);
+			auto y0 = std::max(r.y, bounds.y);
+			auto x1 = std::min(r.x + r.width, bounds.x + bounds.width);
+			auto y1 = std::min(r.y + r.height, bounds.y + bounds.height);
+			r = screen_space_rect{ x0, y0, x1 - x0, y1 - y0 };
+		}
+		if(r.width <= 0 || r.height <= 0)
+			return;
+
+		for(bool merged = true; merged; ) {
+			merged = false;
+			for(size_t i = 0; i < regions.size(); ++i) {
+				if(touches(regions[i], r)) {
+					r = merge(regions[i], r);
+					regions[i] = regions.back();
+					regions.pop_back();
+					merged = true;
+					break;
+				}
+			}
+		}
+		regions.push_back(r);
+
+		while(regions.size() > std::max(max_regions, uint32_t(1))) {
+			size_t best_a = 0;
+			size_t best_b = 1;
+			int64_t best_growth = INT64_MAX;
+			for(size_t i = 0; i < regions.size(); ++i) {
+				for(size_t j = i + 1; j < regions.size(); ++j) {
+					auto growth = area(merge(regions[i], regions[j])) - area(regions[i]) - area(regions[j]);
+					if(growth < best_growth) {
+						best_growth = growth;
+						best_a = i;
+						best_b = j;
+					}
+				}
+			}
+			regions[best_a] = merge(regions[best_a], regions[best_b]);
+			regions[best_b] = regions.back();
+			regions.pop_back();
+		}
+	}
+
+	bool empty() const {
+		return regions.empty();
+	}
+	bool is_full() const {
+		return everything;
+	}
+	std::span<const screen_space_rect> get_regions() const {
+		return std::span<const screen_space_rect>(regions.data(), regions.size());
+	}
+	void clear() {
+		regions.clear();
+		everything = false;
+	}
+};
+
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include "minui_interfaces.hpp"
+
+namespace minui {
+
+// Helpers for backends that want to reorder a submitted batch so that primitives sharing a brush, image or
+// icon are drawn together. A primitive is only moved ahead of primitives it does not overlap, so the result
+// looks the same as drawing in submission order.
+namespace draw_batching {
+
+// what the backend has to switch to draw a primitive
+inline uint64_t state_key(draw_primitive const& p) {
+	return (uint64_t(uint8_t(p.type)) << 56) | (uint64_t(uint8_t(p.display_flags)) << 48) | (uint64_t(p.brush) << 32) | uint64_t(uint32_t(p.handle));
+}
+
+inline screen_space_rect bounds(system_interface const& s, draw_primitive const& p) {
+	if(p.type == primitive_type::text)
+		return s.to_screen_space(p.layout);
+	return p.rect;
+}
+
+inline bool overlaps(screen_space_rect const& a, screen_space_rect const& b) {
+	return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// number of times the backend must change brush, image, icon, highlight mode or clip to draw the sequence
+inline uint32_t count_state_changes(std::span<const draw_primitive> primitives) {
+	uint32_t changes = 0;
+	bool highlight = false;
+	bool have_key = false;
+	uint64_t key = 0;
+	for(auto& p : primitives) {
+		if(p.type == primitive_type::clip) {
+			++changes;
+			continue;
+		}
+		if(p.type == primitive_type::line_highlight_mode) {
+			if(p.flag != highlight)
+				++changes;
+			highlight = p.flag;
+			continue;
+		}
+		auto k = state_key(p);
+		if(have_key && k != key)
+			++changes;
+		key = k;
+		have_key = true;
+	}
+	return changes;
+}
+
+// Reorders primitives in place. Each primitive joins the latest earlier group with the same state and
+// highlight mode, provided it overlaps nothing drawn after that group; otherwise it starts a new group.
+// Highlight mode switches are re-emitted wherever the mode changes between groups. Nothing moves across a
+// clip change.
+class sorter {
+	struct group {
+		uint64_t key = 0;
+		bool highlight = false;
+		screen_space_rect extent{ 0, 0, 0, 0 };
+		std::vector<uint32_t> members;
+	};
+	std::vector<group> groups; // only the first group_count are in use; the rest keep their members' storage
+	size_t group_count = 0;
+	std::vector<screen_space_rect> member_bounds;
+	std::vector<draw_primitive> output;
+	bool emitted_highlight = false;
+
+	void emit_groups(std::vector<draw_primitive> const& primitives) {
+		for(size_t i = 0; i < group_count; ++i) {
+			auto& g = groups[i];
+			if(g.highlight != emitted_highlight) {
+				output.push_back(draw_primitive{ .type = primitive_type::line_highlight_mode, .flag = g.highlight });
+				emitted_highlight = g.highlight;
+			}
+			for(auto m : g.members)
+				output.push_back(primitives[m]);
+			g.members.clear();
+		}
+		group_count = 0;
+	}
+public:
+	uint32_t search_limit = 64; // how many groups back a primitive may move
+
+	void sort(std::vector<draw_primitive>& primitives, system_interface const& s) {
+		for(size_t i = 0; i < group_count; ++i)
+			groups[i].members.clear();
+		group_count = 0;
+		member_bounds.resize(primitives.size());
+		output.clear();
+		output.reserve(primitives.size());
+		emitted_highlight = false;
+
+		bool highlight = false;
+		for(uint32_t i = 0; i < primitives.size(); ++i) {
+			auto& p = primitives[i];
+			if(p.type == primitive_type::clip) {
+				emit_groups(primitives);
+				output.push_back(p);
+				continue;
+			}
+			if(p.type == primitive_type::line_highlight_mode) {
+				highlight = p.flag;
+				continue;
+			}
+			auto k = state_key(p);
+			auto b = bounds(s, p);
+			member_bounds[i] = b;
+
+			size_t destination = group_count;
+			size_t searched = 0;
+			for(size_t g = group_count; g-- > 0 && searched < search_limit; ++searched) {
+				auto& gr = groups[g];
+				if(gr.key == k && gr.highlight == highlight) {
+					destination = g;
+					break;
+				}
+				if(overlaps(gr.extent, b)) {
+					bool blocked = false;
+					for(auto m : gr.members) {
+						if(overlaps(member_bounds[m], b)) {
+							blocked = true;
+							break;
+						}
+					}
+					if(blocked)
+						break;
+				}
+			}
+
+			if(destination == group_count) {
+				if(group_count == groups.size())
+					groups.emplace_back();
+				auto& g = groups[group_count++];
+				g.key = k;
+				g.highlight = highlight;
+				g.extent = b;
+			} else {
+				auto& e = groups[destination].extent;
+				auto x = std::min(e.x, b.x);
+				auto y = std::min(e.y, b.y);
+				e = screen_space_rect{ x, y, std::max(e.x + e.width, b.x + b.width) - x, std::max(e.y + e.height, b.y + b.height) - y };
+			}
+			groups[destination].members.push_back(i);
+		}
+
+		emit_groups(primitives);
+		if(emitted_highlight != highlight)
+			output.push_back(draw_primitive{ .type = primitive_type::line_highlight_mode, .flag = highlight });
+
+		primitives.swap(output);
+	}
+};
+
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <algorithm>
+
+namespace minui {
+
+// A bump allocator for memory that is only needed until the end of a frame. Deallocation does nothing and
+// reset releases everything at once. A frame that outgrows the current block takes more blocks from the
+// heap; the next reset swaps them for one block big enough for all of them, so once the frames settle
+// down the arena stops allocating.
+class frame_arena : public std::pmr::memory_resource {
+	struct block {
+		std::unique_ptr<std::byte[]> data;
+		size_t size = 0;
+	};
+	std::vector<block> blocks;
+	size_t used = 0; // of the last block
+
+	void add_block(size_t size) {
+		blocks.push_back(block{ std::unique_ptr<std::byte[]>(new std::byte[size]), size });
+		used = 0;
+		++heap_blocks;
+	}
+
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		if(!blocks.empty()) {
+			auto& b = blocks.back();
+			auto base = reinterpret_cast<uintptr_t>(b.data.get());
+			auto at = (base + used + alignment - 1) & ~uintptr_t(alignment - 1);
+			if(at + bytes <= base + b.size) {
+				used = size_t(at - base) + bytes;
+				return reinterpret_cast<void*>(at);
+			}
+		}
+		add_block(std::max(bytes + alignment, blocks.empty() ? initial_size : blocks.back().size * 2));
+		return do_allocate(bytes, alignment);
+	}
+	void do_deallocate(void*, size_t, size_t) override {
+	}
+	bool do_is_equal(std::pmr::memory_resource const& o) const noexcept override {
+		return this == &o;
+	}
+public:
+	size_t initial_size = 16 * 1024;
+	uint32_t heap_blocks = 0; // taken from the heap since construction
+
+	frame_arena() = default;
+	frame_arena(frame_arena const&) = delete;
+	frame_arena& operator=(frame_arena const&) = delete;
+
+	// everything allocated since the last reset must be out of use
+	void reset() {
+		if(blocks.size() > 1) {
+			size_t total = 0;
+			for(auto& b : blocks)
+				total += b.size;
+			blocks.clear();
+			add_block(total);
+		}
+		used = 0;
+	}
+	size_t capacity() const {
+		size_t total = 0;
+		for(auto& b : blocks)
+			total += b.size;
+		return total;
+	}
+};
+
+}
@@ -0,0 +1,191 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <span>
+#include <chrono>
+#include <optional>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace minui {
+namespace replay {
+
+// the root entry points a recording captures
+enum class entry_type : uint8_t {
+	mouse_move, mouse_lbutton, mouse_rbutton, mouse_lbutton_up, mouse_rbutton_up, mouse_scroll, key_down, key_up, character,
+	workspace_resized, update, frame, render, request_update, request_layout, count
+};
+
+// One call to the root. Its arguments are stored in a, b and c:
+//   mouse_move: x, y (em values)
+//   mouse_lbutton: click type
+//   key_down: scancode, vk code, repeat
+//   key_up: scancode, vk code
+//   character: the character
+//   workspace_resized: resize type, width, height (em values)
+// mouse_scroll keeps its amount in amount; frame is a call to advance_frame at its time.
+struct entry {
+	entry_type type = entry_type::frame;
+	int64_t time = 0; // microseconds since the recording started
+	int32_t a = 0;
+	int32_t b = 0;
+	int32_t c = 0;
+	float amount = 0.0f;
+};
+
+inline uint32_t argument_count(entry_type t) {
+	switch(t) {
+		case entry_type::mouse_move:
+			return 2;
+		case entry_type::mouse_lbutton:
+			return 1;
+		case entry_type::key_down:
+			return 3;
+		case entry_type::key_up:
+			return 2;
+		case entry_type::character:
+			return 1;
+		case entry_type::workspace_resized:
+			return 3;
+		default:
+			return 0;
+	}
+}
+
+constexpr uint8_t file_magic[4] = { 'M', 'U', 'R', '1' };
+
+// Writes entries as a compact byte stream: the magic, then for each entry its type, the time since the
+// previous entry and its arguments, all but the type as zigzag variable length integers (the scroll amount
+// as its bits).
+class recorder {
+	std::vector<uint8_t> bytes;
+	int64_t last_time = 0;
+
+	void put(uint64_t v) {
+		while(v >= 0x80) {
+			bytes.push_back(uint8_t(v | 0x80));
+			v >>= 7;
+		}
+		bytes.push_back(uint8_t(v));
+	}
+	void put_signed(int64_t v) {
+		put((uint64_t(v) << 1) ^ uint64_t(v >> 63));
+	}
+public:
+	using clock = std::chrono::steady_clock;
+
+	clock::time_point start;
+	uint32_t entries = 0;
+
+	explicit recorder(clock::time_point start = clock::now()) : bytes(std::begin(file_magic), std::end(file_magic)), start(start) { }
+
+	void add(entry const& e) {
+		bytes.push_back(uint8_t(e.type));
+		put_signed(e.time - last_time);
+		last_time = e.time;
+		int32_t const args[3] = { e.a, e.b, e.c };
+		for(uint32_t i = 0; i < argument_count(e.type); ++i)
+			put_signed(args[i]);
+		if(e.type == entry_type::mouse_scroll) {
+			uint32_t bits = 0;
+			std::memcpy(&bits, &e.amount, sizeof(bits));
+			put(bits);
+		}
+		++entries;
+	}
+	// timed relative to start
+	void add(entry e, clock::time_point at) {
+		e.time = std::chrono::duration_cast<std::chrono::microseconds>(at - start).count();
+		add(e);
+	}
+
+	std::span<const uint8_t> data() const {
+		return bytes;
+	}
+	bool save(std::filesystem::path const& p) const {
+		std::ofstream out(p, std::ios::binary);
+		out.write(reinterpret_cast<char const*>(bytes.data()), std::streamsize(bytes.size()));
+		return bool(out);
+	}
+};
+
+inline std::vector<uint8_t> load(std::filesystem::path const& p) {
+	std::ifstream in(p, std::ios::binary);
+	return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Reads back what a recorder wrote, one entry at a time. A stream that does not start with the magic, or
+// that ends inside an entry, sets failed.
+class reader {
+	std::span<const uint8_t> bytes;
+	size_t pos = 0;
+	int64_t time = 0;
+
+	bool get(uint64_t& v) {
+		v = 0;
+		for(uint32_t shift = 0; shift < 64; shift += 7) {
+			if(pos >= bytes.size())
+				return false;
+			auto b = bytes[pos++];
+			v |= uint64_t(b & 0x7F) << shift;
+			if((b & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+	bool get_signed(int64_t& v) {
+		uint64_t u = 0;
+		if(!get(u))
+			return false;
+		v = int64_t(u >> 1) ^ -int64_t(u & 1);
+		return true;
+	}
+public:
+	bool failed = false;
+
+	explicit reader(std::span<const uint8_t> bytes) : bytes(bytes) {
+		if(bytes.size() < sizeof(file_magic) || std::memcmp(bytes.data(), file_magic, sizeof(file_magic)) != 0)
+			failed = true;
+		else
+			pos = sizeof(file_magic);
+	}
+
+	std::optional<entry> next() {
+		if(failed || pos >= bytes.size())
+			return std::nullopt;
+
+		entry e;
+		e.type = entry_type(bytes[pos++]);
+		int64_t delta = 0;
+		if(e.type >= entry_type::count || !get_signed(delta)) {
+			failed = true;
+			return std::nullopt;
+		}
+		time += delta;
+		e.time = time;
+		int32_t* const args[3] = { &e.a, &e.b, &e.c };
+		for(uint32_t i = 0; i < argument_count(e.type); ++i) {
+			int64_t v = 0;
+			if(!get_signed(v)) {
+				failed = true;
+				return std::nullopt;
+			}
+			*args[i] = int32_t(v);
+		}
+		if(e.type == entry_type::mouse_scroll) {
+			uint64_t bits = 0;
+			if(!get(bits)) {
+				failed = true;
+				return std::nullopt;
+			}
+			auto b32 = uint32_t(bits);
+			std::memcpy(&e.amount, &b32, sizeof(b32));
+		}
+		return e;
+	}
+};
+
+}
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "input_recording.hpp"
+#include "system_headless.hpp"
+
+#include <stdint.h>
+#include <vector>
+#include <span>
+#include <chrono>
+
+namespace minui {
+namespace replay {
+
+struct frame_timing {
+	int64_t time = 0; // of the render, in microseconds since the recording started
+	std::chrono::steady_clock::duration handling{ }; // input entry points since the previous render
+	std::chrono::steady_clock::duration advancing{ }; // advance_frame calls since the previous render
+	std::chrono::steady_clock::duration rendering{ };
+	uint32_t commands = 0; // drawn by the render
+};
+
+struct result {
+	std::vector<frame_timing> frames; // one per render
+	uint64_t draw_hash = 0; // of every render's draw stream, in order
+	uint32_t entries = 0;
+	bool complete = false; // false if the recording was malformed or cut short
+};
+
+// Replays a recording into a root drawing to a headless system; Root has the entry points of minui::root.
+// advance_frame is given origin plus the recorded time, so timers fire where they did when recording.
+// The system's command buffer is hashed and cleared after each render.
+template<typename Root>
+result run(std::span<const uint8_t> recording, Root& r, headless::system& s, std::chrono::steady_clock::time_point origin) {
+	using clock = std::chrono::steady_clock;
+
+	result out;
+	out.draw_hash = headless::draw_stream_hash(headless::command_buffer{ });
+	frame_timing current;
+	s.commands.clear();
+
+	reader in(recording);
+	while(auto e = in.next()) {
+		++out.entries;
+		auto start = clock::now();
+		switch(e->type) {
+			case entry_type::mouse_move:
+				r.on_mouse_move(layout_position{ em{ int16_t(e->a) }, em{ int16_t(e->b) } });
+				break;
+			case entry_type::mouse_lbutton:
+				r.on_mouse_lbutton(click_type(e->a));
+				break;
+			case entry_type::mouse_rbutton:
+				r.on_mouse_rbutton();
+				break;
+			case entry_type::mouse_lbutton_up:
+				r.on_mouse_lbutton_up();
+				break;
+			case entry_type::mouse_rbutton_up:
+				r.on_mouse_rbutton_up();
+				break;
+			case entry_type::mouse_scroll:
+				r.on_mouse_scroll(e->amount);
+				break;
+			case entry_type::key_down:
+				r.on_key_down(uint32_t(e->a), uint32_t(e->b), e->c != 0);
+				break;
+			case entry_type::key_up:
+				r.on_key_up(uint32_t(e->a), uint32_t(e->b));
+				break;
+			case entry_type::character:
+				r.on_char(native_char(e->a));
+				break;
+			case entry_type::workspace_resized:
+			{
+				// the backend has changed size by the time it tells the root
+				layout_position size{ em{ int16_t(e->b) }, em{ int16_t(e->c) } };
+				if(resize_type(e->a) != resize_type::minimize)
+					s.workspace = size;
+				r.on_workspace_resized(resize_type(e->a), size);
+				break;
+			}
+			case entry_type::update:
+				r.on_update();
+				break;
+			case entry_type::request_update:
+				r.request_update();
+				break;
+			case entry_type::request_layout:
+				r.request_layout();
+				break;
+			case entry_type::frame:
+				r.advance_frame(origin + std::chrono::microseconds(e->time));
+				break;
+			case entry_type::render:
+				r.render();
+				break;
+			case entry_type::count:
+				break;
+		}
+		auto spent = clock::now() - start;
+
+		if(e->type == entry_type::render) {
+			current.rendering = spent;
+			current.time = e->time;
+			current.commands = s.commands.command_count;
+			out.draw_hash = headless::draw_stream_hash(s.commands, out.draw_hash);
+			s.commands.clear();
+			out.frames.push_back(current);
+			current = frame_timing{ };
+		} else if(e->type == entry_type::frame) {
+			current.advancing += spent;
+		} else {
+			current.handling += spent;
+		}
+	}
+	out.complete = !in.failed;
+	return out;
+}
+
+}
+}
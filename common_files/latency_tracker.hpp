@@ -0,0 +1,143 @@
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include <chrono>
+#include <optional>
+#include <algorithm>
+#include <string>
+
+namespace minui {
+
+// Measures how long input takes to reach the screen. The root reports when input arrives and when it
+// finishes handling it, laying out and rendering; the backend reports when the frame is presented. Every
+// presented frame that follows input yields one sample, timed from the earliest input it shows.
+class latency_tracker {
+public:
+	using clock = std::chrono::steady_clock;
+
+	// time from the arrival of the input to the end of each stage
+	struct sample {
+		clock::duration handled{ };
+		clock::duration laid_out{ };
+		clock::duration rendered{ };
+		clock::duration presented{ };
+	};
+	struct percentiles {
+		clock::duration p50{ };
+		clock::duration p90{ };
+		clock::duration p99{ };
+		clock::duration max{ };
+		uint32_t samples = 0;
+	};
+
+	static constexpr size_t history_size = 256;
+private:
+	struct stamps {
+		clock::time_point arrival;
+		std::optional<clock::time_point> handled;
+		std::optional<clock::time_point> laid_out;
+		std::optional<clock::time_point> rendered;
+	};
+	std::optional<stamps> pending; // input not yet rendered
+	std::optional<stamps> awaiting_present; // rendered but not yet presented
+
+	std::array<sample, history_size> history;
+	size_t next = 0;
+	size_t count = 0;
+public:
+	uint64_t total_samples = 0;
+
+	void input_arrived(clock::time_point at) {
+		if(!pending) {
+			pending.emplace();
+			pending->arrival = at;
+		} else {
+			pending->arrival = std::min(pending->arrival, at);
+		}
+	}
+	void input_handled(clock::time_point at) {
+		if(pending)
+			pending->handled = at;
+	}
+	void layout_done(clock::time_point at) {
+		if(pending)
+			pending->laid_out = at;
+	}
+	// the input since the last frame changed nothing on screen, so it yields no sample
+	void nothing_to_render() {
+		pending.reset();
+	}
+	void render_done(clock::time_point at) {
+		if(!pending)
+			return;
+		pending->rendered = at;
+		// a frame that was never presented passes its input on to this one
+		if(awaiting_present)
+			pending->arrival = std::min(pending->arrival, awaiting_present->arrival);
+		awaiting_present = pending;
+		pending.reset();
+	}
+	void presented(clock::time_point at) {
+		if(!awaiting_present)
+			return;
+		auto& r = *awaiting_present;
+		// a stage that did not run in this frame ends with the next one
+		auto rendered_at = *r.rendered;
+		auto laid_out_at = r.laid_out.value_or(rendered_at);
+		auto handled_at = r.handled.value_or(laid_out_at);
+		history[next] = sample{ handled_at - r.arrival, laid_out_at - r.arrival, rendered_at - r.arrival, at - r.arrival };
+		next = (next + 1) % history_size;
+		count = std::min(count + 1, history_size);
+		++total_samples;
+		awaiting_present.reset();
+	}
+
+	// the kept samples, oldest first
+	std::vector<sample> recent() const {
+		std::vector<sample> result;
+		result.reserve(count);
+		for(size_t i = 0; i < count; ++i)
+			result.push_back(history[(next + history_size - count + i) % history_size]);
+		return result;
+	}
+	// over the kept samples, by nearest rank
+	percentiles stage_percentiles(clock::duration sample::* stage) const {
+		percentiles result;
+		if(count == 0)
+			return result;
+		std::vector<clock::duration> values;
+		values.reserve(count);
+		for(size_t i = 0; i < count; ++i)
+			values.push_back(history[i].*stage);
+		std::sort(values.begin(), values.end());
+		auto rank = [&](size_t percent) {
+			return values[std::max((values.size() * percent + 99) / 100, size_t(1)) - 1];
+		};
+		result.p50 = rank(50);
+		result.p90 = rank(90);
+		result.p99 = rank(99);
+		result.max = values.back();
+		result.samples = uint32_t(values.size());
+		return result;
+	}
+	percentiles presented_percentiles() const {
+		return stage_percentiles(&sample::presented);
+	}
+	// one line with the input to present percentiles in milliseconds, for logs
+	std::string summary() const {
+		auto p = presented_percentiles();
+		auto ms = [](clock::duration d) {
+			return std::to_string(std::chrono::duration<double, std::milli>(d).count());
+		};
+		return "input to present over " + std::to_string(p.samples) + " frames: p50 " + ms(p.p50) + " ms, p90 " + ms(p.p90) + " ms, p99 " + ms(p.p99) + " ms, max " + ms(p.max) + " ms";
+	}
+	void clear() {
+		pending.reset();
+		awaiting_present.reset();
+		next = 0;
+		count = 0;
+	}
+};
+
+}
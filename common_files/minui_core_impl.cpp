@@ -1,11 +1,24 @@
 #include "minui_interfaces.hpp"
 #include "minui_text_impl.hpp"
 #include "stools.hpp"
+#include "task_pool.hpp"
+#include "damage_tracker.hpp"
+#include "frame_arena.hpp"
+#include "spsc_queue.hpp"
+#include "latency_tracker.hpp"
+#include "input_recording.hpp"
+#include "update_scheduler.hpp"
 
 #include <limits>
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <cmath>
+#include <thread>
+#include <assert.h>
 
+#ifdef _WIN32
 #ifndef UNICODE
 #define UNICODE
 #endif
@@ -13,14 +26,22 @@
 #define WIN32_LEAN_AND_MEAN
 
 #include <Windows.h>
+#else
+// virtual key codes as delivered by the headless backend
+#define VK_SHIFT 0x10
+#define VK_MENU 0x12
+#define VK_ESCAPE 0x1B
+#define VK_SPACE 0x20
+#endif
 
 namespace minui {
 
-#ifdef _WIN64
+#ifdef _MSC_VER
 #define minui_aligned_alloc(X, Y) _aligned_malloc(X, Y)
 #define minui_aligned_free(X) _aligned_free(X)
 #else
-#define minui_aligned_alloc(X, Y) std::aligned_alloc(Y, X)
+// aligned_alloc wants the size to be a multiple of the alignment
+#define minui_aligned_alloc(X, Y) std::aligned_alloc(Y, ((X) + (Y) - 1) / (Y) * (Y))
 #define minui_aligned_free(X) std::free(X)
 #endif
 
@@ -29,19 +50,19 @@ public:
 	std::vector<ui_node*> children;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
 	uint32_t child_count() const override;
 	ui_node* get_child(uint32_t index) const override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_gain_focus(root& r) override;
 	void on_lose_focus(root& r) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_create(root& r) override;
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	interactable_result interactable_layout(root& r) override;
 };
 
 struct type_range {
@@ -60,6 +81,7 @@ inline float to_float(relative_to v) {
 		case relative_to::one_fourth: return 0.25f;
 		case relative_to::three_fourths: return 0.75f;
 	}
+	return 0.0f;
 }
 
 class proportional_window : public ui_node {
@@ -68,38 +90,42 @@ public:
 	std::vector<relative_child_def> child_positions;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
 	uint32_t child_count() const override;
 	ui_node* get_child(uint32_t index) const override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_gain_focus(root& r) override;
 	void on_lose_focus(root& r) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_create(root& r) override;
 	void force_resize(root& r, layout_position size) override;
 	void resize(root& r, layout_position maximum_space, em desired_width, em desired_height) override;
 	em minimum_width(root& r) override;
 	em minimum_height(root& r) override;
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	interactable_result interactable_layout(root& r) override;
 };
 
 
 class space_filler : public ui_node {
 public:
 	std::vector<ui_node*> children;
+	std::vector<content_position> child_offsets; // by child; children may be stacked past the em range
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
+	content_position child_content_offset(ui_node const& child) const override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
 	uint32_t child_count() const override;
 	ui_node* get_child(uint32_t index) const override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_gain_focus(root& r) override;
 	void on_lose_focus(root& r) override;
 	void on_create(root& r) override;
@@ -107,9 +133,7 @@ public:
 	void resize(root& r, layout_position maximum_space, em desired_width, em desired_height) override;
 	em minimum_width(root& r) override;
 	em minimum_height(root& r) override;
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	interactable_result interactable_layout(root& r) override;
 };
 
 class page_controls : public ui_node {
@@ -123,7 +147,7 @@ public:
 	bool vertical_arrangement = false;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
 	uint32_t child_count() const override {
 		return 4;
 	}
@@ -131,8 +155,10 @@ public:
 		ui_node* ar[4] = { left2_button, left_button , right_button, right2_button };
 		return ar[index];
 	}
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_create(root& r) override;
 	void force_resize(root& r, layout_position size) override;
 	void resize(root& r, layout_position maximum_space, em desired_width, em desired_height) override;
@@ -152,15 +178,17 @@ public:
 	bool pending_relayout = false;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
 	uint32_t child_count() const override;
 	ui_node* get_child(uint32_t index) const override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_gain_focus(root& r) override;
 	void on_lose_focus(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_create(root& r) override;
 	void on_scroll(root& r, layout_position pos, int32_t amount) override;
 	void force_resize(root& r, layout_position size) override;
@@ -176,9 +204,7 @@ public:
 			return static_cast<imultitype_container*>(this);
 		return nullptr;
 	}
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	interactable_result interactable_layout(root& r) override;
 	void repaginate(root& r);
 };
 
@@ -186,6 +212,15 @@ class monotype_column : public ui_node, imonotype_container {
 public:
 	std::vector<ui_node*> children;
 	std::unique_ptr<type_erased_vector> data;
+	monotype_data_source const* external_source = nullptr;
+	uint64_t bound_version = 0;
+	// what each row was last updated with
+	struct bound_row {
+		monotype_data_source const* source = nullptr; // nullptr: nothing bound
+		size_t index = 0;
+		uint64_t element_version = 0;
+	};
+	std::vector<bound_row> bound_rows;
 	uint16_t page_size = 0;
 
 	ui_node* page_controls = nullptr;
@@ -194,16 +229,30 @@ public:
 	uint16_t current_page = 0;
 	bool pending_data_update = true;
 
+	monotype_data_source const& items() const {
+		return external_source ? *external_source : static_cast<monotype_data_source const&>(*data);
+	}
+	// where the current page starts within item_count items; a source that shrank below the page gives an empty page
+	size_t page_start(size_t item_count) const {
+		return std::min(size_t(page_size) * current_page, item_count);
+	}
+	void bind_page(root& r, bool force_update);
+	std::optional<uint64_t> row_fingerprint(root& r, uint32_t row) const;
+	layout_position row_minimum_size(root& r);
+	void measure_row(root& r, uint32_t row, em width, em available_height);
+
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
 	uint32_t child_count() const override;
 	ui_node* get_child(uint32_t index) const override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_gain_focus(root& r) override;
 	void on_lose_focus(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_create(root& r) override;
 	void on_scroll(root& r, layout_position pos, int32_t amount) override;
 	void force_resize(root& r, layout_position size) override;
@@ -214,9 +263,10 @@ public:
 	void change_page(root& r, int32_t new_page) override;
 	void add_item(void const* data) override;
 	void clear_contents() override;
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	bool set_items(void const* first, size_t count, size_t item_size) override;
+	void set_data_source(monotype_data_source const* source) override;
+	void const* get_item(ui_node const& row) const override;
+	interactable_result interactable_layout(root& r) override;
 	iface_base* get_interface(iface v) override {
 		if(v == iface::monotype_container)
 			return static_cast<imonotype_container*>(this);
@@ -230,17 +280,17 @@ public:
 	uint16_t selected = 0;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
 	uint32_t child_count() const override;
 	ui_node* get_child(uint32_t index) const override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_gain_focus(root& r) override;
 	void on_lose_focus(root& r) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
-	void on_gain_focus(root& r) override;
-	void on_lose_focus(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_create(root& r) override;
 	void force_resize(root& r, layout_position size) override;
 	void resize(root& r, layout_position maximum_space, em desired_width, em desired_height) override;
@@ -248,9 +298,7 @@ public:
 	em minimum_height(root& r) override;
 	page_information get_page_information() override;
 	void change_page(root& r, int32_t new_page) override;
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	interactable_result interactable_layout(root& r) override;
 };
 
 class layers : public ui_node {
@@ -258,12 +306,14 @@ public:
 	std::vector<ui_node*> children;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
 	uint32_t child_count() const override;
 	ui_node* get_child(uint32_t index) const override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_create(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_gain_focus(root& r) override;
@@ -272,9 +322,7 @@ public:
 	void resize(root& r, layout_position maximum_space, em desired_width, em desired_height) override;
 	em minimum_width(root& r) override;
 	em minimum_height(root& r) override;
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	interactable_result interactable_layout(root& r) override;
 };
 
 class dynamic_grid : public ui_node, imultitype_container {
@@ -288,15 +336,17 @@ public:
 	bool pending_relayout = false;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
 	uint32_t child_count() const override;
 	ui_node* get_child(uint32_t index) const override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_gain_focus(root& r) override;
 	void on_lose_focus(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_create(root& r) override;
 	void on_scroll(root& r, layout_position pos, int32_t amount) override;
 	void force_resize(root& r, layout_position size) override;
@@ -307,9 +357,7 @@ public:
 	void change_page(root& r, int32_t new_page) override;
 	void add_managed_element(root& r, ui_node* n) override;
 	void reset_managed_elements(root& r) override;
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	interactable_result interactable_layout(root& r) override;
 	iface_base* get_interface(iface v) override {
 		if(v == iface::multitype_container)
 			return static_cast<imultitype_container*>(this);
@@ -325,20 +373,19 @@ public:
 	layout_rect margins;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
 	void on_create(root& r) override;
 	void force_resize(root& r, layout_position size) override;
 	void resize(root& r, layout_position maximum_space, em desired_width, em desired_height) override;
 	em minimum_width(root& r) override;
 	em minimum_height(root& r) override;
 	void on_reload(root& r) override;
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	interactable_result interactable_layout(root& r) override;
 	iface_base* get_interface(iface v) override {
 		if(v == iface::static_text)
 			return text_data.get();
@@ -354,11 +401,12 @@ public:
 	bool enabled = true;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
 	void on_create(root& r) override;
 	void on_lbutton(root& r, layout_position pos) override;
 	void force_resize(root& r, layout_position size) override;
@@ -366,7 +414,7 @@ public:
 	em minimum_width(root& r) override;
 	em minimum_height(root& r) override;
 	void on_reload(root& r) override;
-	interactable_result interactable_layout(root& r) override {
+	interactable_result interactable_layout(root&) override {
 		return interactable_result{ layout_position{ }, interactable_definition{ interactable_orientation::left, interactable_placement::internal } };
 	}
 	iface_base* get_interface(iface v) override {
@@ -391,11 +439,12 @@ public:
 	bool enabled = true;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
 	void on_create(root& r) override;
 	void on_lbutton(root& r, layout_position pos) override;
 	void force_resize(root& r, layout_position size) override;
@@ -403,9 +452,7 @@ public:
 	em minimum_width(root& r) override;
 	em minimum_height(root& r) override;
 	void recalculate_icon_position(root& r);
-	interactable_result interactable_layout(root& r) override {
-		return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
-	}
+	interactable_result interactable_layout(root& r) override;
 	iface_base* get_interface(iface v) override {
 		if(v == iface::control)
 			return static_cast<icontrol*>(this);
@@ -426,11 +473,12 @@ public:
 	layout_rect margins;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_visible(root& r) override;
 	void on_hide(root& r) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
 	void on_create(root& r) override;
 	void on_reload(root& r) override;
 	void force_resize(root& r, layout_position size) override;
@@ -441,12 +489,7 @@ public:
 	void on_gain_focus(root& r) override;
 	void on_lose_focus(root& r) override;
 	void on_text_update(root& r) override;
-	interactable_result interactable_layout(root& r) override {
-		if(r.contains_focus(this))
-			return interactable_result{ layout_position{ }, interactable_definition{ interactable_orientation::left, interactable_placement::suppressed } };
-		else
-			return interactable_result{ layout_position{ }, interactable_definition{ interactable_orientation::left, interactable_placement::internal } };
-	}
+	interactable_result interactable_layout(root& r) override;
 	iface_base* get_interface(iface v) override {
 		if(v == iface::static_text)
 			return static_cast<istatic_text*>(text_data.get());
@@ -472,9 +515,11 @@ public:
 	bool enabled = true;
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_lbutton(root& r, layout_position pos) override;
 	interactable_result interactable_layout(root& r) override;
 
@@ -495,15 +540,18 @@ public:
 	constexpr static uint32_t vertical = 0x01;
 
 	std::unique_ptr<static_text_provider> text_data;
+	page_information shown; // the page numbers last set as the text
 
 	size_t size() const override;
-	void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) override;
-	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) override;
+	void render(root& r, layout_position offset, postponed_list& postponed) override;
+	probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) override;
 	void on_update(root& r) override;
+	update_mode begin_update(root& r) override;
+	void update_children(root& r, update_list& next) override;
 	void on_create(root& r) override;
 	void on_reload(root& r) override;
 	void force_resize(root& r, layout_position size) override;
-	interactable_result interactable_layout(root& r) override {
+	interactable_result interactable_layout(root&) override {
 		return interactable_result{ layout_position{ }, interactable_definition{ interactable_orientation::left, interactable_placement::suppressed } };
 	}
 	iface_base* get_interface(iface v) override {
@@ -562,11 +610,70 @@ struct key_actions {
 	int32_t valid_key_action_count = 0;
 };
 
-enum class click_type {
-	singlec, doublec, triplec
+struct measurement_key {
+	uint32_t type_id = 0;
+	int16_t width = 0;
+	int16_t height = 0;
+	uint64_t fingerprint = 0; // identifies the content measured; 0 for behavior::layout_uniform_size
+
+	bool operator==(measurement_key const&) const = default;
+};
+struct measurement_key_hash {
+	using is_avalanching = void;
+
+	uint64_t operator()(measurement_key const& k) const noexcept {
+		return ankerl::unordered_dense::detail::wyhash::mix(uint64_t(k.type_id) << 32 | uint32_t(uint16_t(k.width)) << 16 | uint16_t(k.height), k.fingerprint ^ UINT64_C(0x9E3779B97F4A7C15));
+	}
 };
-enum class resize_type {
-	minimize, maximize, normal
+
+// Collects the frame's draw calls for a single submit_primitives, and while a node is being recorded also
+// appends them to its display list
+class display_recorder {
+public:
+	system_interface& system;
+	std::vector<draw_primitive> frame;
+	std::vector<draw_primitive>* target = nullptr;
+
+	display_recorder(system_interface& system) : system(system) { }
+
+	void add(draw_primitive const& p) {
+		frame.push_back(p);
+		if(target)
+			target->push_back(p);
+	}
+	void rectangle(screen_space_rect content_rect, rendering_modifiers display_flags, uint16_t brush) {
+		add(draw_primitive{ .rect = content_rect, .brush = brush, .type = primitive_type::rectangle, .display_flags = display_flags });
+	}
+	void empty_rectangle(screen_space_rect content_rect, rendering_modifiers display_flags, uint16_t brush) {
+		add(draw_primitive{ .rect = content_rect, .brush = brush, .type = primitive_type::empty_rectangle, .display_flags = display_flags });
+	}
+	void icon(icon_handle ico, screen_space_rect content_rect, uint16_t brush, rendering_modifiers display_flags = rendering_modifiers::none) {
+		add(draw_primitive{ .rect = content_rect, .handle = ico.value, .brush = brush, .type = primitive_type::icon, .display_flags = display_flags });
+	}
+	void background(image_handle img, uint16_t brush, screen_space_rect content_rect, layout_rect interior, rendering_modifiers display_flags = rendering_modifiers::none) {
+		add(draw_primitive{ .rect = content_rect, .layout = interior, .handle = img.value, .brush = brush, .type = primitive_type::background, .display_flags = display_flags });
+	}
+	void set_line_highlight_mode(bool highlight_on) {
+		add(draw_primitive{ .type = primitive_type::line_highlight_mode, .flag = highlight_on });
+	}
+	void clip(screen_space_rect r, bool clip_on) {
+		add(draw_primitive{ .rect = r, .type = primitive_type::clip, .flag = clip_on });
+	}
+	// the provider renders when the batch is submitted, so replayed carets and selections stay current
+	void text(istatic_text& t, layout_rect bounds, uint16_t brush, rendering_modifiers display_flags = rendering_modifiers::none, bool in_focus = false) {
+		add(draw_primitive{ .layout = bounds, .text = &t, .brush = brush, .type = primitive_type::text, .display_flags = display_flags, .flag = in_focus });
+	}
+
+	void replay(std::vector<draw_primitive> const& list) {
+		frame.insert(frame.end(), list.begin(), list.end());
+		if(target)
+			target->insert(target->end(), list.begin(), list.end());
+	}
+	void flush() {
+		if(!frame.empty())
+			system.submit_primitives(frame);
+		frame.clear();
+	}
 };
 
 void null_user_function(root&, ui_node&) {
@@ -599,14 +706,358 @@ public:
 	} last_mcommand_sent = mcommand::none;
 	ui_node* last_mcommand_target = nullptr;
 	ieditable_text* edit_target = nullptr;
+	ui_node* edit_target_node = nullptr;
 
 	layout_position latest_mouse_position;
 
 	system_interface& system;
 	layout_position workspace;
-	
 
-	root(system_interface& system, layout_position initial_size) : system(system), workspace(initial_size) {
+	// Sizes of elements measured within a space, shared between instances of a type showing the same
+	// content, as identified by a fingerprint of it. Types with behavior::layout_uniform_size share one
+	// measurement, fingerprint 0, for all their content. Cleared whenever the definitions, the fonts or the
+	// size of an em in pixels change, and when it reaches measurement_cache_limit entries.
+	ankerl::unordered_dense::map<measurement_key, layout_position, measurement_key_hash> measurement_cache;
+	std::mutex measurement_lock;
+	static constexpr size_t measurement_cache_limit = 4096;
+
+	std::optional<layout_position> find_measurement(uint32_t type_id, layout_position space, uint64_t fingerprint) {
+		std::lock_guard lg(measurement_lock);
+		auto it = measurement_cache.find(measurement_key{ type_id, space.x.value, space.y.value, fingerprint });
+		if(it != measurement_cache.end())
+			return it->second;
+		return std::nullopt;
+	}
+	void store_measurement(uint32_t type_id, layout_position space, uint64_t fingerprint, layout_position size) {
+		std::lock_guard lg(measurement_lock);
+		if(measurement_cache.size() >= measurement_cache_limit)
+			measurement_cache.clear();
+		measurement_cache.insert_or_assign(measurement_key{ type_id, space.x.value, space.y.value, fingerprint }, size);
+	}
+	void invalidate_measurements() {
+		std::lock_guard lg(measurement_lock);
+		measurement_cache.clear();
+	}
+
+	//
+	// parallel layout
+	//
+
+	std::unique_ptr<task_pool> layout_pool;
+	std::recursive_mutex node_lock; // held while creating or releasing nodes
+	bool in_parallel_layout = false;
+	bool lazy_definitions_resolved = false;
+
+	// Layout workers share the root, so what they may not do themselves waits until parallel_layout
+	// returns and is then done on the calling thread: invalidate_layout is remembered, and the work passed
+	// to run_after_parallel_layout, such as updating rows and page controls, is queued.
+	std::atomic<bool> layout_invalidated_in_parallel = false;
+	std::mutex deferred_layout_lock;
+	std::vector<std::function<void()>> deferred_layout_work;
+
+	void set_layout_threads(uint32_t count); // 0 or 1 to lay out on the calling thread only
+	bool parallel_layout_enabled() const {
+		return layout_pool && !in_parallel_layout;
+	}
+	void parallel_layout(size_t count, std::function<void(size_t)> const& fn);
+	void run_after_parallel_layout(std::function<void()> fn); // runs fn at once outside a parallel layout
+	void resolve_lazy_definitions();
+
+	//
+	// retained rendering
+	//
+
+	struct retained_render {
+		std::vector<draw_primitive> commands; // drawn by the node and its children, in order
+		std::vector<postponed_render> pop_ups; // postponed by the node and its children
+		layout_position offset;
+		layout_rect clip; // children outside it were culled
+		layout_rect bounds{ }; // render_bounds when recorded, to be damaged if the node changes
+		uint32_t behavior_flags = 0;
+		uint32_t generation = 0;
+		bool highlighted = false;
+		bool valid = false;
+		bool changed = false; // invalidated itself, rather than for something drawn inside it
+	};
+
+	display_recorder display;
+	ankerl::unordered_dense::map<ui_node const*, std::unique_ptr<retained_render>> retained;
+	uint32_t render_generation = 1;
+	bool retained_rendering = true;
+	damage_tracker damage;
+
+	void render_node(ui_node& n, layout_position offset, postponed_list& postponed);
+	// call after changing how a node draws or where its children are outside of the root's own event handlers
+	void invalidate_render(ui_node const* n);
+	void invalidate_all_rendering() {
+		++render_generation;
+		damage.add_all();
+		needs_render = true;
+	}
+	void damage_node(ui_node* n); // the node's area, including any background overhang
+	void damage_interactable(placed_interactable const& i); // a prompt and the icon it replaces
+	void damage_interactables(); // every prompt shown
+
+	//
+	// clipping and culling
+	//
+
+	std::vector<layout_rect> clip_stack; // each entry is already intersected with the one below it
+	std::vector<bool> opaque_brushes; // solid color brushes with full alpha in both slots
+	bool clip_to_display = false; // send clip changes to the display; only while rendering
+	uint32_t nodes_culled = 0; // by the last render
+	uint32_t nodes_recorded = 0; // by the last render; every other node drawn was replayed
+
+	void push_clip(layout_rect r);
+	void pop_clip();
+	bool outside_clip(layout_rect r) const {
+		return !clip_stack.empty() && !intersects(clip_stack.back(), r);
+	}
+	layout_rect render_bounds(ui_node const& n, layout_position offset) const; // the node and its background overhang
+	layout_rect opaque_area(ui_node const& n, layout_position offset) const; // covered by a solid background; may be empty
+	// as n.mouse_probe, but skips nodes outside the clip and subtrees whose extent misses the probe
+	probe_result probe_node(ui_node& n, layout_position probe_pos, layout_position offset, postponed_list& postponed);
+
+	//
+	// mouse probe index
+	//
+
+	// The extent of a node is the bounding box of its own area and the extents of its children, pop-ups
+	// included, relative to the node. Since a node only claims the mouse inside its own area, a probe that
+	// misses the extent can skip the whole subtree, which makes the tree a bounding volume hierarchy. Extents
+	// are computed on demand and kept until a whole-tree layout pass, until invalidate_layout is called for
+	// the node or one of its ancestors, or until invalidate_render is called for the node or one of its
+	// descendants.
+	struct probe_extent {
+		layout_rect area;
+		uint32_t generation = 0;
+	};
+	ankerl::unordered_dense::map<ui_node const*, probe_extent> probe_extents;
+	uint32_t probe_generation = 1;
+	uint32_t probes_skipped = 0; // subtrees skipped by the last mouse move
+	uint32_t mouse_probes = 0; // mouse moves that probed the tree
+
+	layout_rect get_probe_extent(ui_node& n);
+	void drop_probe_extents(ui_node& n); // of n and its subtree
+
+	// The interactables of a focus container in the order they are numbered for keyboard and controller
+	// groups, looking through children that are transparent to focus. Kept until the layout generation
+	// changes or invalidate_render is called for the container or one of its descendants.
+	struct interactable_index {
+		std::vector<ui_node*> items;
+		uint32_t generation = 0;
+	};
+	ankerl::unordered_dense::map<ui_node const*, interactable_index> interactable_indices;
+
+	std::span<ui_node* const> get_interactables(ui_node const& n);
+
+	// Changes whenever nodes may have moved, appeared or disappeared: layout passes, node creation and
+	// release, and page changes. Code that moves, shows or hides nodes anywhere else, such as in an on_update
+	// function or a command run from input, must call invalidate_layout or invalidate_render.
+	uint32_t layout_generation = 1;
+	void invalidate_layout() {
+		if(in_parallel_layout) {
+			layout_invalidated_in_parallel.store(true, std::memory_order_relaxed);
+			return;
+		}
+		++layout_generation;
+		++placement_generation;
+		++probe_generation;
+		invalidate_all_rendering(); // anything may have moved
+	}
+	// Only n and its subtree may have moved, appeared or disappeared, so only their probe extents and those
+	// of n's ancestors are dropped, and only n's area is redrawn.
+	void invalidate_layout(ui_node* n);
+	// Only n itself gained, lost or moved children, so only the probe extents of n and its ancestors are
+	// dropped. Redrawing is left to the caller.
+	void invalidate_node_layout(ui_node* n);
+
+	// Workspace positions and effective visibility, each found from the parent's, so a walk of many nodes
+	// touches every ancestor once. invalidate_render may mean that a node moved, was shown or was hidden,
+	// which affects its whole subtree, so it starts a new placement generation as well as invalidate_layout
+	// does.
+	struct cached_placement {
+		content_position at;
+		bool visible = false; // attached to the root, with no hidden flag on the node or an ancestor
+		uint32_t generation = 0;
+	};
+	ankerl::unordered_dense::map<ui_node const*, cached_placement> placements;
+	uint32_t placement_generation = 1;
+
+	cached_placement get_placement(ui_node& n);
+	// For a node moved, shown or hidden outside of a layout pass, which the update pass notices for the
+	// nodes its functions run on: invalidates the node and sends on_visible or on_hide down its subtree if
+	// that changed whether it can be seen.
+	void node_state_changed(ui_node& n, uint32_t old_flags);
+
+	// Where each node's prompt goes, as repopulate_key_actions last worked it out. An entry holds while the
+	// layout generation and the node's workspace rectangle are unchanged. interactable_layout may depend on
+	// whether the node contains the focus, so change_focus drops the entries of the nodes it notifies.
+	struct cached_prompt {
+		layout_rect placement{ };
+		layout_rect node_area{ }; // in the workspace, when placement was found
+		interactable_placement kind = interactable_placement::suppressed;
+		interactable_orientation orientation = interactable_orientation::left;
+		uint32_t generation = 0;
+	};
+	ankerl::unordered_dense::map<ui_node const*, cached_prompt> prompt_placements;
+
+	cached_prompt get_prompt_placement(ui_node& n, layout_position ws_size);
+
+	// what the last probe and the focus changes that followed it were computed from; a move that would
+	// repeat them is skipped
+	struct mouse_move_key {
+		em x;
+		em y;
+		uint32_t layout_generation = 0;
+		ui_node* focus = nullptr;
+		int32_t child_offset = 0;
+		int32_t child_offset_end = 0;
+		size_t focus_depth = 0;
+		ieditable_text* edit_target = nullptr;
+
+		bool operator==(mouse_move_key const&) const = default;
+	};
+	std::optional<mouse_move_key> last_mouse_move;
+
+	mouse_move_key make_mouse_move_key(layout_position p) const;
+
+	//
+	// per frame memory
+	//
+
+	frame_arena frame_memory; // transient allocations of rendering, probing and focus repopulation
+	uint32_t frame_memory_users = 0;
+
+	// keeps frame_memory in use; it is reset when the outermost scope ends
+	struct frame_memory_scope {
+		root& r;
+		frame_memory_scope(root& r) : r(r) {
+			++r.frame_memory_users;
+		}
+		~frame_memory_scope() {
+			if(--r.frame_memory_users == 0)
+				r.frame_memory.reset();
+		}
+	};
+
+	//
+	// frame scheduling
+	//
+
+	using frame_clock = std::chrono::steady_clock;
+
+	bool needs_update = true; // user on_update functions should run
+	bool needs_layout = true; // the tree should be resized to the workspace
+	bool needs_render = true;
+	frame_clock::time_point next_wakeup = frame_clock::time_point::max(); // earliest timer or animation step
+
+	void request_update() {
+		record(replay::entry{ .type = replay::entry_type::request_update });
+		needs_update = true;
+	}
+	void request_layout() {
+		record(replay::entry{ .type = replay::entry_type::request_layout });
+		needs_layout = true;
+	}
+	void request_wakeup(frame_clock::time_point at) {
+		next_wakeup = std::min(next_wakeup, at);
+	}
+	bool is_idle() const {
+		return !needs_update && !needs_layout && !needs_render;
+	}
+	update_scheduler<ui_node, root> update_pass; // runs on_update for the whole tree, batching the types that opt in
+
+	// runs the update and layout work that is due; returns true if render should be called
+	bool advance_frame(frame_clock::time_point now);
+
+	//
+	// queued input
+	//
+
+	// An event accepted by post_input. Its handler runs when the queue is drained, which happens at the start
+	// of each frame and before any input handler called directly does its own work.
+	struct input_event {
+		enum class kind : uint8_t {
+			mouse_move, mouse_scroll, mouse_lbutton, mouse_rbutton, mouse_lbutton_up, mouse_rbutton_up, key_down, key_up, character
+		};
+		kind type = kind::mouse_move;
+		click_type click = click_type::singlec;
+		bool repeat = false;
+		native_char c = 0;
+		uint32_t scancode = 0;
+		uint32_t vk_code = 0;
+		float amount = 0.0f;
+		layout_position position{ };
+		frame_clock::time_point at{ }; // when it was posted
+	};
+	// The queue has a single producer: the first thread to post is the only one that may post afterwards.
+	// That is either the thread running the root (the Windows backend posts from its window procedure) or one
+	// separate input thread, never both. A separate thread must wake the thread running the root, since
+	// nothing is drained until the next frame or input handler.
+	spsc_queue<input_event> input_queue{ 1024 };
+	uint32_t input_events_coalesced = 0; // events merged into an earlier one of the same run
+	bool draining_input = false;
+#ifndef NDEBUG
+	std::atomic<std::thread::id> input_producer{ };
+#endif
+
+	// false if the queue is full, in which case the event is dropped; only ever call from one thread, see above
+	bool post_input(input_event e) {
+#ifndef NDEBUG
+		auto self = std::this_thread::get_id();
+		auto expected = std::thread::id{ };
+		input_producer.compare_exchange_strong(expected, self);
+		assert(input_producer.load() == self && "input may only be posted from one thread");
+#endif
+		e.at = frame_clock::now();
+		return input_queue.push(e);
+	}
+	bool post_mouse_move(layout_position p) {
+		return post_input(input_event{ .type = input_event::kind::mouse_move, .position = p });
+	}
+	bool post_mouse_scroll(float amount) {
+		return post_input(input_event{ .type = input_event::kind::mouse_scroll, .amount = amount });
+	}
+	// whether the last mouse probe found anything; what on_mouse_move and on_mouse_scroll return, for callers
+	// that posted the event instead
+	bool mouse_over_ui() const {
+		for(auto& r : under_mouse.type_array) {
+			if(r.node)
+				return true;
+		}
+		return false;
+	}
+	// Runs the handlers for everything posted so far, in order. A run of moves is reduced to its last position
+	// and a run of scrolls to one scroll by their total; key and character events, repeats included, are
+	// handled one by one.
+	void drain_input();
+	// What every input handler does first. Input posted earlier is handled before it, and a handler called
+	// from outside is timed from now; drain_input times the events it runs from when they were posted, and
+	// the calls the root makes to itself, such as the mouse move after an update, are not input.
+	void begin_input_handler() {
+		drain_input();
+		if(!draining_input && unrecorded_depth == 0)
+			latency.input_arrived(frame_clock::now());
+	}
+
+	// Input to present timing. Input is timed from when it was posted, or from when its handler was called
+	// directly; backends call on_frame_presented once a rendered frame has reached the screen.
+	latency_tracker latency;
+	void on_frame_presented() {
+		latency.presented(frame_clock::now());
+	}
+
+	// Captures the entry points called from outside, for replay::run. Calls the root makes to itself, such
+	// as on_update from advance_frame, are left out because replaying the outer call repeats them.
+	replay::recorder* recording = nullptr;
+	uint32_t unrecorded_depth = 0;
+	void record(replay::entry const& e, frame_clock::time_point at = frame_clock::now()) {
+		if(recording && unrecorded_depth == 0)
+			recording->add(e, at);
+	}
+
+	root(system_interface& system, layout_position initial_size) : system(system), workspace(initial_size), display(system) {
 		system.register_root(*this);
 	}
 
@@ -619,6 +1070,8 @@ public:
 	void set_window_focus(focus_tracker a);
 	void repopulate_key_actions();
 	void set_prompt_mode(prompt_mode p) {
+		if(pmode != p)
+			damage_interactables();
 		pmode = p;
 	}
 
@@ -636,7 +1089,8 @@ public:
 
 	bool contains_focus(ui_node const*);
 	void back_out_focus(ui_node&);
-	layout_position workspace_placement(ui_node&);
+	layout_position workspace_placement(ui_node&); // clamped to the em range
+	content_position workspace_content_placement(ui_node&);
 
 	ui_node* make_control_by_type(ui_node* parent, uint32_t type);
 	void release_node(ui_node* n);
@@ -706,7 +1160,7 @@ public:
 
 	void load_definitions_from_file(std::unique_ptr<file> df) {
 		defintions_file = std::move(df);
-		load_definitions(df->data(), df->size());
+		load_definitions(defintions_file->data(), defintions_file->size());
 	}
 	void load_definitions(char const* data, size_t size);
 	layout_position get_icon_position(uint32_t type_id) const {
@@ -969,6 +1423,43 @@ public:
 	}
 };
 
+interactable_result container_node::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result proportional_window::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result space_filler::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result dynamic_column::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result monotype_column::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result panes_set::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result layers::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result dynamic_grid::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result static_text::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result icon_button::interactable_layout(root& r) {
+	return interactable_result{ r.get_icon_position(type_id), r.get_interactable_definition(ui_node::type_id) };
+}
+interactable_result edit_control::interactable_layout(root& r) {
+	if(r.contains_focus(this))
+		return interactable_result{ layout_position{ }, interactable_definition{ interactable_orientation::left, interactable_placement::suppressed } };
+	else
+		return interactable_result{ layout_position{ }, interactable_definition{ interactable_orientation::left, interactable_placement::internal } };
+}
+
 namespace impl {
 char* get_local_data(root& r, ui_node* n, uint32_t variable) {
 	int32_t offset = -1;
@@ -1027,7 +1518,6 @@ void root::destroy_members(ui_node* n) const {
 	char* address = reinterpret_cast<char*>(n);
 	auto data = address + n->size();
 
-	auto type = n->type_id;
 	auto type = n->type_id;
 	auto members = get_variable_definition(type);
 	for(auto i = members.start; i != members.end; ++i) {
@@ -1036,13 +1526,20 @@ void root::destroy_members(ui_node* n) const {
 }
 
 void root::release_node(ui_node* n) {
+	std::lock_guard lg(node_lock);
 	back_out_focus(*n);
+	retained.erase(n);
+	invalidate_all_rendering();
+	drop_probe_extents(*n); // the node may be reused elsewhere
+	invalidate_node_layout(n);
 	n->parent = nullptr;
 	auto& free_stock = free_nodes[n->type_id];
 	free_stock.push_back(n);
 }
 
 ui_node* root::make_control_by_type( ui_node* parent, uint32_t type) {
+	std::lock_guard lg(node_lock);
+	invalidate_all_rendering();
 	ui_node* result = nullptr;
 
 	auto& free_stock = free_nodes[type];
@@ -1052,6 +1549,8 @@ ui_node* root::make_control_by_type( ui_node* parent, uint32_t type) {
 		result->parent = parent;
 		result->behavior_flags = get_standard_flags(type);
 		result->position = get_default_position(type);
+		if(parent)
+			invalidate_node_layout(parent);
 		destroy_members(result);
 		initialize_members(result);
 		result->force_resize(*this, layout_position{ result->position.width, result->position.height });
@@ -1083,7 +1582,6 @@ ui_node* root::make_control_by_type( ui_node* parent, uint32_t type) {
 			raw_data = reinterpret_cast<char*>(minui_aligned_alloc(sizeof(space_filler) + var_size, alignof(space_filler)));
 			memset(raw_data, 0, sizeof(space_filler) + var_size);
 			new (raw_data)space_filler();
-			space_filler* ptr = reinterpret_cast<space_filler*>(raw_data);
 			result = reinterpret_cast<ui_node*>(raw_data);
 			break;
 		}
@@ -1190,6 +1688,8 @@ ui_node* root::make_control_by_type( ui_node* parent, uint32_t type) {
 	result->parent = parent;
 	result->behavior_flags = get_standard_flags(type);
 	result->position = get_default_position(type);
+	if(parent)
+		invalidate_node_layout(parent);
 	initialize_members(result);
 	result->on_create(*this);
 	
@@ -1203,7 +1703,6 @@ ui_node* make_page_controls(root& r, ui_node* parent) {
 	raw_data = reinterpret_cast<char*>(minui_aligned_alloc(sizeof(page_controls), alignof(page_controls)));
 	memset(raw_data, 0, sizeof(page_controls));
 	new (raw_data)page_controls();
-	page_controls* ptr = reinterpret_cast<page_controls*>(raw_data);
 	result = reinterpret_cast<ui_node*>(raw_data);
 
 	r.node_repository.push_back(std::unique_ptr<ui_node, ui_node_disposal>{result});
@@ -1231,13 +1730,364 @@ layout_position get_sub_position(ui_node& parent, ui_node& child) {
 	return result;
 }
 
+void root::set_layout_threads(uint32_t count) {
+	if(count <= 1)
+		layout_pool.reset();
+	else if(!layout_pool || layout_pool->thread_count() != count)
+		layout_pool = std::make_unique<task_pool>(count);
+}
+void root::resolve_lazy_definitions() {
+	if(lazy_definitions_resolved)
+		return;
+	for(uint32_t i = 0; i < defined_element_types; ++i) {
+		get_on_update(i);
+		get_on_gain_focus(i);
+		get_on_lose_focus(i);
+		get_on_visible(i);
+		get_on_hide(i);
+		get_on_create(i);
+		get_user_fn_a(i);
+		get_user_fn_b(i);
+		get_user_mouse_fn_a(i);
+		get_text_information(i);
+	}
+	lazy_definitions_resolved = true;
+}
+void root::parallel_layout(size_t count, std::function<void(size_t)> const& fn) {
+	if(!parallel_layout_enabled() || count < 2) {
+		for(size_t i = 0; i < count; ++i)
+			fn(i);
+		return;
+	}
+
+	// the definition accessors fill their tables on first use, so everything is resolved up front
+	// to make them read only while the workers run
+	resolve_lazy_definitions();
+
+	in_parallel_layout = true;
+	try {
+		layout_pool->parallel_for(count, fn);
+	} catch(...) {
+		in_parallel_layout = false;
+		throw;
+	}
+	in_parallel_layout = false;
+
+	if(layout_invalidated_in_parallel.exchange(false, std::memory_order_relaxed))
+		invalidate_layout();
+	// the deferred work may itself lay out and queue more
+	while(true) {
+		std::vector<std::function<void()>> work;
+		{
+			std::lock_guard lg(deferred_layout_lock);
+			work.swap(deferred_layout_work);
+		}
+		if(work.empty())
+			break;
+		for(auto& w : work)
+			w();
+	}
+}
+void root::run_after_parallel_layout(std::function<void()> fn) {
+	if(!in_parallel_layout) {
+		fn();
+		return;
+	}
+	std::lock_guard lg(deferred_layout_lock);
+	deferred_layout_work.push_back(std::move(fn));
+}
+
+void root::render_node(ui_node& n, layout_position offset, postponed_list& postponed) {
+	auto bounds = render_bounds(n, offset);
+	// pop-ups inside a culled subtree are skipped along with it
+	if(outside_clip(bounds)) {
+		++nodes_culled;
+		return;
+	}
+	if(!retained_rendering) {
+		n.render(*this, offset, postponed);
+		return;
+	}
+
+	auto& slot = retained[&n];
+	if(!slot)
+		slot = std::make_unique<retained_render>();
+	auto& rr = *slot;
+
+	bool highlighted = under_mouse.type_array[size_t(mouse_interactivity::position)].node == &n;
+	layout_rect clip = clip_stack.empty() ? layout_rect{ } : clip_stack.back();
+	bool same_clip = rr.clip.x == clip.x && rr.clip.y == clip.y && rr.clip.width == clip.width && rr.clip.height == clip.height;
+	if(rr.valid && rr.generation == render_generation && rr.behavior_flags == n.behavior_flags && rr.highlighted == highlighted && rr.offset.x == offset.x && rr.offset.y == offset.y && same_clip) {
+		display.replay(rr.commands);
+		postponed.insert(postponed.end(), rr.pop_ups.begin(), rr.pop_ups.end());
+		return;
+	}
+
+	// Only a node that looks different damages its area, where it was and where it is; one recorded again
+	// only because something inside it changed leaves the damage to that. Prompts that appear or disappear
+	// are damaged by repopulate_key_actions, so the flag for them is left out.
+	bool drawn_before = rr.generation != 0;
+	bool flags_changed = ((rr.behavior_flags ^ n.behavior_flags) & ~behavior::interaction_flagged) != 0;
+	if(!drawn_before || rr.changed || flags_changed || rr.highlighted != highlighted || rr.offset.x != offset.x || rr.offset.y != offset.y || !same_clip) {
+		if(drawn_before)
+			damage.add(system.to_screen_space(rr.bounds));
+		damage.add(system.to_screen_space(bounds));
+	}
+
+	auto outer_target = display.target;
+	auto first_pop_up = postponed.size();
+
+	++nodes_recorded;
+	rr.commands.clear();
+	display.target = &rr.commands;
+	n.render(*this, offset, postponed);
+	display.target = outer_target;
+
+	rr.pop_ups.assign(postponed.begin() + first_pop_up, postponed.end());
+	rr.offset = offset;
+	rr.clip = clip;
+	rr.behavior_flags = n.behavior_flags;
+	rr.generation = render_generation;
+	rr.highlighted = highlighted;
+	rr.bounds = bounds;
+	rr.valid = true;
+	rr.changed = false;
+
+	if(outer_target)
+		outer_target->insert(outer_target->end(), rr.commands.begin(), rr.commands.end());
+}
+
+void root::invalidate_render(ui_node const* n) {
+	// layout workers share the root; the layout pass redraws everything once it finishes
+	if(in_parallel_layout)
+		return;
+	if(n) {
+		needs_render = true;
+		if(auto it = retained.find(n); it != retained.end())
+			it->second->changed = true;
+	}
+	for(; n; n = n->parent) {
+		if(auto it = retained.find(n); it != retained.end())
+			it->second->valid = false;
+		if(auto it = probe_extents.find(n); it != probe_extents.end())
+			it->second.generation = 0;
+		if(auto it = interactable_indices.find(n); it != interactable_indices.end())
+			it->second.generation = 0;
+	}
+	++placement_generation;
+	last_mouse_move.reset();
+}
+
+void root::invalidate_layout(ui_node* n) {
+	if(in_parallel_layout || !n) {
+		invalidate_layout();
+		return;
+	}
+	damage_node(n);
+	drop_probe_extents(*n);
+	invalidate_node_layout(n);
+}
+
+void root::invalidate_node_layout(ui_node* n) {
+	if(in_parallel_layout) {
+		invalidate_layout();
+		return;
+	}
+	++layout_generation;
+	invalidate_render(n); // the extents, placements and retained entries of n and its ancestors
+}
+
+void root::drop_probe_extents(ui_node& n) {
+	if(auto it = probe_extents.find(&n); it != probe_extents.end())
+		it->second.generation = 0;
+	auto count = n.child_count();
+	for(uint32_t i = 0; i < count; ++i) {
+		if(auto c = n.get_child(i))
+			drop_probe_extents(*c);
+	}
+}
+
+void root::damage_node(ui_node* n) {
+	if(!n)
+		return;
+	auto pos = workspace_placement(*n);
+	layout_rect area{ pos.x, pos.y, n->position.width, n->position.height };
+	damage.add(system.to_screen_space(area));
+
+	auto ext = get_background_definition(n->type_id).exterior_edge_offsets;
+	if(ext.x.value != 0 || ext.y.value != 0 || ext.width.value != 0 || ext.height.value != 0)
+		damage.add(system.to_screen_space(layout_rect{ pos.x + ext.x, pos.y + ext.y, n->position.width + ext.width, n->position.height + ext.height }));
+}
+
+void root::damage_interactable(placed_interactable const& i) {
+	invalidate_render(i.element);
+	damage_node(i.element);
+	damage.add(system.to_screen_space(i.placement));
+}
+
+void root::damage_interactables() {
+	for(auto& i : current_interactables)
+		damage_interactable(i);
+}
+
+void root::push_clip(layout_rect r) {
+	if(!clip_stack.empty())
+		r = intersection(clip_stack.back(), r);
+	clip_stack.push_back(r);
+	if(clip_to_display)
+		display.clip(system.to_screen_space(r), true);
+}
+
+void root::pop_clip() {
+	clip_stack.pop_back();
+	if(clip_to_display) {
+		if(clip_stack.empty())
+			display.clip(screen_space_rect{ 0, 0, 0, 0 }, false);
+		else
+			display.clip(system.to_screen_space(clip_stack.back()), true);
+	}
+}
+
+layout_rect root::render_bounds(ui_node const& n, layout_position offset) const {
+	auto ext = get_background_definition(n.type_id).exterior_edge_offsets;
+	if(ext.x.value == 0 && ext.y.value == 0 && ext.width.value == 0 && ext.height.value == 0)
+		return layout_rect{ offset.x, offset.y, n.position.width, n.position.height };
+
+	auto x0 = std::min(int32_t(offset.x.value), int32_t(offset.x.value) + ext.x.value);
+	auto y0 = std::min(int32_t(offset.y.value), int32_t(offset.y.value) + ext.y.value);
+	auto x1 = std::max(int32_t(offset.x.value) + n.position.width.value, int32_t(offset.x.value) + ext.x.value + n.position.width.value + ext.width.value);
+	auto y1 = std::max(int32_t(offset.y.value) + n.position.height.value, int32_t(offset.y.value) + ext.y.value + n.position.height.value + ext.height.value);
+	return layout_rect{ saturate_em(x0), saturate_em(y0), saturate_em(x1 - x0), saturate_em(y1 - y0) };
+}
+
+layout_rect root::opaque_area(ui_node const& n, layout_position offset) const {
+	if((n.behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
+		return layout_rect{ };
+
+	switch(get_class(n.type_id)) {
+		case 0: case 1: case 2: case 3: case 5: case 8: case 9: case 10: case 11: case 12:
+			break; // the classes that call render_background
+		default:
+			return layout_rect{ };
+	}
+
+	auto bg = get_background_definition(n.type_id);
+	if(bg.image.value != -1 || bg.brush >= opaque_brushes.size() || !opaque_brushes[bg.brush])
+		return layout_rect{ };
+	auto& ext = bg.exterior_edge_offsets;
+	return layout_rect{ offset.x + ext.x, offset.y + ext.y, n.position.width + ext.width, n.position.height + ext.height };
+}
+
+probe_result root::probe_node(ui_node& n, layout_position probe_pos, layout_position offset, postponed_list& postponed) {
+	if(outside_clip(render_bounds(n, offset)))
+		return probe_result{ };
+	if(!contains(get_probe_extent(n) + offset, probe_pos)) {
+		++probes_skipped;
+		return probe_result{ };
+	}
+	return n.mouse_probe(*this, probe_pos, offset, postponed);
+}
+
+layout_rect root::get_probe_extent(ui_node& n) {
+	if(auto it = probe_extents.find(&n); it != probe_extents.end() && it->second.generation == probe_generation)
+		return it->second.area;
+
+	// hidden nodes claim nothing and do not probe their children
+	layout_rect area{ };
+	if((n.behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) == 0) {
+		int32_t x0 = 0;
+		int32_t y0 = 0;
+		int32_t x1 = n.position.width.value;
+		int32_t y1 = n.position.height.value;
+		bool empty = x1 <= 0 || y1 <= 0;
+		auto count = n.child_count();
+		for(uint32_t i = 0; i < count; ++i) {
+			auto c = n.get_child(i);
+			if(!c)
+				continue;
+			auto e = get_probe_extent(*c);
+			if(e.width.value <= 0 || e.height.value <= 0)
+				continue;
+			auto p = get_sub_position(n, *c);
+			auto cx0 = int32_t(p.x.value) + e.x.value;
+			auto cy0 = int32_t(p.y.value) + e.y.value;
+			if(empty) {
+				x0 = cx0;
+				y0 = cy0;
+				x1 = cx0 + e.width.value;
+				y1 = cy0 + e.height.value;
+				empty = false;
+			} else {
+				x0 = std::min(x0, cx0);
+				y0 = std::min(y0, cy0);
+				x1 = std::max(x1, cx0 + e.width.value);
+				y1 = std::max(y1, cy0 + e.height.value);
+			}
+		}
+		if(!empty)
+			area = layout_rect{ saturate_em(x0), saturate_em(y0), saturate_em(x1 - x0), saturate_em(y1 - y0) };
+	}
+
+	// the recursion may have grown the map, so the entry is looked up again
+	probe_extents.insert_or_assign(&n, probe_extent{ area, probe_generation });
+	return area;
+}
+
+bool root::advance_frame(frame_clock::time_point now) {
+	if(now >= next_wakeup) {
+		next_wakeup = frame_clock::time_point::max();
+		needs_update = true;
+	}
+	if(node_repository.empty())
+		return false;
+
+	drain_input();
+	record(replay::entry{ .type = replay::entry_type::frame }, now);
+	if(needs_update) {
+		++unrecorded_depth;
+		on_update();
+		--unrecorded_depth;
+	}
+	latency.input_handled(frame_clock::now());
+	if(needs_layout) {
+		needs_layout = false;
+		node_repository[0]->force_resize(*this, system.get_workspace());
+		invalidate_all_rendering();
+		invalidate_layout();
+	}
+	latency.layout_done(frame_clock::now());
+	if(!needs_render)
+		latency.nothing_to_render();
+	return needs_render;
+}
+
 void root::render() {
-	std::vector<postponed_render> pop_ups;
-	node_repository[0]->render(*this, layout_position{ em{ 0 }, em{ 0 } }, pop_ups);
+	drain_input();
+	record(replay::entry{ .type = replay::entry_type::render });
+	needs_render = false;
+
+	auto ws = system.get_workspace();
+	damage.set_bounds(system.to_screen_space(layout_rect{ em{ 0 }, em{ 0 }, ws.x, ws.y }));
+
+	nodes_culled = 0;
+	nodes_recorded = 0;
+	clip_to_display = true;
+	push_clip(layout_rect{ em{ 0 }, em{ 0 }, ws.x, ws.y });
+
+	frame_memory_scope memory(*this);
+	postponed_list pop_ups(&frame_memory);
+	render_node(*node_repository[0], layout_position{ em{ 0 }, em{ 0 } }, pop_ups);
 	for(uint32_t i = 0; i < pop_ups.size(); ++i) {
-		pop_ups[i].n->render(*this, pop_ups[i].offset, pop_ups);
+		render_node(*pop_ups[i].n, pop_ups[i].offset, pop_ups);
 	}
 
+	pop_clip();
+	clip_to_display = false;
+	// nodes recorded again above have added their damage; nothing has reached the system yet
+	system.set_damaged_regions(damage.get_regions());
+	damage.clear();
+	display.flush();
+
 	// render interactables
 	if(pmode != prompt_mode::hidden) {
 		for(auto& i : current_interactables) {
@@ -1245,6 +2095,7 @@ void root::render() {
 			system.interactable(screen_space_point{ l.x, l.y }, i.state, get_foreground_brush(i.element->type_id), get_highlight_brush(i.element->type_id), get_info_brush(i.element->type_id), get_background_brush(i.element->type_id), i.orientation, rendering_modifiers::none);
 		}
 	}
+	latency.render_done(frame_clock::now());
 }
 
 ui_node* top_focus(std::vector<stored_focus> const& vec) {
@@ -1273,11 +2124,16 @@ void root::change_focus(ui_node* old_focus, ui_node* new_focus) {
 
 	auto common_root = find_common_root(new_focus, old_focus);
 
+	// what contains the focus draws differently, so only the nodes that gain or lose it are redrawn
 	for(ui_node* losing = old_focus; losing && losing != common_root; losing = losing->parent) {
+		prompt_placements.erase(losing);
+		invalidate_render(losing);
 		losing->on_lose_focus(*this);
 	}
 
 	for(ui_node* gaining = new_focus; gaining && gaining != common_root; gaining = gaining->parent) {
+		prompt_placements.erase(gaining);
+		invalidate_render(gaining);
 		gaining->on_gain_focus(*this);
 	}
 }
@@ -1310,103 +2166,33 @@ void root::back_out_focus(ui_node& n) {
 	set_window_focus(focus_tracker{ &n, -1, -1 });
 }
 
-struct sub_items_iterator {
-	struct node_position {
-		ui_node const* n;
-		int32_t child_position;
-		int32_t child_max;
-	};
-
-	std::vector<node_position> iteration_stack;
-
-	void advance_iterator_status() {
-		if(iteration_stack.empty())
-			return;
-		
-		int32_t* back_pos = nullptr;
-		auto current_node = iteration_stack.back().n;
-		
-		bool terminated_search;
-		do {
-			++(*back_pos);
-			terminated_search = false;
-			if(*back_pos >= iteration_stack.back().child_max) {
-				iteration_stack.pop_back();
-				back_pos = &(iteration_stack.back().child_position);
-				current_node = iteration_stack.back().n;
-			} else if(auto c = current_node->get_child(*back_pos); c) {
-				if((c->behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) == 0)
-					terminated_search = false;
-				if((c->behavior_flags & behavior::transparent_to_focus) != 0) {
-					terminated_search = false;
-					iteration_stack.push_back(node_position{ c, -1 , int32_t(c->child_count()) });
-					back_pos = &(iteration_stack.back().child_position);
-					current_node = c;
-				} else if((c->behavior_flags & (behavior::interaction_info | behavior::interaction_command | behavior::interaction_focus)) != 0) {
-					terminated_search = true;
-				} else if(c->child_count() > 0) {
-					terminated_search = true;
-				}
-			}
-		} while(!terminated_search && !iteration_stack.empty());
-	}
-
-	sub_items_iterator(ui_node const* n) {
-		if(n) {
-			iteration_stack.push_back(node_position{ n, -1, int32_t(n->child_count()) });
-			advance_iterator_status();
-		}
-	}
-	sub_items_iterator() {
-	}
-	bool operator==(sub_items_iterator const& o) const {
-		return iteration_stack == o.iteration_stack;
-	}
-	bool operator!=(sub_items_iterator const& o) const {
-		return !(*this == o);
-	}
-	ui_node* operator*() const {
-		if(iteration_stack.empty())
-			return nullptr;
-		else
-			return iteration_stack.back().n->get_child(uint32_t(iteration_stack.back().child_position));
-	}
-	sub_items_iterator& operator++() {
-		advance_iterator_status();
-		return *this;
-	}
-	sub_items_iterator& operator+=(int32_t n) {
-		while(n > 0) {
-			++(*this);
-			--n;
-		}
-		return *this;
+void append_interactables(ui_node const& n, std::vector<ui_node*>& out) {
+	auto count = int32_t(n.child_count());
+	for(int32_t i = 0; i < count; ++i) {
+		auto c = n.get_child(i);
+		// hidden children take no groups, and neither does anything under them
+		if(!c || (c->behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
+			continue;
+		if((c->behavior_flags & behavior::transparent_to_focus) != 0)
+			append_interactables(*c, out);
+		else if((c->behavior_flags & (behavior::interaction_info | behavior::interaction_command | behavior::interaction_focus)) != 0 || c->child_count() > 0)
+			out.push_back(c);
 	}
-};
-
-struct sub_items_iterator_generator {
-	ui_node const* n;
+}
 
-	sub_items_iterator_generator(ui_node const* n) : n(n) {
-	}
-	sub_items_iterator begin() {
-		return sub_items_iterator(n);
+std::span<ui_node* const> root::get_interactables(ui_node const& n) {
+	// other entries may be added while the result is in use; that moves the vectors but not their contents
+	auto& index = interactable_indices[&n];
+	if(index.generation != layout_generation) {
+		index.items.clear();
+		append_interactables(n, index.items);
+		index.generation = layout_generation;
 	}
-	sub_items_iterator end() {
-		return sub_items_iterator();
-	}
-};
-
-sub_items_iterator_generator interactables(ui_node const& n) {
-	return sub_items_iterator_generator(&n);
+	return index.items;
 }
 
 int32_t calaculate_interactables_at_node(root& lm, ui_node const& n) {
-	int32_t sum = 0;
-	for(auto i : interactables(n)) {
-		++sum;
-	}
-	return sum;
+	return int32_t(lm.get_interactables(n).size());
 }
 
 std::array<grouping_range, 12> divide_group(grouping_range i, int32_t into) {
@@ -1479,7 +2265,7 @@ std::optional<grouping_range> find_group_containing(root& lm, ui_node const& n,
 		auto divided = divide_group(test_group, 12);
 
 		uint32_t submatch = 0;
-		for(; submatch < 12ui32; ++submatch) {
+		for(; submatch < uint32_t(12); ++submatch) {
 			if(divided[submatch].start <= i.start && divided[submatch].end >= i.end &&
 				(divided[submatch].end - divided[submatch].start) > (i.end - i.start)) {
 				is_everything = false;
@@ -1487,7 +2273,7 @@ std::optional<grouping_range> find_group_containing(root& lm, ui_node const& n,
 			}
 		}
 
-		if(submatch == 12ui32) {
+		if(submatch == uint32_t(12)) {
 			if(is_everything) {
 				return grouping_range{ -1, -1 };
 			} else {
@@ -1521,69 +2307,98 @@ focus_tracker get_parent_group_or_node(root& lm, focus_tracker r)  {
 	}
 }
 
+root::cached_prompt root::get_prompt_placement(ui_node& n, layout_position ws_size) {
+	auto base = workspace_placement(n);
+	layout_rect area{ base.x, base.y, n.position.width, n.position.height };
+	if(auto it = prompt_placements.find(&n); it != prompt_placements.end()) {
+		auto& c = it->second;
+		if(c.generation == layout_generation && c.node_area.x == area.x && c.node_area.y == area.y && c.node_area.width == area.width && c.node_area.height == area.height)
+			return c;
+	}
+
+	auto i_layout = n.interactable_layout(*this);
+	cached_prompt result{ .node_area = area, .kind = i_layout.placement, .orientation = i_layout.orientation, .generation = layout_generation };
+	if(i_layout.placement == interactable_placement::internal) {
+		auto ico_pos = get_icon_position(n.type_id);
+		result.placement = layout_rect{ ico_pos.x, ico_pos.y, em{ 100 }, em{ 100 } } + base;
+	} else if(i_layout.placement == interactable_placement::external) {
+		layout_rect offset{ em{ 0 }, em{ 0 }, em{ 100 }, em{ 100 } };
+		if(i_layout.orientation == interactable_orientation::left) {
+			offset.y = n.position.height / 2 - em{ 50 };
+			if(base.x >= em{ 100 })
+				offset.x = em{ -100 };
+			else
+				offset.x = n.position.width;
+		} else if(i_layout.orientation == interactable_orientation::right) {
+			offset.y = n.position.height / 2 - em{ 50 };
+			if(base.x + n.position.width + em{ 100 } > ws_size.x)
+				offset.x = n.position.width;
+			else
+				offset.x = em{ -100 };
+		} else if(i_layout.orientation == interactable_orientation::above) {
+			offset.x = n.position.width / 2 - em{ 50 };
+			if(base.y >= em{ 100 })
+				offset.y = em{ -100 };
+			else
+				offset.y = n.position.height;
+		} else {
+			offset.x = n.position.width / 2 - em{ 50 };
+			if(base.y + n.position.height + em{ 100 } > ws_size.y)
+				offset.y = n.position.height;
+			else
+				offset.y = em{ -100 };
+		}
+		result.placement = offset + base;
+	}
+	prompt_placements.insert_or_assign(&n, result);
+	return result;
+}
+
 void root::repopulate_key_actions() {
 	auto ws_size = system.get_workspace();
 	auto add_interactable = [&](ui_node* n, int32_t group, bool display_as_group) {
-		auto i_layout = n->interactable_layout(*this);
+		if(!n) // the focus is on the base element, which has no parent to escape to
+			return;
+		auto p = get_prompt_placement(*n, ws_size);
 		n->behavior_flags |= behavior::interaction_flagged;
-		if(i_layout.placement == interactable_placement::internal) {
-			auto ico_pos = get_icon_position(n->type_id);
-			if(display_as_group)
-				current_interactables.push_back(placed_interactable{
-					n,
-					layout_rect{ ico_pos.x, ico_pos.y, em{ 100 }, em{ 100 } } + workspace_placement(*n),
-					interactable_state(interactable_state::group, uint8_t(group + 1)),
-					i_layout.orientation
-				});
-			else
-				current_interactables.push_back(placed_interactable{
-					n,
-					layout_rect{ ico_pos.x, ico_pos.y, em{ 100 }, em{ 100 } } + workspace_placement(*n),
-					interactable_state(interactable_state::key, uint8_t(group + 1)),
-					i_layout.orientation
-				});
-		} else if(i_layout.placement == interactable_placement::external) {
-			layout_rect offset{ em{ 0 }, em{ 0 }, em{ 100 }, em{ 100 } };
-			auto base = workspace_placement(*n);
-			if(i_layout.orientation == interactable_orientation::left) {
-				offset.y = n->position.height / 2 - em{ 50 };
-				if(base.x >= em{ 100 })
-					offset.x = em{ -100 };
-				else
-					offset.x = n->position.width;
-			} else if(i_layout.orientation == interactable_orientation::right) {
-				offset.y = n->position.height / 2 - em{ 50 };
-				if(base.x + n->position.width + em{ 100 } > ws_size.x)
-					offset.x = n->position.width;
-				else
-					offset.x = em{ -100 };
-			} else if(i_layout.orientation == interactable_orientation::above) {
-				offset.x = n->position.width / 2 - em{ 50 };
-				if(base.y >= em{ 100 })
-					offset.y = em{ -100 };
-				else
-					offset.y = n->position.height;
+		if(p.kind == interactable_placement::suppressed)
+			return;
+		current_interactables.push_back(placed_interactable{
+			n,
+			p.placement,
+			display_as_group ? interactable_state(interactable_state::group, uint8_t(group + 1)) : interactable_state(interactable_state::key, uint8_t(group + 1)),
+			p.orientation
+		});
+	};
+
+	// Only the prompts that appear, disappear or change are damaged; those that a focus change leaves
+	// where they were, with the same label, are left alone.
+	frame_memory_scope memory(*this);
+	std::pmr::vector<placed_interactable> previous(current_interactables.begin(), current_interactables.end(), &frame_memory);
+	auto damage_changes = [&]() {
+		if(pmode == prompt_mode::hidden)
+			return;
+		std::pmr::vector<placed_interactable> next(current_interactables.begin(), current_interactables.end(), &frame_memory);
+		auto by_element = [](placed_interactable const& a, placed_interactable const& b) {
+			return std::less<ui_node*>{ }(a.element, b.element);
+		};
+		std::sort(previous.begin(), previous.end(), by_element);
+		std::sort(next.begin(), next.end(), by_element);
+		size_t a = 0;
+		size_t b = 0;
+		while(a < previous.size() || b < next.size()) {
+			if(b == next.size() || (a < previous.size() && by_element(previous[a], next[b]))) {
+				damage_interactable(previous[a++]);
+			} else if(a == previous.size() || by_element(next[b], previous[a])) {
+				damage_interactable(next[b++]);
 			} else {
-				offset.x = n->position.width / 2 - em{ 50 };
-				if(base.y + n->position.height + em{ 100 } > ws_size.y)
-					offset.y = n->position.height;
-				else
-					offset.y = em{ -100 };
+				auto& o = previous[a++];
+				auto& c = next[b++];
+				if(o.placement.x != c.placement.x || o.placement.y != c.placement.y || o.state != c.state || o.orientation != c.orientation) {
+					damage_interactable(o);
+					damage_interactable(c);
+				}
 			}
-			if(display_as_group)
-				current_interactables.push_back(placed_interactable{
-					n,
-					offset + base,
-					interactable_state(interactable_state::group, uint8_t(group + 1)),
-					i_layout.orientation
-				});
-			else
-				current_interactables.push_back(placed_interactable{
-					n,
-					offset + base,
-					interactable_state(interactable_state::key, uint8_t(group + 1)),
-					i_layout.orientation
-				});
 		}
 	};
 
@@ -1591,8 +2406,10 @@ void root::repopulate_key_actions() {
 		n.element->behavior_flags &= ~behavior::interaction_flagged;
 	current_interactables.clear();
 
-	if(node_repository.empty())
+	if(node_repository.empty()) {
+		damage_changes();
 		return;
+	}
 
 	int32_t start_offset = 0;
 	ui_node* n = node_repository[0].get();
@@ -1620,21 +2437,18 @@ void root::repopulate_key_actions() {
 	focus_actions.valid_key_action_count = 0;
 	
 
-	auto interactables_range = interactables(*n);
-	auto i = interactables_range.begin();
-	
-
-	while(start_offset > 0) {
-		++i;
-		--start_offset;
-	}
+	auto items = get_interactables(*n);
+	auto item_at = [&](int32_t index) {
+		return (0 <= index && size_t(index) < items.size()) ? items[index] : nullptr;
+	};
+	int32_t i = std::max(start_offset, 0);
 
 	for(int32_t group = 0; group < current_groupings_size; ++group) {
 		auto count_in_group = current_focus_groupings[group].end - current_focus_groupings[group].start;
 		bool display_as_group = count_in_group > 1;
 
 		if(count_in_group == 1) {
-			auto primary_node = (*i);
+			auto primary_node = item_at(i);
 			if(primary_node && (primary_node->behavior_flags & (behavior::interaction_info | behavior::interaction_command | behavior::interaction_focus)) != 0) {
 				focus_actions.button_actions[group] = interaction{ primary_node };
 				++focus_actions.valid_key_action_count;
@@ -1649,13 +2463,15 @@ void root::repopulate_key_actions() {
 
 		while(count_in_group > 0) {
 			// position interactable for nth group member
-			if(auto n = *i; n)
+			if(auto n = item_at(i); n)
 				add_interactable(n, group, display_as_group);
 
 			++i;
 			--count_in_group;
 		}
 	}
+
+	damage_changes();
 }
 
 void root::set_window_focus(focus_tracker r) {
@@ -1746,21 +2562,47 @@ ui_node* root::take_key_action(key_action a) {
 	return nullptr;
 }
 
+// updates n and its subtree depth first, for updates of a single subtree; root::on_update uses
+// update_scheduler, which runs the same steps but batches the types with behavior::update_batched
+void update_subtree(root& r, ui_node& n) {
+	auto mode = n.begin_update(r);
+	if(mode == update_mode::skip)
+		return;
+	if(mode == update_mode::whole_subtree) {
+		n.on_update(r);
+		return;
+	}
+	if(mode == update_mode::with_function) {
+		auto fn = r.get_on_update(n.type_id);
+		fn(r, n);
+	}
+
+	// not the frame memory: page controls update their text from the layout workers
+	std::byte buffer[32 * sizeof(ui_node*)];
+	std::pmr::monotonic_buffer_resource memory(buffer, sizeof(buffer));
+	update_list next(&memory);
+	n.update_children(r, next);
+	for(auto c : next)
+		c->on_update(r);
+}
+
 //
 // container_node
 //
 
+void render_background(root& r, background_definition const& background, layout_position offset, ui_node const& node, rendering_modifiers rm = rendering_modifiers::none);
+
 size_t container_node::size() const {
 	return sizeof(container_node);
 }
-void container_node::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void container_node::render(root& r, layout_position offset, postponed_list& postponed) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
 	render_background(r, r.get_background_definition(type_id), offset, *this);
 
 	if((ui_node::behavior_flags & behavior::standard_background) != 0) {
-		r.system.rectangle(
+		r.display.rectangle(
 			screen_space_rect{ r.system.to_screen_space(offset.x), r.system.to_screen_space(offset.y), r.system.to_screen_space(position.width), r.system.to_screen_space(position.height) },
 			((ui_node::behavior_flags & behavior::visually_interactable) != 0 && r.under_mouse.type_array[size_t(mouse_interactivity::position)].node == this) ? rendering_modifiers::highlighted : rendering_modifiers::none,
 			r.get_background_brush(ui_node::type_id));
@@ -1769,7 +2611,7 @@ void container_node::render(root& r, layout_position offset, std::vector<postpon
 	auto ico_pos = r.get_icon_position(ui_node::type_id);
 
 	if(r.pmode == prompt_mode::hidden || (ui_node::behavior_flags & behavior::interaction_flagged) == 0) {
-		r.system.icon(r.get_icon(ui_node::type_id),
+		r.display.icon(r.get_icon(ui_node::type_id),
 		screen_space_rect{
 			r.system.to_screen_space(offset.x + ico_pos.x), r.system.to_screen_space(offset.y + ico_pos.y),
 			r.system.to_screen_space(em{ 100 }), r.system.to_screen_space(em{ 100 })
@@ -1782,7 +2624,7 @@ void container_node::render(root& r, layout_position offset, std::vector<postpon
 		if((c->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ c, child_position });
 		} else {
-			c->render(r, child_position, postponed);
+			r.render_node(*c, child_position, postponed);
 		}
 	}
 }
@@ -1792,13 +2634,13 @@ uint32_t container_node::child_count() const {
 ui_node* container_node::get_child(uint32_t index) const {
 	return children[index];
 }
-probe_result container_node::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result container_node::mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) {
 	probe_result result;
 
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return result;
 	
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -1813,7 +2655,7 @@ probe_result container_node::mouse_probe(root& r, layout_position probe_pos, lay
 		if((c->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ c, child_position });
 		} else {
-			auto c_result = c->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*c, probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -1845,17 +2687,18 @@ void container_node::on_hide(root& r) {
 		c->on_hide(r);
 }
 void container_node::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode container_node::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
-
+		return update_mode::skip;
+	return update_mode::with_function;
+}
+void container_node::update_children(root&, update_list& next) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
-	for(auto c : children)
-		c->on_update(r);
+	next.insert(next.end(), children.begin(), children.end());
 }
 void container_node::on_create(root& r) {
 	{
@@ -1874,27 +2717,27 @@ void container_node::on_create(root& r) {
 	}
 }
 
-void render_background(root& r, background_definition const& background, layout_position offset, ui_node const& node, rendering_modifiers rm = rendering_modifiers::none) {
+void render_background(root& r, background_definition const& background, layout_position offset, ui_node const& node, rendering_modifiers rm) {
 	if(rm == rendering_modifiers::none) {
 		if((node.behavior_flags & behavior::visually_interactable) != 0 && r.under_mouse.type_array[size_t(mouse_interactivity::position)].node == &node)
 			rm = rendering_modifiers::highlighted;
 	}
 	if(background.image.value != -1) {
-		r.system.background(background.image, r.get_background_brush(node.type_id),
+		r.display.background(background.image, r.get_background_brush(node.type_id),
 			screen_space_rect{ r.system.to_screen_space(offset.x + background.exterior_edge_offsets.x), r.system.to_screen_space(offset.y + background.exterior_edge_offsets.y), r.system.to_screen_space(node.position.width + background.exterior_edge_offsets.width), r.system.to_screen_space(node.position.height + background.exterior_edge_offsets.height) },
 			background.texture_interior_region, rm);
 	} else if(background.brush != std::numeric_limits<uint16_t>::max()) {
-		r.system.rectangle(
+		r.display.rectangle(
 			screen_space_rect{ r.system.to_screen_space(offset.x + background.exterior_edge_offsets.x), r.system.to_screen_space(offset.y + background.exterior_edge_offsets.y), r.system.to_screen_space(node.position.width + background.exterior_edge_offsets.width), r.system.to_screen_space(node.position.height + background.exterior_edge_offsets.height) },
 			 rm, background.brush);
 	} else {
-		r.system.empty_rectangle(
+		r.display.empty_rectangle(
 			screen_space_rect{ r.system.to_screen_space(offset.x), r.system.to_screen_space(offset.y), r.system.to_screen_space(node.position.width), r.system.to_screen_space(node.position.height) },
 			rm, r.get_background_brush(node.type_id));
 	}
 
 	if(background.left_border != 0) {
-		r.system.rectangle(
+		r.display.rectangle(
 			screen_space_rect{ 
 				r.system.to_screen_space(offset.x),
 				r.system.to_screen_space(offset.y), 
@@ -1903,7 +2746,7 @@ void render_background(root& r, background_definition const& background, layout_
 			rm, r.get_foreground_brush(node.type_id));
 	}
 	if(background.right_border != 0) {
-		r.system.rectangle(
+		r.display.rectangle(
 			screen_space_rect{
 				r.system.to_screen_space(offset.x + node.position.width - em{ background.right_border }),
 				r.system.to_screen_space(offset.y),
@@ -1912,7 +2755,7 @@ void render_background(root& r, background_definition const& background, layout_
 				rm, r.get_foreground_brush(node.type_id));
 	}
 	if(background.top_border != 0) {
-		r.system.rectangle(
+		r.display.rectangle(
 			screen_space_rect{
 				r.system.to_screen_space(offset.x),
 				r.system.to_screen_space(offset.y),
@@ -1921,7 +2764,7 @@ void render_background(root& r, background_definition const& background, layout_
 				rm, r.get_foreground_brush(node.type_id));
 	}
 	if(background.bottom_border != 0) {
-		r.system.rectangle(
+		r.display.rectangle(
 			screen_space_rect{
 				r.system.to_screen_space(offset.x),
 				r.system.to_screen_space(offset.y + node.position.height - em{ background.bottom_border }),
@@ -1938,7 +2781,7 @@ void render_background(root& r, background_definition const& background, layout_
 size_t proportional_window::size() const {
 	return sizeof(proportional_window);
 }
-void proportional_window::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void proportional_window::render(root& r, layout_position offset, postponed_list& postponed) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
@@ -1948,7 +2791,7 @@ void proportional_window::render(root& r, layout_position offset, std::vector<po
 		auto ico_pos = r.get_icon_position(ui_node::type_id);
 
 		if(r.pmode == prompt_mode::hidden || (ui_node::behavior_flags & behavior::interaction_flagged) == 0) {
-			r.system.icon(r.get_icon(ui_node::type_id),
+			r.display.icon(r.get_icon(ui_node::type_id),
 				screen_space_rect{
 					r.system.to_screen_space(offset.x + ico_pos.x), r.system.to_screen_space(offset.y + ico_pos.y),
 					r.system.to_screen_space(em{ 100 }), r.system.to_screen_space(em{ 100 })
@@ -1962,7 +2805,7 @@ void proportional_window::render(root& r, layout_position offset, std::vector<po
 		if((c->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ c, child_position });
 		} else {
-			c->render(r, child_position, postponed);
+			r.render_node(*c, child_position, postponed);
 		}
 	}
 }
@@ -1972,13 +2815,13 @@ uint32_t proportional_window::child_count() const {
 ui_node* proportional_window::get_child(uint32_t index) const {
 	return children[index];
 }
-probe_result proportional_window::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result proportional_window::mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) {
 	probe_result result;
 
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return result;
 	
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -1993,7 +2836,7 @@ probe_result proportional_window::mouse_probe(root& r, layout_position probe_pos
 		if((c->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ c, child_position });
 		} else {
-			auto c_result = c->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*c, probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -2027,17 +2870,18 @@ void proportional_window::on_hide(root& r) {
 		c->on_hide(r);
 }
 void proportional_window::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode proportional_window::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
-
+		return update_mode::skip;
+	return update_mode::with_function;
+}
+void proportional_window::update_children(root&, update_list& next) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
-	for(auto c : children)
-		c->on_update(r);
+	next.insert(next.end(), children.begin(), children.end());
 }
 void proportional_window::on_create(root& r) {
 	auto cformatting = r.get_window_children(type_id);
@@ -2063,7 +2907,7 @@ void proportional_window::on_create(root& r) {
 void proportional_window::force_resize(root& r, layout_position size) {
 	position.width = size.x;
 	position.height = size.y;
-	for(uint32_t i = 0; i < children.size(); ++i) {
+	r.parallel_layout(children.size(), [&](size_t i) {
 		auto& fmt = child_positions[i];
 		layout_rect sz;
 		switch(fmt.x_start_base) {
@@ -2080,13 +2924,13 @@ void proportional_window::force_resize(root& r, layout_position size) {
 				sz.x = position.width / 3 + fmt.x_start_offset;
 				break;
 			case relative_to::two_thirds:
-				sz.x = (position.width * 2) / 3 + fmt.x_start_offset;
+				sz.x = scale_em(position.width, 2, 3) + fmt.x_start_offset;
 				break;
 			case relative_to::one_fourth:
 				sz.x = position.width / 4 + fmt.x_start_offset;
 				break;
 			case relative_to::three_fourths:
-				sz.x = (position.width * 3) / 4 + fmt.x_start_offset;
+				sz.x = scale_em(position.width, 3, 4) + fmt.x_start_offset;
 				break;
 		}
 		switch(fmt.x_end_base) {
@@ -2103,13 +2947,13 @@ void proportional_window::force_resize(root& r, layout_position size) {
 				sz.width = (position.width / 3 + fmt.x_end_offset) - sz.x;
 				break;
 			case relative_to::two_thirds:
-				sz.width = ((position.width * 2) / 3 + fmt.x_end_offset) - sz.x;
+				sz.width = (scale_em(position.width, 2, 3) + fmt.x_end_offset) - sz.x;
 				break;
 			case relative_to::one_fourth:
 				sz.width = (position.width / 4 + fmt.x_end_offset) - sz.x;
 				break;
 			case relative_to::three_fourths:
-				sz.width = ((position.width * 3) / 4 + fmt.x_end_offset) - sz.x;
+				sz.width = (scale_em(position.width, 3, 4) + fmt.x_end_offset) - sz.x;
 				break;
 		}
 		sz.width = std::max(sz.width, em{ 0 });
@@ -2128,13 +2972,13 @@ void proportional_window::force_resize(root& r, layout_position size) {
 				sz.y = position.height / 3 + fmt.y_start_offset;
 				break;
 			case relative_to::two_thirds:
-				sz.y = (position.height * 2) / 3 + fmt.y_start_offset;
+				sz.y = scale_em(position.height, 2, 3) + fmt.y_start_offset;
 				break;
 			case relative_to::one_fourth:
 				sz.y = position.height / 4 + fmt.y_start_offset;
 				break;
 			case relative_to::three_fourths:
-				sz.y = (position.height * 3) / 4 + fmt.y_start_offset;
+				sz.y = scale_em(position.height, 3, 4) + fmt.y_start_offset;
 				break;
 		}
 		switch(fmt.y_end_base) {
@@ -2151,13 +2995,13 @@ void proportional_window::force_resize(root& r, layout_position size) {
 				sz.height = (position.height / 3 + fmt.y_end_offset) - sz.y;
 				break;
 			case relative_to::two_thirds:
-				sz.height = ((position.height * 2) / 3 + fmt.y_end_offset) - sz.y;
+				sz.height = (scale_em(position.height, 2, 3) + fmt.y_end_offset) - sz.y;
 				break;
 			case relative_to::one_fourth:
 				sz.height = (position.height / 4 + fmt.y_end_offset) - sz.y;
 				break;
 			case relative_to::three_fourths:
-				sz.height = ((position.height * 3) / 4 + fmt.y_end_offset) - sz.y;
+				sz.height = (scale_em(position.height, 3, 4) + fmt.y_end_offset) - sz.y;
 				break;
 		}
 		sz.height = std::max(sz.height, em{ 0 });
@@ -2165,7 +3009,7 @@ void proportional_window::force_resize(root& r, layout_position size) {
 		children[i]->position.x = sz.x;
 		children[i]->position.y = sz.y;
 		children[i]->force_resize(r, layout_position{ sz.width, sz.height});
-	}
+	});
 }
 void proportional_window::resize(root& r, layout_position maximum_space, em desired_width, em desired_height) {
 	auto target_width = std::min(std::max(desired_width, minimum_width(r)), maximum_space.x);
@@ -2210,7 +3054,7 @@ em proportional_window::minimum_height(root& r) {
 size_t space_filler::size() const {
 	return sizeof(space_filler);
 }
-void space_filler::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void space_filler::render(root& r, layout_position offset, postponed_list& postponed) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
@@ -2221,7 +3065,7 @@ void space_filler::render(root& r, layout_position offset, std::vector<postponed
 		if((c->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ c, child_position });
 		} else {
-			c->render(r, child_position, postponed);
+			r.render_node(*c, child_position, postponed);
 		}
 	}
 }
@@ -2231,13 +3075,13 @@ uint32_t space_filler::child_count() const {
 ui_node* space_filler::get_child(uint32_t index) const {
 	return children[index];
 }
-probe_result space_filler::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result space_filler::mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) {
 	probe_result result;
 
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return result;
 	
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -2252,7 +3096,7 @@ probe_result space_filler::mouse_probe(root& r, layout_position probe_pos, layou
 		if((c->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ c, child_position });
 		} else {
-			auto c_result = c->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*c, probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -2286,17 +3130,18 @@ void space_filler::on_lose_focus(root& r) {
 	fn(r, *this);
 }
 void space_filler::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode space_filler::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
-
+		return update_mode::skip;
+	return update_mode::with_function;
+}
+void space_filler::update_children(root&, update_list& next) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
-	for(auto c : children)
-		c->on_update(r);
+	next.insert(next.end(), children.begin(), children.end());
 }
 void space_filler::on_create(root& r) {
 	{
@@ -2318,17 +3163,38 @@ void space_filler::on_create(root& r) {
 		fn(r, *this);
 	}
 }
+content_position space_filler::child_content_offset(ui_node const& child) const {
+	for(uint32_t i = 0; i < children.size() && i < child_offsets.size(); ++i) {
+		if(children[i] == &child)
+			return child_offsets[i];
+	}
+	return ui_node::child_content_offset(child);
+}
 void space_filler::force_resize(root& r, layout_position size) {
 	position.width = size.x;
 	position.height = size.y;
 	bool horizontal = r.get_horizontal_orientation(ui_node::type_id);
 	auto separator = r.get_divider_index(ui_node::type_id);
-	auto leading = em{ 0 };
-	auto trailing = horizontal ? size.x : size.y;
+	// the children may need more than the space there is, so they are stacked in content space
+	// and their positions are clamped to what em can hold
+	auto leading = content_em{ 0 };
+	auto trailing = to_content(horizontal ? size.x : size.y);
+	auto place = [&](uint32_t i, content_em at) {
+		if(horizontal) {
+			child_offsets[i] = content_position{ at, content_em{ 0 } };
+			children[i]->position.x = to_em(at);
+		} else {
+			child_offsets[i] = content_position{ content_em{ 0 }, at };
+			children[i]->position.y = to_em(at);
+		}
+	};
 
+	child_offsets.resize(children.size());
 	for(uint32_t i = 0; i < children.size(); ++i) {
-		if((children[i]->behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
+		if((children[i]->behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0) {
+			child_offsets[i] = to_content(layout_position{ children[i]->position.x, children[i]->position.y });
 			continue;
+		}
 
 		if(horizontal) {
 			children[i]->position.y = em{ 0 };
@@ -2338,34 +3204,32 @@ void space_filler::force_resize(root& r, layout_position size) {
 
 		if(i < uint32_t(separator)) {
 			auto space_used = horizontal ? children[i]->minimum_width(r) : children[i]->minimum_height(r);
+			place(i, leading);
 			if(horizontal) {
-				children[i]->position.x = leading;
 				children[i]->force_resize(r, layout_position{ space_used, size.y });
 			} else {
-				children[i]->position.y = leading;
 				children[i]->force_resize(r, layout_position{ size.x, space_used });
 			}
 			leading = leading + space_used;
 		} else if(i > uint32_t(separator)) {
 			auto space_used = horizontal ? children[i]->minimum_width(r) : children[i]->minimum_height(r);
 			trailing = trailing - space_used;
+			place(i, trailing);
 			if(horizontal) {
-				children[i]->position.x = trailing;
 				children[i]->force_resize(r, layout_position{ space_used, size.y });
 			} else {
-				children[i]->position.y = trailing;
 				children[i]->force_resize(r, layout_position{ size.x, space_used });
 			}
 		}
 	}
 
 	// position separator
+	place(uint32_t(separator), leading);
+	auto separator_space = to_em(std::max(content_em{ 0 }, trailing - leading));
 	if(horizontal) {
-		children[separator]->position.x = leading;
-		children[separator]->force_resize(r, layout_position{ std::max(em{ 0 }, trailing - leading), size.y });
+		children[separator]->force_resize(r, layout_position{ separator_space, size.y });
 	} else {
-		children[separator]->position.y = leading;
-		children[separator]->force_resize(r, layout_position{ size.x, std::max(em{ 0 }, trailing - leading) });
+		children[separator]->force_resize(r, layout_position{ size.x, separator_space });
 	}
 }
 void space_filler::resize(root& r, layout_position maximum_space, em desired_width, em desired_height) {
@@ -2409,17 +3273,17 @@ em space_filler::minimum_height(root& r) {
 size_t page_control_icon_button::size() const {
 	return sizeof(page_control_icon_button);
 }
-void page_control_icon_button::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
-	r.system.icon(
+void page_control_icon_button::render(root& r, layout_position offset, postponed_list&) {
+	r.display.icon(
 		r.get_icon(ui_node::type_id),
 		r.system.to_screen_space(layout_rect{ em{ 0 }, em{ 0 }, em{ 100 }, em{ 100 } } + offset),
 		r.get_foreground_brush(ui_node::type_id),
 		enabled ? rendering_modifiers::none : rendering_modifiers::disabled);
 }
-probe_result page_control_icon_button::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result page_control_icon_button::mouse_probe(root&, layout_position probe_pos, layout_position offset, postponed_list&) {
 	probe_result result;
 
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -2435,16 +3299,25 @@ probe_result page_control_icon_button::mouse_probe(root& r, layout_position prob
 	return result;
 }
 void page_control_icon_button::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode page_control_icon_button::begin_update(root&) {
+	return update_mode::no_function;
+}
+void page_control_icon_button::update_children(root& r, update_list&) {
 	auto data = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(this) + sizeof(page_control_icon_button));
 	auto type = (*data & page_control_icon_button::type_mask);
 	auto parent_pages = parent->parent->get_page_information();
+	auto was_enabled = enabled;
 	if(type == left2_type || type == left_type) {
 		enabled = (parent_pages.current_page > 0);
 	} else {
 		enabled = (parent_pages.current_page + 1 < parent_pages.total_pages);
 	}
+	if(was_enabled != enabled)
+		r.invalidate_render(this);
 }
-void page_control_icon_button::on_lbutton(root& r, layout_position pos) {
+void page_control_icon_button::on_lbutton(root& r, layout_position) {
 	if(enabled) {
 		auto data = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(this) + sizeof(page_control_icon_button));
 		auto type = (*data & page_control_icon_button::type_mask);
@@ -2454,20 +3327,16 @@ void page_control_icon_button::on_lbutton(root& r, layout_position pos) {
 		
 		switch(type) {
 			case left2_type:
-				auto new_page = range.current_page - int32_t(std::ceil(std::sqrt(float(range.total_pages))));
-				parent->parent->change_page(r, new_page);
+				parent->parent->change_page(r, range.current_page - int32_t(std::ceil(std::sqrt(float(range.total_pages)))));
 				break;
 			case left_type:
-				auto new_page = range.current_page - int32_t(1);
-				parent->parent->change_page(r, new_page);
+				parent->parent->change_page(r, range.current_page - int32_t(1));
 				break;
 			case right2_type:
-				auto new_page = range.current_page + int32_t(std::ceil(std::sqrt(float(range.total_pages))));
-				parent->parent->change_page(r, new_page);
+				parent->parent->change_page(r, range.current_page + int32_t(std::ceil(std::sqrt(float(range.total_pages)))));
 				break;
 			case right_type:
-				auto new_page = range.current_page + int32_t(1);
-				parent->parent->change_page(r, new_page);
+				parent->parent->change_page(r, range.current_page + int32_t(1));
 				break;
 			default:
 				break;
@@ -2476,7 +3345,7 @@ void page_control_icon_button::on_lbutton(root& r, layout_position pos) {
 
 }
 
-interactable_result page_control_icon_button::interactable_layout(root& r) {
+interactable_result page_control_icon_button::interactable_layout(root&) {
 	auto data = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(this) + sizeof(page_control_icon_button));
 	auto position = (*data & page_control_icon_button::position_mask);
 	switch(position) {
@@ -2496,23 +3365,23 @@ interactable_result page_control_icon_button::interactable_layout(root& r) {
 size_t page_control_text::size() const {
 	return sizeof(page_control_text);
 }
-void page_control_text::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void page_control_text::render(root& r, layout_position offset, postponed_list&) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
-	text_data->render(r.system, layout_rect{ offset.x, offset.y, position.width, position.height }, r.get_foreground_brush(ui_node::type_id));
+	r.display.text(*text_data, layout_rect{ offset.x, offset.y, position.width, position.height }, r.get_foreground_brush(ui_node::type_id));
 
-	auto data = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(this) + sizeof(page_control_icon_button));
+	auto data = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(this) + sizeof(page_control_text));
 
 	if(*data == page_control_text::vertical) {
 		auto full_width = r.system.to_screen_space(position.width);
 		auto full_height = r.system.to_screen_space(position.height);
 		auto screen_offset = r.system.to_screen_space(offset);
 
-		r.system.rectangle(screen_space_rect{ int32_t(full_width * 0.2f) + screen_offset.x, full_height / 2 - 1 + screen_offset.y, int32_t(full_width * 0.8f), 2 }, rendering_modifiers::none, r.get_foreground_brush(ui_node::type_id));
+		r.display.rectangle(screen_space_rect{ int32_t(full_width * 0.2f) + screen_offset.x, full_height / 2 - 1 + screen_offset.y, int32_t(full_width * 0.8f), 2 }, rendering_modifiers::none, r.get_foreground_brush(ui_node::type_id));
 	}
 }
-probe_result page_control_text::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result page_control_text::mouse_probe(root&, layout_position, layout_position, postponed_list&) {
 	return probe_result{ };
 }
 void page_control_text::on_create(root& r) {
@@ -2524,8 +3393,18 @@ void page_control_text::on_reload(root& r) {
 	on_update(r);
 }
 void page_control_text::on_update(root& r) {
-	auto data = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(this) + sizeof(page_control_icon_button));
+	update_subtree(r, *this);
+}
+update_mode page_control_text::begin_update(root&) {
+	return update_mode::no_function;
+}
+void page_control_text::update_children(root& r, update_list&) {
+	auto data = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(this) + sizeof(page_control_text));
 	auto range = parent->parent->get_page_information();
+	if(range.current_page != shown.current_page || range.total_pages != shown.total_pages) {
+		shown = range;
+		r.invalidate_render(this);
+	}
 
 	auto current_page = r.system.int_to_text(range.current_page + 1, false);
 	auto max_page = r.system.int_to_text(range.total_pages, false);
@@ -2541,7 +3420,7 @@ void page_control_text::on_update(root& r) {
 		text_data->set_text(r.system, std::move(result));
 	}
 }
-void page_control_text::force_resize(root& r, layout_position size) {
+void page_control_text::force_resize(root&, layout_position size) {
 	position.width = size.x;
 	position.height = size.y;
 }
@@ -2553,36 +3432,36 @@ void page_control_text::force_resize(root& r, layout_position size) {
 size_t page_controls::size() const {
 	return sizeof(page_controls);
 }
-void page_controls::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void page_controls::render(root& r, layout_position offset, postponed_list& postponed) {
 	std::array<ui_node*, 5> children = { left2_button, left_button, text, right_button, right2_button };
 
 	if(r.contains_focus(this)) {
 		for(auto c : children) {
 			auto child_position = get_sub_position(*this, *c) + offset;
-			c->render(r, child_position, postponed);
+			r.render_node(*c, child_position, postponed);
 		}
 	} else {
-		text->render(r, get_sub_position(*this, *text) + offset, postponed);
+		r.render_node(*text, get_sub_position(*this, *text) + offset, postponed);
 
 		if(r.pmode == prompt_mode::hidden || (ui_node::behavior_flags & behavior::interaction_flagged) == 0) {
 			auto pos = (vertical_arrangement && position.height > em{ 190 }) ?
 				layout_rect{ position.width / 2 - em{ 50 }, em{ 0 }, em{ 100 }, em{ 100 } } :
 				layout_rect{ em{ 0 }, position.height / 2 - em{ 50 }, em{ 100 }, em{ 100 } };
 
-			r.system.icon(
+			r.display.icon(
 				page_icon,
 				r.system.to_screen_space(pos + offset),
 				r.get_foreground_brush(parent->type_id));
 		}
 	}
 }
-probe_result page_controls::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result page_controls::mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) {
 	probe_result result;
 
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return result;
 
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 		result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
 		
@@ -2595,7 +3474,7 @@ probe_result page_controls::mouse_probe(root& r, layout_position probe_pos, layo
 		for(auto c : children) {
 			auto child_position = get_sub_position(*this, *c) + offset;
 
-			auto c_result = c->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*c, probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -2607,15 +3486,24 @@ probe_result page_controls::mouse_probe(root& r, layout_position probe_pos, layo
 	return result;
 }
 void page_controls::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode page_controls::begin_update(root&) {
+	return update_mode::no_function;
+}
+void page_controls::update_children(root& r, update_list& next) {
 	auto container_pages = parent->get_page_information();
-	if(container_pages.total_pages <= 1) {
+	auto old_flags = ui_node::behavior_flags;
+	if(container_pages.total_pages <= 1)
 		ui_node::behavior_flags |= behavior::visually_hidden;
-	} else {
+	else
 		ui_node::behavior_flags &= ~behavior::visually_hidden;
-
-		std::array<ui_node*, 5> children = { left2_button, left_button, text, right_button, right2_button };
-		for(auto c : children)
-			c->on_update(r);
+	if(old_flags != ui_node::behavior_flags) {
+		r.invalidate_layout(this);
+		r.node_state_changed(*this, old_flags);
+	}
+	if(container_pages.total_pages > 1) {
+		next.insert(next.end(), { left2_button, left_button, text, right_button, right2_button });
 	}
 }
 interactable_result page_controls::interactable_layout(root& r) {
@@ -2998,7 +3886,7 @@ em page_controls::minimum_height(root& r) {
 size_t dynamic_column::size() const {
 	return sizeof(dynamic_column);
 }
-void dynamic_column::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void dynamic_column::render(root& r, layout_position offset, postponed_list& postponed) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
@@ -3033,13 +3921,13 @@ void dynamic_column::render(root& r, layout_position offset, std::vector<postpon
 		}
 
 		if(col_settings.enhance_line_visibility)
-			r.system.set_line_highlight_mode(mode);
+			r.display.set_line_highlight_mode(mode);
 
 		auto child_position = get_sub_position(*this, *children[i]) + offset;
 		if((children[i]->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ children[i], child_position });
 		} else {
-			children[i]->render(r, child_position, postponed);
+			r.render_node(*children[i], child_position, postponed);
 		}
 		if(!in_group && (children[i]->behavior_flags & behavior::layout_as_separator) == 0) {
 			mode = !mode;
@@ -3047,14 +3935,14 @@ void dynamic_column::render(root& r, layout_position offset, std::vector<postpon
 	}
 
 	if(col_settings.enhance_line_visibility)
-		r.system.set_line_highlight_mode(false);
+		r.display.set_line_highlight_mode(false);
 
 	{
 		auto child_position = get_sub_position(*this, *page_controls) + offset;
 		if((page_controls->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ page_controls, child_position });
 		} else {
-			page_controls->render(r, child_position, postponed);
+			r.render_node(*page_controls, child_position, postponed);
 		}
 	}
 }
@@ -3071,13 +3959,13 @@ ui_node* dynamic_column::get_child(uint32_t index) const {
 	else
 		return page_controls;
 }
-probe_result dynamic_column::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result dynamic_column::mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) {
 	probe_result result;
 
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return result;
 	
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -3098,7 +3986,7 @@ probe_result dynamic_column::mouse_probe(root& r, layout_position probe_pos, lay
 		if((children[i]->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ children[i], child_position });
 		} else {
-			auto c_result = children[i]->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*children[i], probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -3111,7 +3999,7 @@ probe_result dynamic_column::mouse_probe(root& r, layout_position probe_pos, lay
 		if((page_controls->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ page_controls, child_position });
 		} else {
-			auto c_result = page_controls->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*page_controls, probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -3153,12 +4041,14 @@ void dynamic_column::on_lose_focus(root& r) {
 	fn(r, *this);
 }
 void dynamic_column::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode dynamic_column::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
-	
+		return update_mode::skip;
+	return update_mode::with_function;
+}
+void dynamic_column::update_children(root& r, update_list& next) {
 	if(pending_relayout)
 		repaginate(r);
 
@@ -3168,11 +4058,8 @@ void dynamic_column::on_update(root& r) {
 	uint32_t page_start = (current_page == 0 ? 0 : page_starts[current_page - 1]);
 	uint32_t page_end = (current_page >= int32_t(num_pages) - 1 ? uint32_t(children.size()) : page_starts[current_page]);
 
-	for(uint32_t i = page_start; i < page_end; ++i) {
-		children[i]->on_update(r);
-	}
-
-	page_controls->on_update(r);
+	next.insert(next.end(), children.begin() + page_start, children.begin() + page_end);
+	next.push_back(page_controls);
 }
 void dynamic_column::on_create(root& r) {
 	page_controls = make_page_controls(r, this);
@@ -3204,12 +4091,21 @@ void dynamic_column::force_resize(root& r, layout_position size) {
 	em cur_height{ 0 };
 	em cur_x_off{ 0 };
 	em max_width = col_settings.minimum_width;
-	int32_t cur_page = 0;
 	int32_t group_start = -1;
 
 	page_controls->resize(r, size, em{ 0 }, em{ 0 });
 	auto available_size = size.y - page_controls->position.height;
 
+	// with a fixed column width every child can be measured against a full column up front; the
+	// positioning pass below only measures a child again when it no longer fits in the space left
+	bool premeasured = width_per_column > em{ 0 } && col_settings.number_of_columns > 1 && r.parallel_layout_enabled();
+	if(premeasured) {
+		r.parallel_layout(children.size(), [&](size_t j) {
+			if((children[j]->behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) == 0)
+				children[j]->resize(r, minui::layout_position{ width_per_column, available_size }, width_per_column, em{ 0 });
+		});
+	}
+
 	int32_t i = 0;
 	for(; i < int32_t(children.size()); ++i) {
 		if((children[i]->behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
@@ -3224,7 +4120,8 @@ void dynamic_column::force_resize(root& r, layout_position size) {
 
 		bool child_fits_in_column = true;
 		if(width_per_column > em{ 0 }) {
-			children[i]->resize(r, minui::layout_position{ width_per_column, available_size - cur_height }, width_per_column, em{ 0 });
+			if(!premeasured || children[i]->position.width != width_per_column || children[i]->position.height > available_size - cur_height)
+				children[i]->resize(r, minui::layout_position{ width_per_column, available_size - cur_height }, width_per_column, em{ 0 });
 			if(children[i]->position.height > available_size - cur_height)
 				child_fits_in_column = false;
 		} else {
@@ -3238,7 +4135,7 @@ void dynamic_column::force_resize(root& r, layout_position size) {
 			++cur_col;
 			if(col_settings.number_of_columns == 0) {
 				// finish last col width
-				for(uint32_t j = col_start; j < i; ++j) {
+				for(int32_t j = col_start; j < i; ++j) {
 					children[j]->force_resize(r, layout_position{ max_width, children[j]->position.height });
 				}
 				cur_x_off = cur_x_off + max_width;
@@ -3251,11 +4148,11 @@ void dynamic_column::force_resize(root& r, layout_position size) {
 
 			// position column
 			if(col_settings.layout == column_layout::centered) {
-				for(uint32_t j = col_start; j < i; ++j) {
+				for(int32_t j = col_start; j < i; ++j) {
 					children[j]->position.x = children[j]->position.x + (available_size - cur_height) / 2;
 				}
 			} else if(col_settings.layout == column_layout::bottom) {
-				for(uint32_t j = col_start; j < i; ++j) {
+				for(int32_t j = col_start; j < i; ++j) {
 					children[j]->position.x = children[j]->position.x + (available_size - cur_height);
 				}
 			}
@@ -3299,17 +4196,17 @@ void dynamic_column::force_resize(root& r, layout_position size) {
 
 	if(col_settings.number_of_columns == 0) {
 		// finish last col width
-		for(uint32_t j = col_start; j < i; ++j) {
+		for(int32_t j = col_start; j < i; ++j) {
 			children[j]->force_resize(r, layout_position{ max_width, children[j]->position.height });
 		}
 	}
 	//  position last column
 	if(col_settings.layout == column_layout::centered) {
-		for(uint32_t j = col_start; j < i; ++j) {
+		for(int32_t j = col_start; j < i; ++j) {
 			children[j]->position.x = children[j]->position.x + (available_size - cur_height) / 2;
 		}
 	} else if(col_settings.layout == column_layout::bottom) {
-		for(uint32_t j = col_start; j < i; ++j) {
+		for(int32_t j = col_start; j < i; ++j) {
 			children[j]->position.x = children[j]->position.x + (available_size - cur_height);
 		}
 	}
@@ -3322,7 +4219,7 @@ void dynamic_column::force_resize(root& r, layout_position size) {
 	} else {
 		page_controls->behavior_flags |= behavior::functionally_hidden;
 	}
-	page_controls->on_update(r);
+	r.run_after_parallel_layout([this, &r]() { page_controls->on_update(r); });
 
 	pending_relayout = false;
 }
@@ -3380,6 +4277,7 @@ void dynamic_column::change_page(root& r, int32_t new_page) {
 	}
 
 	current_page = uint16_t(new_page);
+	r.invalidate_layout(this);
 
 	{
 		uint32_t page_start = (current_page == 0 ? 0 : page_starts[current_page - 1]);
@@ -3393,10 +4291,10 @@ void dynamic_column::change_page(root& r, int32_t new_page) {
 
 	page_controls->on_update(r);
 }
-void dynamic_column::on_scroll(root& r, layout_position pos, int32_t amount) {
+void dynamic_column::on_scroll(root& r, layout_position, int32_t amount) {
 	change_page(r, std::clamp(current_page + amount, 0, int32_t(num_pages) - 1));
 }
-void dynamic_column::add_managed_element(root& r, ui_node* n) {
+void dynamic_column::add_managed_element(root&, ui_node* n) {
 	children.push_back(n);
 	pending_relayout = true;
 }
@@ -3409,6 +4307,7 @@ void dynamic_column::reset_managed_elements(root& r) {
 }
 void dynamic_column::repaginate(root& r) {
 	force_resize(r, layout_position{ position.width, position.height });
+	r.invalidate_layout(this);
 }
 
 //
@@ -3418,7 +4317,7 @@ void dynamic_column::repaginate(root& r) {
 size_t monotype_column::size() const {
 	return sizeof(monotype_column);
 }
-void monotype_column::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void monotype_column::render(root& r, layout_position offset, postponed_list& postponed) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
@@ -3427,10 +4326,9 @@ void monotype_column::render(root& r, layout_position offset, std::vector<postpo
 	em last_height{ -1 };
 	bool mode = false;
 	bool in_group = false;
-	auto col_settings = r.get_column_properties(ui_node::type_id);
 
 	uint32_t page_start = page_size * current_page;
-	uint32_t in_page = std::min(uint32_t(data->size() - page_start), uint32_t(page_size));
+	uint32_t in_page = std::min(uint32_t(items().size() - page_start), uint32_t(page_size));
 
 	for(uint32_t i = 0; i < in_page; ++i) {
 		if(children[i]->position.y <= last_height) {
@@ -3448,48 +4346,48 @@ void monotype_column::render(root& r, layout_position offset, std::vector<postpo
 			in_group = false;
 		}
 
-		r.system.set_line_highlight_mode(mode);
+		r.display.set_line_highlight_mode(mode);
 
 		auto child_position = get_sub_position(*this, *children[i]) + offset;
 		if((children[i]->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ children[i], child_position });
 		} else {
-			children[i]->render(r, child_position, postponed);
+			r.render_node(*children[i], child_position, postponed);
 		}
 		if(!in_group && (children[i]->behavior_flags & behavior::layout_as_separator) == 0) {
 			mode = !mode;
 		}
 	}
-	r.system.set_line_highlight_mode(false);
+	r.display.set_line_highlight_mode(false);
 	{
 		auto child_position = get_sub_position(*this, *page_controls) + offset;
 		if((page_controls->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ page_controls, child_position });
 		} else {
-			page_controls->render(r, child_position, postponed);
+			r.render_node(*page_controls, child_position, postponed);
 		}
 	}
 }
 uint32_t monotype_column::child_count() const {
 	uint32_t page_start = page_size * current_page;
-	uint32_t in_page = std::min(uint32_t(data->size() - page_start), uint32_t(page_size));
+	uint32_t in_page = std::min(uint32_t(items().size() - page_start), uint32_t(page_size));
 	return in_page + ((page_controls->behavior_flags & behavior::visually_hidden) != 0 ? 0 : 1);
 }
 ui_node* monotype_column::get_child(uint32_t index) const {
 	uint32_t page_start = page_size * current_page;
-	uint32_t in_page = std::min(uint32_t(data->size() - page_start), uint32_t(page_size));
+	uint32_t in_page = std::min(uint32_t(items().size() - page_start), uint32_t(page_size));
 	if(index < in_page)
 		return children[index];
 	else
 		return page_controls;
 }
-probe_result monotype_column::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result monotype_column::mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) {
 	probe_result result;
 
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return result;
 
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -3503,14 +4401,14 @@ probe_result monotype_column::mouse_probe(root& r, layout_position probe_pos, la
 	}
 
 	uint32_t page_start = page_size * current_page;
-	uint32_t in_page = std::min(uint32_t(data->size() - page_start), uint32_t(page_size));
+	uint32_t in_page = std::min(uint32_t(items().size() - page_start), uint32_t(page_size));
 
 	for(uint32_t i = 0; i < in_page; ++i) {
 		auto child_position = get_sub_position(*this, *children[i]) + offset;
 		if((children[i]->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ children[i], child_position });
 		} else {
-			auto c_result = children[i]->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*children[i], probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -3523,7 +4421,7 @@ probe_result monotype_column::mouse_probe(root& r, layout_position probe_pos, la
 		if((page_controls->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ page_controls, child_position });
 		} else {
-			auto c_result = page_controls->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*page_controls, probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -3539,7 +4437,7 @@ void monotype_column::on_visible(root& r) {
 	fn(r, *this);
 
 	uint32_t page_start = page_size * current_page;
-	uint32_t in_page = std::min(uint32_t(data->size() - page_start), uint32_t(page_size));
+	uint32_t in_page = std::min(uint32_t(items().size() - page_start), uint32_t(page_size));
 
 	for(uint32_t i = 0; i < in_page && i < children.size(); ++i) {
 		children[i]->on_visible(r);
@@ -3550,7 +4448,7 @@ void monotype_column::on_hide(root& r) {
 	fn(r, *this);
 
 	uint32_t page_start = page_size * current_page;
-	uint32_t in_page = std::min(uint32_t(data->size() - page_start), uint32_t(page_size));
+	uint32_t in_page = std::min(uint32_t(items().size() - page_start), uint32_t(page_size));
 
 	for(uint32_t i = 0; i < in_page && i < children.size(); ++i) {
 		children[i]->on_hide(r);
@@ -3565,39 +4463,27 @@ void monotype_column::on_lose_focus(root& r) {
 	fn(r, *this);
 }
 void monotype_column::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode monotype_column::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
-
+		return update_mode::skip;
+	return update_mode::with_function;
+}
+void monotype_column::update_children(root& r, update_list& next) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
+	if(items().version() != bound_version)
+		pending_data_update = true;
+
 	if(pending_data_update) {
-		auto size = data->size();
+		auto size = items().size();
 		num_pages = (size + page_size - 1) / page_size;
 		current_page = std::min(current_page, uint16_t(std::max(uint16_t(1), num_pages) - 1));
 
-		uint32_t page_start = page_size * current_page;
-		uint32_t in_page = std::min(uint32_t(data->size() - page_start), uint32_t(page_size));
-
-		auto item_type = r.get_child_data_type(ui_node::type_id);
-
-		uint32_t i = 0;
-		for(; i < in_page && i < children.size(); ++i) {
-			auto dat = impl::get_local_data(r, children[i], item_type.variable);
-			if(dat) {
-				memcpy(dat, (*data)[i + page_start], datatype_size(item_type.data_type));
-			}
-			children[i]->behavior_flags &= ~behavior::functionally_hidden;
-			children[i]->on_update(r);
-		}
-		for(; i < children.size(); ++i) {
-			children[i]->behavior_flags |= behavior::functionally_hidden;
-		}
-
-		page_controls->on_update(r);
+		bind_page(r, false);
+		next.push_back(page_controls);
 	}
 }
 void monotype_column::on_create(root& r) {
@@ -3619,6 +4505,8 @@ void monotype_column::on_create(root& r) {
 }
 void monotype_column::force_resize(root& r, layout_position size) {
 	auto item_type = r.get_child_data_type(ui_node::type_id);
+	auto old_page_size = page_size;
+	auto old_page = current_page;
 
 	position.width = size.x;
 	position.height = size.y;
@@ -3638,17 +4526,17 @@ void monotype_column::force_resize(root& r, layout_position size) {
 	int32_t i = 0;
 	for(; true; ++i) {
 		bool child_fits_in_column = true;
-		if(i >= children.size()) {
+		if(size_t(i) >= children.size()) {
 			children.push_back(r.make_control_by_type(this, item_type.child_control_type));
 		}
 		if(width_per_column == em{ 0 }) {
-			auto item_min = children[0]->minimum_width(r);
+			auto item_min = row_minimum_size(r).x;
 			auto cols = (size.x.value * 100) / item_min.value;
 			col_settings.number_of_columns = int8_t(cols);
 			width_per_column = size.x / cols;
 		}
 			
-		children[i]->resize(r, minui::layout_position{ width_per_column, available_size - cur_height }, width_per_column, em{ 0 });
+		measure_row(r, uint32_t(i), width_per_column, available_size - cur_height);
 		if(children[i]->position.height > available_size - cur_height)
 			child_fits_in_column = false;
 
@@ -3662,11 +4550,11 @@ void monotype_column::force_resize(root& r, layout_position size) {
 
 			// position column
 			if(col_settings.layout == column_layout::centered) {
-				for(uint32_t j = col_start; j < i; ++j) {
+				for(int32_t j = col_start; j < i; ++j) {
 					children[j]->position.x = children[j]->position.x + (available_size - cur_height) / 2;
 				}
 			} else if(col_settings.layout == column_layout::bottom) {
-				for(uint32_t j = col_start; j < i; ++j) {
+				for(int32_t j = col_start; j < i; ++j) {
 					children[j]->position.x = children[j]->position.x + (available_size - cur_height);
 				}
 			}
@@ -3685,18 +4573,18 @@ void monotype_column::force_resize(root& r, layout_position size) {
 
 	//  position last column
 	if(col_settings.layout == column_layout::centered) {
-		for(uint32_t j = col_start; j < i; ++j) {
+		for(int32_t j = col_start; j < i; ++j) {
 			children[j]->position.x = children[j]->position.x + (available_size - cur_height) / 2;
 		}
 	} else if(col_settings.layout == column_layout::bottom) {
-		for(uint32_t j = col_start; j < i; ++j) {
+		for(int32_t j = col_start; j < i; ++j) {
 			children[j]->position.x = children[j]->position.x + (available_size - cur_height);
 		}
 	}
 
 	page_size = uint16_t(i);
-	num_pages = uint16_t((data->size() + page_size - 1) / page_size);
-	current_page = std::min(current_page, uint16_t(num_pages - 1));
+	num_pages = uint16_t((items().size() + page_size - 1) / page_size);
+	current_page = std::min(current_page, uint16_t(std::max(uint16_t(1), num_pages) - 1));
 
 	if(num_pages > 1) {
 		page_controls->behavior_flags |= ~(behavior::visually_hidden | behavior::functionally_hidden);
@@ -3704,23 +4592,13 @@ void monotype_column::force_resize(root& r, layout_position size) {
 		page_controls->behavior_flags |= behavior::functionally_hidden;
 	}
 
-	uint32_t page_start = page_size * current_page;
-	uint32_t in_page = std::min(uint32_t(data->size() - page_start), uint32_t(page_size));
-
-	uint32_t i = 0;
-	for(; i < in_page; ++i) {
-		auto dat = impl::get_local_data(r, children[i], item_type.variable);
-		if(dat) {
-			memcpy(dat, (*data)[i + page_start], datatype_size(item_type.data_type));
-		}
-		children[i]->behavior_flags &= ~behavior::functionally_hidden;
-		children[i]->on_update(r);
-	}
-	for(; i < children.size(); ++i) {
-		children[i]->behavior_flags |= behavior::functionally_hidden;
-	}
-	pending_data_update = false;
-	page_controls->on_update(r);
+	// rows run user functions when they are bound; rows still showing the item they had are skipped unless
+	// the page moved
+	bool page_moved = page_size != old_page_size || current_page != old_page;
+	r.run_after_parallel_layout([this, &r, page_moved]() {
+		bind_page(r, page_moved);
+		page_controls->on_update(r);
+	});
 }
 void monotype_column::resize(root& r, layout_position maximum_space, em desired_width, em desired_height) {
 	auto target_width = std::min(std::max(desired_width, minimum_width(r)), maximum_space.x);
@@ -3728,20 +4606,64 @@ void monotype_column::resize(root& r, layout_position maximum_space, em desired_
 	force_resize(r, layout_position{ target_width, target_height });
 }
 em monotype_column::minimum_width(root& r) {
+	return std::max(page_controls->minimum_width(r), row_minimum_size(r).x);
+}
+em monotype_column::minimum_height(root& r) {
+	return page_controls->minimum_height(r) + row_minimum_size(r).y;
+}
+layout_position monotype_column::row_minimum_size(root& r) {
 	if(children.empty()) {
 		auto item_type = r.get_child_data_type(ui_node::type_id);
 		children.push_back(r.make_control_by_type(this, item_type.child_control_type));
 	}
 
-	return std::max(page_controls->minimum_width(r), children[0]->minimum_width(r));
+	// a space of -1 by -1 stands for the unconstrained minimum
+	constexpr layout_position unconstrained{ em{ -1 }, em{ -1 } };
+	auto fingerprint = row_fingerprint(r, 0);
+	if(fingerprint) {
+		if(auto m = r.find_measurement(children[0]->type_id, unconstrained, *fingerprint); m)
+			return *m;
+	}
+	layout_position result{ children[0]->minimum_width(r), children[0]->minimum_height(r) };
+	if(fingerprint)
+		r.store_measurement(children[0]->type_id, unconstrained, *fingerprint, result);
+	return result;
 }
-em monotype_column::minimum_height(root& r) {
-	if(children.empty()) {
-		auto item_type = r.get_child_data_type(ui_node::type_id);
-		children.push_back(r.make_control_by_type(this, item_type.child_control_type));
+std::optional<uint64_t> monotype_column::row_fingerprint(root& r, uint32_t row) const {
+	if((children[row]->behavior_flags & behavior::layout_uniform_size) != 0)
+		return uint64_t(0);
+	if(row >= bound_rows.size() || !bound_rows[row].source)
+		return std::nullopt;
+
+	// the row's copy of its item is what it was last updated with; without one, the item is identified by
+	// where it is and its version, if the source keeps versions. Odd, so as not to meet the uniform 0.
+	auto item_type = r.get_child_data_type(ui_node::type_id);
+	if(auto dat = impl::get_local_data(r, static_cast<ui_node const*>(children[row]), item_type.variable); dat)
+		return ankerl::unordered_dense::detail::wyhash::hash(dat, datatype_size(item_type.data_type)) | 1;
+	if(auto& b = bound_rows[row]; b.element_version != 0) {
+		uint64_t id[] = { uint64_t(reinterpret_cast<uintptr_t>(b.source)), uint64_t(b.index), b.element_version };
+		return ankerl::unordered_dense::detail::wyhash::hash(id, sizeof(id)) | 1;
+	}
+	return std::nullopt;
+}
+void monotype_column::measure_row(root& r, uint32_t i, em width, em available_height) {
+	auto& row = *children[i];
+	auto fingerprint = row_fingerprint(r, i);
+	if(!fingerprint) {
+		row.resize(r, layout_position{ width, available_height }, width, em{ 0 });
+		return;
 	}
 
-	return page_controls->minimum_height(r) + children[0]->minimum_height(r);
+	// rows are measured once per content, width and column height against the full column height; the
+	// fits-in-column test in force_resize handles the remaining space
+	layout_position space{ width, position.height - page_controls->position.height };
+	if(auto m = r.find_measurement(row.type_id, space, *fingerprint); m) {
+		if(row.position.width != m->x || row.position.height != m->y)
+			row.force_resize(r, *m);
+		return;
+	}
+	row.resize(r, space, width, em{ 0 });
+	r.store_measurement(row.type_id, space, *fingerprint, layout_position{ row.position.width, row.position.height });
 }
 page_information monotype_column::get_page_information() {
 	return page_information{ current_page, num_pages };
@@ -3754,37 +4676,103 @@ void monotype_column::change_page(root& r, int32_t new_page) {
 		r.back_out_focus(*this);
 
 	current_page = uint16_t(new_page);
+	r.invalidate_layout(this);
 
-	uint32_t page_start = page_size * current_page;
-	uint32_t in_page = std::min(uint32_t(data->size() - page_start), uint32_t(page_size));
+	bound_rows.clear();
+	bind_page(r, false);
+	page_controls->on_update(r);
+}
+void monotype_column::on_scroll(root& r, layout_position, int32_t amount) {
+	change_page(r, std::clamp(current_page + amount, 0, int32_t(num_pages) - 1));
+}
+void monotype_column::bind_page(root& r, bool force_update) {
+	auto& source = items();
+
+	auto first = page_start(source.size());
+	uint32_t in_page = uint32_t(std::min(source.size() - first, size_t(page_size)));
 	auto item_type = r.get_child_data_type(ui_node::type_id);
+	auto item_size = datatype_size(item_type.data_type);
+
+	if(bound_rows.size() < children.size())
+		bound_rows.resize(children.size());
 
+	// rows that declare the item variable get a copy of their visible item; other rows
+	// read it in place through get_item. A row still bound to the same item of the same
+	// source is left alone if the item has not changed: by its version, when the source
+	// keeps them, or else by comparing it with the row's copy. A row without a copy is
+	// always updated.
 	uint32_t i = 0;
 	for(; i < in_page && i < children.size(); ++i) {
+		auto index = first + i;
+		auto item = source.element(index);
+		auto version = source.element_version(index);
 		auto dat = impl::get_local_data(r, children[i], item_type.variable);
+		auto& bound = bound_rows[i];
+
+		bool was_hidden = (children[i]->behavior_flags & behavior::functionally_hidden) != 0;
+		if(!force_update && !was_hidden && bound.source == &source && bound.index == index) {
+			if(version != 0 ? bound.element_version == version : (dat && memcmp(dat, item, item_size) == 0))
+				continue;
+		}
+
+		bound = bound_row{ &source, index, version };
 		if(dat) {
-			memcpy(dat, (*data)[i + page_start], datatype_size(item_type.data_type));
+			memcpy(dat, item, item_size);
 		}
+		if(was_hidden)
+			r.invalidate_layout(children[i]);
 		children[i]->behavior_flags &= ~behavior::functionally_hidden;
 		children[i]->on_update(r);
+		r.invalidate_render(children[i]);
 	}
 	for(; i < children.size(); ++i) {
+		if((children[i]->behavior_flags & behavior::functionally_hidden) == 0)
+			r.invalidate_layout(children[i]);
 		children[i]->behavior_flags |= behavior::functionally_hidden;
+		bound_rows[i] = bound_row{ };
 	}
+	bound_version = source.version();
 	pending_data_update = false;
-	page_controls->on_update(r);
-}
-void monotype_column::on_scroll(root& r, layout_position pos, int32_t amount) {
-	change_page(r, std::clamp(current_page + amount, 0, int32_t(num_pages) - 1));
 }
 void monotype_column::add_item(void const* d) {
+	if(external_source) {
+		external_source = nullptr;
+		data->clear();
+	}
 	data->push_back(d);
 	pending_data_update = true;
 }
 void monotype_column::clear_contents() {
+	external_source = nullptr;
+	data->clear();
+	pending_data_update = true;
+}
+bool monotype_column::set_items(void const* first, size_t count, size_t item_size) {
+	if(item_size != data->element_size())
+		return false;
+	external_source = nullptr;
+	data->assign(first, count);
+	bound_rows.clear();
+	pending_data_update = true;
+	return true;
+}
+void monotype_column::set_data_source(monotype_data_source const* source) {
+	external_source = source;
 	data->clear();
+	bound_rows.clear();
 	pending_data_update = true;
 }
+void const* monotype_column::get_item(ui_node const& row) const {
+	auto& source = items();
+
+	auto first = page_start(source.size());
+	uint32_t in_page = uint32_t(std::min(source.size() - first, size_t(page_size)));
+	for(uint32_t i = 0; i < in_page && i < children.size(); ++i) {
+		if(children[i] == &row)
+			return source.element(first + i);
+	}
+	return nullptr;
+}
 
 //
 // panes_set
@@ -3793,7 +4781,7 @@ void monotype_column::clear_contents() {
 size_t panes_set::size() const {
 	return sizeof(panes_set);
 }
-void panes_set::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void panes_set::render(root& r, layout_position offset, postponed_list& postponed) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
@@ -3801,22 +4789,22 @@ void panes_set::render(root& r, layout_position offset, std::vector<postponed_re
 	if((children[selected]->behavior_flags & behavior::pop_up) != 0) {
 		postponed.push_back(postponed_render{ children[selected], child_position });
 	} else {
-		children[selected]->render(r, child_position, postponed);
+		r.render_node(*children[selected], child_position, postponed);
 	}
 }
 uint32_t panes_set::child_count() const {
 	return uint32_t(1);
 }
-ui_node* panes_set::get_child(uint32_t index) const {
+ui_node* panes_set::get_child(uint32_t) const {
 	return children[selected];
 }
-probe_result panes_set::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result panes_set::mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) {
 	probe_result result;
 
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return result;
 
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -3831,7 +4819,7 @@ probe_result panes_set::mouse_probe(root& r, layout_position probe_pos, layout_p
 	if((children[selected]->behavior_flags & behavior::pop_up) != 0) {
 		postponed.push_back(postponed_render{ children[selected], child_position });
 	} else {
-		auto c_result = children[selected]->mouse_probe(r, probe_pos, child_position, postponed);
+		auto c_result = r.probe_node(*children[selected], probe_pos, child_position, postponed);
 		for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 			if(c_result.type_array[i].node) {
 				result.type_array[i] = c_result.type_array[i];
@@ -3860,16 +4848,18 @@ void panes_set::on_hide(root& r) {
 	children[selected]->on_hide(r);
 }
 void panes_set::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode panes_set::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
-
+		return update_mode::skip;
+	return update_mode::with_function;
+}
+void panes_set::update_children(root&, update_list& next) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
-	children[selected]->on_update(r);
+	next.push_back(children[selected]);
 }
 void panes_set::on_create(root& r) {
 	{
@@ -3902,6 +4892,7 @@ void panes_set::change_page(root& r, int32_t new_page) {
 
 	children[selected]->on_hide(r);
 	selected = uint16_t(new_page);
+	r.invalidate_layout(this);
 	children[selected]->on_update(r);
 	children[selected]->on_visible(r);
 }
@@ -3909,23 +4900,23 @@ void panes_set::change_page(root& r, int32_t new_page) {
 void panes_set::force_resize(root& r, layout_position size) {
 	position.width = size.x;
 	position.height = size.y;
-	for(auto c : children) {
-		c->force_resize(r, size);
-	}
+	r.parallel_layout(children.size(), [&](size_t i) {
+		children[i]->force_resize(r, size);
+	});
 }
 void panes_set::resize(root& r, layout_position maximum_space, em desired_width, em desired_height) {
-	for(auto c : children) {
-		c->resize(r, maximum_space, desired_width, desired_height);
-	}
+	r.parallel_layout(children.size(), [&](size_t i) {
+		children[i]->resize(r, maximum_space, desired_width, desired_height);
+	});
 	em maxwidth{ 0 };
 	em maxheight{ 0 };
 	for(auto c : children) {
 		maxwidth = std::max(maxwidth, c->position.width);
 		maxheight = std::max(maxheight, c->position.height);
 	}
-	for(auto c : children) {
-		c->force_resize(r, layout_position{ maxwidth, maxheight });
-	}
+	r.parallel_layout(children.size(), [&](size_t i) {
+		children[i]->force_resize(r, layout_position{ maxwidth, maxheight });
+	});
 	position.width = maxwidth;
 	position.height = maxheight;
 }
@@ -3951,17 +4942,32 @@ em panes_set::minimum_height(root& r) {
 size_t layers::size() const {
 	return sizeof(layers);
 }
-void layers::render(root& r, layout_position offset, std::vector<postponed_render>& ) {
+void layers::render(root& r, layout_position offset, postponed_list& ) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
-	std::vector<postponed_render> postponed;
+	// a layer hidden under a solid background in a later layer is skipped
+	std::pmr::vector<layout_rect> covers(children.size(), &r.frame_memory);
+	for(uint32_t i = 0; i < children.size(); ++i) {
+		covers[i] = r.opaque_area(*children[i], get_sub_position(*this, *children[i]) + offset);
+	}
+
+	postponed_list postponed(&r.frame_memory);
 	for(uint32_t i = 0; i < children.size(); ++i) {
 		auto child_position = get_sub_position(*this, *children[i]) + offset;
-		children[i]->render(r, child_position, postponed);
+		auto bounds = r.render_bounds(*children[i], child_position);
+		bool covered = false;
+		for(uint32_t j = i + 1; j < children.size() && !covered; ++j) {
+			covered = covers[j].width.value > 0 && covers[j].height.value > 0 && contains(covers[j], bounds);
+		}
+		if(covered) {
+			++r.nodes_culled;
+			continue;
+		}
+		r.render_node(*children[i], child_position, postponed);
 
 		for(uint32_t j = 0; j < postponed.size(); ++j) {
-			postponed[j].n->render(r, postponed[j].offset, postponed);
+			r.render_node(*postponed[j].n, postponed[j].offset, postponed);
 		}
 		postponed.clear();
 	}
@@ -3972,13 +4978,13 @@ uint32_t layers::child_count() const {
 ui_node* layers::get_child(uint32_t index) const {
 	return children[index];
 }
-probe_result layers::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>&) {
+probe_result layers::mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list&) {
 	probe_result result;
 
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return result;
 
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -3989,11 +4995,11 @@ probe_result layers::mouse_probe(root& r, layout_position probe_pos, layout_posi
 		}
 	}
 
-	std::vector<postponed_render> postponed;
+	postponed_list postponed(&r.frame_memory);
 	for(uint32_t i = 0; i < children.size(); ++i) {
 		{
 			auto child_position = get_sub_position(*this, *children[i]) + offset;
-			auto c_result = children[i]->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*children[i], probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -4002,7 +5008,7 @@ probe_result layers::mouse_probe(root& r, layout_position probe_pos, layout_posi
 		}
 
 		for(uint32_t j = 0; j < postponed.size(); ++j) {
-			auto c_result = postponed[j].n->mouse_probe(r, probe_pos, postponed[j].offset, postponed);
+			auto c_result = r.probe_node(*postponed[j].n, probe_pos, postponed[j].offset, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -4015,15 +5021,15 @@ probe_result layers::mouse_probe(root& r, layout_position probe_pos, layout_posi
 	return result;
 }
 void layers::on_update(root& r) {
-	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
+	update_subtree(r, *this);
+}
+update_mode layers::begin_update(root&) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
-		return;
-
-	for(uint32_t i = 0; i < children.size(); ++i) {
-		children[i]->on_update(r);
-	}
+		return update_mode::skip;
+	return update_mode::no_function;
+}
+void layers::update_children(root&, update_list& next) {
+	next.insert(next.end(), children.begin(), children.end());
 }
 void layers::on_visible(root& r) {
 	for(auto c : children)
@@ -4055,23 +5061,23 @@ void layers::on_create(root& r) {
 void layers::force_resize(root& r, layout_position size) {
 	position.width = size.x;
 	position.height = size.y;
-	for(auto c : children) {
-		c->force_resize(r, size);
-	}
+	r.parallel_layout(children.size(), [&](size_t i) {
+		children[i]->force_resize(r, size);
+	});
 }
 void layers::resize(root& r, layout_position maximum_space, em desired_width, em desired_height) {
-	for(auto c : children) {
-		c->resize(r, maximum_space, desired_width, desired_height);
-	}
+	r.parallel_layout(children.size(), [&](size_t i) {
+		children[i]->resize(r, maximum_space, desired_width, desired_height);
+	});
 	em maxwidth{ 0 };
 	em maxheight{ 0 };
 	for(auto c : children) {
 		maxwidth = std::max(maxwidth, c->position.width);
 		maxheight = std::max(maxheight, c->position.height);
 	}
-	for(auto c : children) {
-		c->force_resize(r, layout_position{ maxwidth, maxheight });
-	}
+	r.parallel_layout(children.size(), [&](size_t i) {
+		children[i]->force_resize(r, layout_position{ maxwidth, maxheight });
+	});
 	position.width = maxwidth;
 	position.height = maxheight;
 }
@@ -4097,7 +5103,7 @@ em layers::minimum_height(root& r) {
 size_t dynamic_grid::size() const {
 	return sizeof(dynamic_grid);
 }
-void dynamic_grid::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void dynamic_grid::render(root& r, layout_position offset, postponed_list& postponed) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
@@ -4133,7 +5139,7 @@ void dynamic_grid::render(root& r, layout_position offset, std::vector<postponed
 		if((children[i]->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ children[i], child_position });
 		} else {
-			children[i]->render(r, child_position, postponed);
+			r.render_node(*children[i], child_position, postponed);
 		}
 		if(!in_group && (children[i]->behavior_flags & behavior::layout_as_separator) == 0) {
 			mode = !mode;
@@ -4145,7 +5151,7 @@ void dynamic_grid::render(root& r, layout_position offset, std::vector<postponed
 		if((page_controls->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ page_controls, child_position });
 		} else {
-			page_controls->render(r, child_position, postponed);
+			r.render_node(*page_controls, child_position, postponed);
 		}
 	}
 }
@@ -4162,13 +5168,13 @@ ui_node* dynamic_grid::get_child(uint32_t index) const {
 	else
 		return page_controls;
 }
-probe_result dynamic_grid::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result dynamic_grid::mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) {
 	probe_result result;
 
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return result;
 
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -4189,7 +5195,7 @@ probe_result dynamic_grid::mouse_probe(root& r, layout_position probe_pos, layou
 		if((children[i]->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ children[i], child_position });
 		} else {
-			auto c_result = children[i]->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*children[i], probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -4202,7 +5208,7 @@ probe_result dynamic_grid::mouse_probe(root& r, layout_position probe_pos, layou
 		if((page_controls->behavior_flags & behavior::pop_up) != 0) {
 			postponed.push_back(postponed_render{ page_controls, child_position });
 		} else {
-			auto c_result = page_controls->mouse_probe(r, probe_pos, child_position, postponed);
+			auto c_result = r.probe_node(*page_controls, probe_pos, child_position, postponed);
 			for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 				if(c_result.type_array[i].node) {
 					result.type_array[i] = c_result.type_array[i];
@@ -4244,12 +5250,14 @@ void dynamic_grid::on_lose_focus(root& r) {
 	fn(r, *this);
 }
 void dynamic_grid::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode dynamic_grid::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
-
+		return update_mode::skip;
+	return update_mode::with_function;
+}
+void dynamic_grid::update_children(root& r, update_list& next) {
 	if(pending_relayout)
 		repaginate(r);
 
@@ -4259,11 +5267,8 @@ void dynamic_grid::on_update(root& r) {
 	uint32_t page_start = (current_page == 0 ? 0 : page_starts[current_page - 1]);
 	uint32_t page_end = (current_page >= int32_t(num_pages) - 1 ? uint32_t(children.size()) : page_starts[current_page]);
 
-	for(uint32_t i = page_start; i < page_end; ++i) {
-		children[i]->on_update(r);
-	}
-
-	page_controls->on_update(r);
+	next.insert(next.end(), children.begin() + page_start, children.begin() + page_end);
+	next.push_back(page_controls);
 }
 void dynamic_grid::on_create(root& r) {
 	page_controls = make_page_controls(r, this);
@@ -4303,7 +5308,6 @@ void dynamic_grid::force_resize(root& r, layout_position size) {
 		max_width = max_width - page_controls->position.width;
 	}
 
-	int32_t cur_page = 0;
 	int32_t row_start = 0;
 	int32_t page_start = 0;
 
@@ -4343,7 +5347,7 @@ void dynamic_grid::force_resize(root& r, layout_position size) {
 			cur_height = em{ 0 };
 			
 			// position row
-			for(uint32_t j = row_start; j < i; ++j) {
+			for(int32_t j = row_start; j < i; ++j) {
 				children[j]->position.x = children[j]->position.x + (row_height - children[j]->position.height) / 2;
 			}
 			row_height = em{ 0 };
@@ -4353,7 +5357,7 @@ void dynamic_grid::force_resize(root& r, layout_position size) {
 			row_start = i;
 			cur_x_off = em{ 0 };
 			cur_height = cur_height + row_height;
-			for(uint32_t j = row_start; j < i; ++j) {
+			for(int32_t j = row_start; j < i; ++j) {
 				children[j]->position.x = children[j]->position.x + (row_height - children[j]->position.height) / 2;
 			}
 			row_height = em{ 0 };
@@ -4361,7 +5365,7 @@ void dynamic_grid::force_resize(root& r, layout_position size) {
 		}
 	}
 
-	for(uint32_t j = row_start; j < i; ++j) {
+	for(int32_t j = row_start; j < i; ++j) {
 		children[j]->position.x = children[j]->position.x + (row_height - children[j]->position.height) / 2;
 	}
 
@@ -4373,7 +5377,7 @@ void dynamic_grid::force_resize(root& r, layout_position size) {
 	} else {
 		page_controls->behavior_flags |= behavior::functionally_hidden;
 	}
-	page_controls->on_update(r);
+	r.run_after_parallel_layout([this, &r]() { page_controls->on_update(r); });
 
 	pending_relayout = false;
 }
@@ -4423,6 +5427,7 @@ void dynamic_grid::change_page(root& r, int32_t new_page) {
 	}
 
 	current_page = uint16_t(new_page);
+	r.invalidate_layout(this);
 
 	{
 		uint32_t page_start = (current_page == 0 ? 0 : page_starts[current_page - 1]);
@@ -4436,10 +5441,10 @@ void dynamic_grid::change_page(root& r, int32_t new_page) {
 
 	page_controls->on_update(r);
 }
-void dynamic_grid::on_scroll(root& r, layout_position pos, int32_t amount) {
+void dynamic_grid::on_scroll(root& r, layout_position, int32_t amount) {
 	change_page(r, std::clamp(current_page + amount, 0, int32_t(num_pages) - 1));
 }
-void dynamic_grid::add_managed_element(root& r, ui_node* n) {
+void dynamic_grid::add_managed_element(root&, ui_node* n) {
 	children.push_back(n);
 	pending_relayout = true;
 }
@@ -4452,6 +5457,7 @@ void dynamic_grid::reset_managed_elements(root& r) {
 }
 void dynamic_grid::repaginate(root& r) {
 	force_resize(r, layout_position{ position.width, position.height });
+	r.invalidate_layout(this);
 }
 
 //
@@ -4461,16 +5467,16 @@ void dynamic_grid::repaginate(root& r) {
 size_t static_text::size() const {
 	return sizeof(static_text);
 }
-void static_text::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void static_text::render(root& r, layout_position offset, postponed_list&) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
 	render_background(r, r.get_background_definition(type_id), offset, *this);
 
 	layout_rect rct{ offset.x + margins.x, offset.y + margins.y, position.width - (margins.x + margins.width), position.height - (margins.y + margins.height) };
-	text_data->render(r.system, rct, r.get_foreground_brush(ui_node::type_id));
+	r.display.text(*text_data, rct, r.get_foreground_brush(ui_node::type_id));
 }
-probe_result static_text::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result static_text::mouse_probe(root&, layout_position, layout_position, postponed_list&) {
 	return probe_result{ };
 }
 void static_text::on_visible(root& r) {
@@ -4482,11 +5488,12 @@ void static_text::on_hide(root& r) {
 	fn(r, *this);
 }
 void static_text::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode static_text::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
+		return update_mode::skip;
+	return update_mode::with_function;
 }
 void static_text::on_create(root& r) {
 	text_data = r.system.make_text(*this);
@@ -4526,7 +5533,7 @@ void static_text::on_reload(root& r) {
 		fn(r, *this);
 	}
 }
-void static_text::force_resize(root& r, layout_position size) {
+void static_text::force_resize(root&, layout_position size) {
 	position.width = size.x;
 	position.height = size.y;
 }
@@ -4568,7 +5575,7 @@ em static_text::minimum_height(root& r) {
 size_t text_button::size() const {
 	return sizeof(text_button);
 }
-void text_button::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void text_button::render(root& r, layout_position offset, postponed_list&) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
@@ -4577,7 +5584,7 @@ void text_button::render(root& r, layout_position offset, std::vector<postponed_
 	auto ico_pos = r.get_icon_position(ui_node::type_id);
 	
 	if(r.pmode == prompt_mode::hidden || (ui_node::behavior_flags & behavior::interaction_flagged) == 0) {
-		r.system.icon(r.get_icon(ui_node::type_id),
+		r.display.icon(r.get_icon(ui_node::type_id),
 			screen_space_rect{
 				r.system.to_screen_space(offset.x + ico_pos.x), r.system.to_screen_space(offset.y + ico_pos.y),
 				r.system.to_screen_space(em{ 100 }), r.system.to_screen_space(em{ 100 })
@@ -4588,12 +5595,12 @@ void text_button::render(root& r, layout_position offset, std::vector<postponed_
 
 
 	layout_rect rct{ offset.x + margins.x, offset.y + margins.y, position.width - (margins.x + margins.width), position.height - (margins.y + margins.height) };
-	text_data->render(r.system, rct, r.get_foreground_brush(ui_node::type_id), enabled ? rendering_modifiers::none : rendering_modifiers::disabled);
+	r.display.text(*text_data, rct, r.get_foreground_brush(ui_node::type_id), enabled ? rendering_modifiers::none : rendering_modifiers::disabled);
 }
-probe_result text_button::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result text_button::mouse_probe(root&, layout_position probe_pos, layout_position offset, postponed_list&) {
 	probe_result result;
 
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -4617,11 +5624,12 @@ void text_button::on_hide(root& r) {
 	fn(r, *this);
 }
 void text_button::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode text_button::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
+		return update_mode::skip;
+	return update_mode::with_function;
 }
 void text_button::on_create(root& r) {
 	text_data = r.system.make_text(*this);
@@ -4659,7 +5667,7 @@ void text_button::on_reload(root& r) {
 		fn(r, *this);
 	}
 }
-void text_button::force_resize(root& r, layout_position size) {
+void text_button::force_resize(root&, layout_position size) {
 	position.width = size.x;
 	position.height = size.y;
 }
@@ -4694,7 +5702,7 @@ em text_button::minimum_height(root& r) {
 	auto lh = text_data->get_line_height(r.system);
 	return lh * std::max(1, text_data->get_number_of_text_lines(r.system));
 }
-void text_button::on_lbutton(root& r, layout_position pos) {
+void text_button::on_lbutton(root& r, layout_position) {
 	if(enabled) {
 		auto fn = r.get_user_mouse_fn_a(ui_node::type_id);
 		r.system.play_sound(r.get_interaction_sound(type_id));
@@ -4743,24 +5751,22 @@ void icon_button::recalculate_icon_position(root& r) {
 		icon_position.y = data.margins.y;
 	}
 }
-void icon_button::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void icon_button::render(root& r, layout_position offset, postponed_list&) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
 	render_background(r, r.get_background_definition(type_id), offset, *this, enabled ? rendering_modifiers::none : rendering_modifiers::disabled);
 
-	auto ico_pos = r.get_icon_position(ui_node::type_id);
-
-	r.system.icon(
+	r.display.icon(
 		r.get_icon(ui_node::type_id),
 		r.system.to_screen_space(icon_position + offset),
 		r.get_foreground_brush(ui_node::type_id),
 		enabled ? rendering_modifiers::none : rendering_modifiers::disabled);
 }
-probe_result icon_button::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result icon_button::mouse_probe(root&, layout_position probe_pos, layout_position offset, postponed_list&) {
 	probe_result result;
 
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -4784,11 +5790,12 @@ void icon_button::on_hide(root& r) {
 	fn(r, *this);
 }
 void icon_button::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode icon_button::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
+		return update_mode::skip;
+	return update_mode::with_function;
 }
 void icon_button::on_create(root& r) {
 	{
@@ -4830,7 +5837,7 @@ em icon_button::minimum_height(root& r) {
 		return em{ 100 } + data.margins.y + data.margins.height;
 	}
 }
-void icon_button::on_lbutton(root& r, layout_position pos) {
+void icon_button::on_lbutton(root& r, layout_position) {
 	if(enabled) {
 		r.system.play_sound(r.get_interaction_sound(type_id));
 		auto fn = r.get_user_mouse_fn_a(ui_node::type_id);
@@ -4845,7 +5852,7 @@ void icon_button::on_lbutton(root& r, layout_position pos) {
 size_t edit_control::size() const {
 	return sizeof(edit_control);
 }
-void edit_control::render(root& r, layout_position offset, std::vector<postponed_render>& postponed) {
+void edit_control::render(root& r, layout_position offset, postponed_list&) {
 	if((ui_node::behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
 		return;
 
@@ -4854,7 +5861,7 @@ void edit_control::render(root& r, layout_position offset, std::vector<postponed
 	auto ico_pos = r.get_icon_position(ui_node::type_id);
 
 	if(r.contains_focus(this)) {
-		r.system.icon(
+		r.display.icon(
 			r.get_icon(ui_node::type_id),
 			screen_space_rect{
 				r.system.to_screen_space(offset.x + ico_pos.x), r.system.to_screen_space(offset.y + ico_pos.y),
@@ -4863,7 +5870,7 @@ void edit_control::render(root& r, layout_position offset, std::vector<postponed
 			r.get_highlight_brush(ui_node::type_id),
 			text_data->is_read_only() ? rendering_modifiers::disabled : rendering_modifiers::none);
 	} else if(r.pmode == prompt_mode::hidden || (ui_node::behavior_flags & behavior::interaction_flagged) == 0) {
-		r.system.icon(
+		r.display.icon(
 			r.get_icon(ui_node::type_id),
 			screen_space_rect{
 				r.system.to_screen_space(offset.x + ico_pos.x), r.system.to_screen_space(offset.y + ico_pos.y),
@@ -4874,12 +5881,12 @@ void edit_control::render(root& r, layout_position offset, std::vector<postponed
 	}
 	
 	layout_rect rct{ offset.x + margins.x, offset.y + margins.y, position.width - (margins.x + margins.width), position.height - (margins.y + margins.height) };
-	text_data->render(r.system, rct, r.get_foreground_brush(ui_node::type_id));
+	r.display.text(*text_data, rct, r.get_foreground_brush(ui_node::type_id));
 }
-probe_result edit_control::mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) {
+probe_result edit_control::mouse_probe(root&, layout_position probe_pos, layout_position offset, postponed_list&) {
 	probe_result result;
 
-	if(offset.x <= probe_pos.x && probe_pos.x < offset.x + ui_node::position.width) {
+	if(contains(layout_rect{ offset.x, offset.y, ui_node::position.width, ui_node::position.height }, probe_pos)) {
 		if((ui_node::behavior_flags & behavior::transparent_to_focus) == 0) {
 			result.type_array[size_t(mouse_interactivity::focus_target)].node = this;
 			result.type_array[size_t(mouse_interactivity::focus_target)].relative_location = probe_pos - offset;
@@ -4904,12 +5911,14 @@ void edit_control::on_hide(root& r) {
 }
 void edit_control::on_gain_focus(root& r) {
 	r.edit_target = text_data.get();
+	r.edit_target_node = this;
 	text_data->on_focus(r.system);
 	auto fn = r.get_on_gain_focus(ui_node::type_id);
 	fn(r, *this);
 }
 void edit_control::on_lose_focus(root& r) {
 	r.edit_target = nullptr;
+	r.edit_target_node = nullptr;
 	text_data->on_lose_focus(r.system);
 	auto fn = r.get_on_lose_focus(ui_node::type_id);
 	fn(r, *this);
@@ -4919,11 +5928,12 @@ void edit_control::on_text_update(root& r) {
 	fn(r, *this);
 }
 void edit_control::on_update(root& r) {
+	update_subtree(r, *this);
+}
+update_mode edit_control::begin_update(root&) {
 	if((ui_node::behavior_flags & behavior::functionally_hidden) != 0)
-		return;
-
-	auto fn = r.get_on_update(ui_node::type_id);
-	fn(r, *this);
+		return update_mode::skip;
+	return update_mode::with_function;
 }
 void edit_control::on_create(root& r) {
 	text_data = r.system.make_editable_text(*this);
@@ -4949,7 +5959,7 @@ void edit_control::on_reload(root& r) {
 	auto data = r.get_text_information(ui_node::type_id);
 	text_data->set_font(r.system, data.font);
 }
-void edit_control::force_resize(root& r, layout_position size) {
+void edit_control::force_resize(root&, layout_position size) {
 	position.width = size.x;
 	position.height = size.y;
 }
@@ -4989,7 +5999,7 @@ void root::load_font_definitions(char const* file_data, size_t file_size) {
 	auto num_fonts = b.read<uint32_t>();
 	for(uint32_t i = 0; i < num_fonts; ++i) {
 		text::font main_slot_font;
-		main_slot_font.name = b.read<std::wstring_view>();
+		main_slot_font.name = b.read<native_string_view>();
 		main_slot_font.span = b.read<float>();
 		main_slot_font.weight = b.read<int32_t>();
 		main_slot_font.top_leading = b.read<int32_t>();
@@ -5003,7 +6013,7 @@ void root::load_font_definitions(char const* file_data, size_t file_size) {
 		auto num_fallbacks = b.read<uint32_t>();
 		for(uint32_t j = 0; j < num_fallbacks; ++j) {
 			text::font_fallback fb;
-			fb.name = b.read<std::wstring_view>();
+			fb.name = b.read<native_string_view>();
 			fb.scale = b.read<float>();
 			auto vspn = b.read_variable<text::unicode_range>();
 			fb.ranges = std::vector<text::unicode_range>(vspn.begin(), vspn.end());
@@ -5016,7 +6026,7 @@ text::locale_description root::load_locale_description(char const* file_data, si
 	serialization::in_buffer b{ file_data, file_size };
 	text::locale_description result;
 	result.is_left_to_right = b.read<bool>();
-	result.display_name = b.read<std::wstring_view>();
+	result.display_name = b.read<native_string_view>();
 	return result;
 }
 
@@ -5054,15 +6064,18 @@ void root::load_locale_data(native_string_view locale) {
 	for(auto& ti : d_text_information) {
 		ti.second.text_resolved = false;
 	}
+	lazy_definitions_resolved = false;
+	invalidate_measurements();
+	invalidate_all_rendering();
 }
 
 ui_node* effective_focus_target(ui_node* in) {
 	if(!in)
 		return nullptr;
 
-	if((in->behavior_flags | behavior::interaction_focus) != 0)
+	if((in->behavior_flags & behavior::interaction_focus) != 0)
 		return in;
-	if((in->behavior_flags | behavior::transparent_to_focus) != 0 && in->child_count() > 0)
+	if((in->behavior_flags & behavior::transparent_to_focus) != 0 && in->child_count() > 0)
 		return in;
 	if(!in->parent)
 		return in;
@@ -5070,9 +6083,75 @@ ui_node* effective_focus_target(ui_node* in) {
 	return effective_focus_target(in->parent);
 }
 
+void root::drain_input() {
+	if(draining_input)
+		return;
+	draining_input = true;
+
+	auto dispatch = [&](input_event const& e) {
+		latency.input_arrived(e.at);
+		switch(e.type) {
+			case input_event::kind::mouse_move:
+				on_mouse_move(e.position);
+				break;
+			case input_event::kind::mouse_scroll:
+				on_mouse_scroll(e.amount);
+				break;
+			case input_event::kind::mouse_lbutton:
+				on_mouse_lbutton(e.click);
+				break;
+			case input_event::kind::mouse_rbutton:
+				on_mouse_rbutton();
+				break;
+			case input_event::kind::mouse_lbutton_up:
+				on_mouse_lbutton_up();
+				break;
+			case input_event::kind::mouse_rbutton_up:
+				on_mouse_rbutton_up();
+				break;
+			case input_event::kind::key_down:
+				on_key_down(e.scancode, e.vk_code, e.repeat);
+				break;
+			case input_event::kind::key_up:
+				on_key_up(e.scancode, e.vk_code);
+				break;
+			case input_event::kind::character:
+				on_char(e.c);
+				break;
+		}
+	};
+
+	// the event waiting to see whether the next one merges into it
+	std::optional<input_event> held;
+	input_event e;
+	while(input_queue.pop(e)) {
+		if(held && held->type == e.type && e.type == input_event::kind::mouse_move) {
+			held->position = e.position;
+			++input_events_coalesced;
+			continue;
+		}
+		if(held && held->type == e.type && e.type == input_event::kind::mouse_scroll) {
+			held->amount += e.amount;
+			++input_events_coalesced;
+			continue;
+		}
+		if(held)
+			dispatch(*held);
+		held = e;
+	}
+	if(held)
+		dispatch(*held);
+
+	draining_input = false;
+}
+
 bool root::on_char(native_char c) {
+	begin_input_handler();
+	record(replay::entry{ .type = replay::entry_type::character, .a = int32_t(c) });
 	if(edit_target) {
 		edit_target->insert_codepoint(system, uint32_t(c));
+		invalidate_render(edit_target_node);
+		damage_node(edit_target_node);
 		return true;
 	} 
 
@@ -5086,20 +6165,50 @@ bool root::on_char(native_char c) {
 	return positive_result;
 }
 
-bool root::on_mouse_move(layout_position p) {
-	std::vector<postponed_render> pop_ups;
+root::mouse_move_key root::make_mouse_move_key(layout_position p) const {
+	mouse_move_key k{ .x = p.x, .y = p.y, .layout_generation = layout_generation, .focus_depth = focus_stack.size(), .edit_target = edit_target };
+	if(!focus_stack.empty()) {
+		k.focus = focus_stack.back().l_interface;
+		k.child_offset = focus_stack.back().child_offset;
+		k.child_offset_end = focus_stack.back().child_offset_end;
+	}
+	return k;
+}
 
+bool root::on_mouse_move(layout_position p) {
+	begin_input_handler();
+	record(replay::entry{ .type = replay::entry_type::mouse_move, .a = p.x.value, .b = p.y.value });
 	latest_mouse_position = p;
-	under_mouse = node_repository[0]->mouse_probe(*this, p, layout_position{ em{ 0 }, em{ 0 } }, pop_ups);
+
+	// neither the mouse, the layout nor the focus moved since the last time, so the result would be the same
+	if(last_mouse_move && *last_mouse_move == make_mouse_move_key(p))
+		return mouse_over_ui();
+
+	frame_memory_scope memory(*this);
+	postponed_list pop_ups(&frame_memory);
+	++mouse_probes;
+	probes_skipped = 0;
+	auto old_highlight = under_mouse.type_array[size_t(mouse_interactivity::position)].node;
+	auto ws = system.get_workspace();
+	push_clip(layout_rect{ em{ 0 }, em{ 0 }, ws.x, ws.y });
+	under_mouse = probe_node(*node_repository[0], p, layout_position{ em{ 0 }, em{ 0 } }, pop_ups);
 
 	for(uint32_t i = 0; i < pop_ups.size(); ++i) {
-		auto c_result = pop_ups[i].n->mouse_probe(*this, p, pop_ups[i].offset, pop_ups);
+		auto c_result = probe_node(*pop_ups[i].n, p, pop_ups[i].offset, pop_ups);
 		for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
 			if(c_result.type_array[i].node) {
 				under_mouse.type_array[i] = c_result.type_array[i];
 			}
 		}
 	}
+	pop_clip();
+
+	if(auto new_highlight = under_mouse.type_array[size_t(mouse_interactivity::position)].node; new_highlight != old_highlight) {
+		invalidate_render(old_highlight);
+		invalidate_render(new_highlight);
+		damage_node(old_highlight);
+		damage_node(new_highlight);
+	}
 
 	[&]() {
 		// moving a mouse in an edit control
@@ -5130,7 +6239,8 @@ bool root::on_mouse_move(layout_position p) {
 				if((fe->behavior_flags & (behavior::focus_lock_mouse | behavior::focus_lock_text)) != 0) {
 					return; // can't shift -- 
 				}
-				if((fe->behavior_flags & behavior::focus_sticky_mouse) != 0) {
+				// a sticky element that has been hidden no longer holds on to the focus
+				if((fe->behavior_flags & behavior::focus_sticky_mouse) != 0 && get_placement(*fe).visible) {
 					auto abs_position = workspace_placement(*fe);
 					auto rel_position = p - abs_position;
 
@@ -5149,7 +6259,7 @@ bool root::on_mouse_move(layout_position p) {
 					}
 				}
 
-
+				focus_stack.pop_back();
 			}
 
 			// fallthrough ? -> focus stack is now empty or targets desired container
@@ -5161,14 +6271,10 @@ bool root::on_mouse_move(layout_position p) {
 		if(desired_focus_container) {
 			int32_t index = -1;
 			if(desired_focus_container != under_mouse.type_array[size_t(mouse_interactivity::focus_target)].node) {
-				int32_t spos = 0;
-				for(auto i : interactables(*desired_focus_container)) {
-					if(i == under_mouse.type_array[size_t(mouse_interactivity::focus_target)].node) {
-						index = spos;
-						break;
-					}
-					++spos;
-				}
+				auto items = get_interactables(*desired_focus_container);
+				auto it = std::find(items.begin(), items.end(), under_mouse.type_array[size_t(mouse_interactivity::focus_target)].node);
+				if(it != items.end())
+					index = int32_t(it - items.begin());
 			}
 
 			if(index == -1) {
@@ -5190,25 +6296,27 @@ bool root::on_mouse_move(layout_position p) {
 		repopulate_key_actions();
 	}();
 
-	bool positive_result = false;
-	for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
-		if(under_mouse.type_array[i].node) {
-			positive_result = true;
-		}
-	}
-
-	return positive_result;
+	last_mouse_move = make_mouse_move_key(p);
+	return mouse_over_ui();
 }
 
 
 bool root::on_mouse_lbutton(click_type t) {
+	begin_input_handler();
+	record(replay::entry{ .type = replay::entry_type::mouse_lbutton, .a = int32_t(t) });
+	// only what the click changes is redrawn: a focus change redraws the nodes gaining and losing it, and
+	// the node clicked is redrawn in case it shows its own state. A command that moves, shows or hides other
+	// nodes invalidates them itself, as code outside the root's passes must.
 	auto node = under_mouse.type_array[size_t(mouse_interactivity::button)].node;
 	auto felement = under_mouse.type_array[size_t(mouse_interactivity::focus_target)].node;
 	auto efn = effective_focus_target(node);
 	if(top_focus(focus_stack) != node && top_focus(focus_stack) != efn) {
 		set_window_focus(focus_tracker{ efn, -1, -1 });
 	}
+	if(last_mcommand_sent != mcommand::none)
+		invalidate_render(last_mcommand_target);
 	if(node) {
+		invalidate_render(node);
 		if(auto ei = node->get_interface(iface::editable_text); ei) {
 			auto iedit = static_cast<ieditable_text*>(ei);
 			auto rel_pos_base = latest_mouse_position - workspace_placement(*node);
@@ -5274,8 +6382,14 @@ bool root::on_mouse_lbutton(click_type t) {
 	return positive_result;
 }
 bool root::on_mouse_rbutton() {
+	begin_input_handler();
+	record(replay::entry{ .type = replay::entry_type::mouse_rbutton });
+	// redraws only what it changes, as on_mouse_lbutton does
 	auto node = under_mouse.type_array[size_t(mouse_interactivity::button)].node;
+	if(last_mcommand_sent != mcommand::none)
+		invalidate_render(last_mcommand_target);
 	if(node) {
+		invalidate_render(node);
 		if(auto ei = node->get_interface(iface::editable_text); ei) {
 		
 		} else {
@@ -5303,6 +6417,10 @@ bool root::on_mouse_rbutton() {
 	return positive_result;
 }
 bool root::on_mouse_lbutton_up() {
+	begin_input_handler();
+	record(replay::entry{ .type = replay::entry_type::mouse_lbutton_up });
+	if(last_mcommand_sent != mcommand::none)
+		invalidate_render(last_mcommand_target);
 	if(last_mcommand_sent == mcommand::alt) {
 		last_mcommand_target->on_rbutton_up(*this);
 		last_mcommand_sent = mcommand::none;
@@ -5321,6 +6439,10 @@ bool root::on_mouse_lbutton_up() {
 	return positive_result;
 }
 bool root::on_mouse_rbutton_up() {
+	begin_input_handler();
+	record(replay::entry{ .type = replay::entry_type::mouse_rbutton_up });
+	if(last_mcommand_sent != mcommand::none)
+		invalidate_render(last_mcommand_target);
 	if(last_mcommand_sent == mcommand::alt) {
 		last_mcommand_target->on_rbutton_up(*this);
 		last_mcommand_sent = mcommand::none;
@@ -5339,18 +6461,15 @@ bool root::on_mouse_rbutton_up() {
 	return positive_result;
 }
 bool root::on_mouse_scroll(float amount) {
+	begin_input_handler();
+	record(replay::entry{ .type = replay::entry_type::mouse_scroll, .amount = amount });
 	auto node = under_mouse.type_array[size_t(mouse_interactivity::scroll)].node;
 	if(node) {
+		invalidate_render(node);
 		node->on_scroll(*this, under_mouse.type_array[size_t(mouse_interactivity::scroll)].relative_location, int32_t(std::round(amount)));
 	}
 
-	bool positive_result = false;
-	for(size_t i = 0; i < size_t(mouse_interactivity::count); ++i) {
-		if(under_mouse.type_array[i].node) {
-			positive_result = true;
-		}
-	}
-	return positive_result;
+	return mouse_over_ui();
 }
 
 int32_t map_scancode_to_key(uint32_t in) {
@@ -5416,6 +6535,8 @@ int32_t key_to_scancode(int32_t in) {
 }
 
 bool root::on_key_down(uint32_t scancode, uint32_t vk_code, bool repeat) {
+	begin_input_handler();
+	record(replay::entry{ .type = replay::entry_type::key_down, .a = int32_t(scancode), .b = int32_t(vk_code), .c = repeat ? 1 : 0 });
 	if(repeat)
 		return true;
 
@@ -5425,6 +6546,7 @@ bool root::on_key_down(uint32_t scancode, uint32_t vk_code, bool repeat) {
 	auto efn = top_focus(focus_stack);
 	if(efn) {
 		if(auto ei = efn->get_interface(iface::editable_text); ei) {
+			invalidate_render(efn); // the system edits the text in response
 			return true;
 		}
 	}
@@ -5449,6 +6571,8 @@ bool root::on_key_down(uint32_t scancode, uint32_t vk_code, bool repeat) {
 
 	if(std::holds_alternative< interaction>(focus_actions.button_actions[k])) {
 		auto node = std::get<interaction>(focus_actions.button_actions[k]).node;
+		// as for a click, only the node and what the command invalidates are redrawn
+		invalidate_render(node);
 		if(alt_down) {
 			node->on_rbutton(*this, under_mouse.type_array[size_t(mouse_interactivity::button)].relative_location);
 			if(last_mcommand_sent == mcommand::alt) {
@@ -5487,6 +6611,8 @@ bool root::on_key_down(uint32_t scancode, uint32_t vk_code, bool repeat) {
 	return true;
 }
 bool root::on_key_up(uint32_t scancode, uint32_t vk_code) {
+	begin_input_handler();
+	record(replay::entry{ .type = replay::entry_type::key_up, .a = int32_t(scancode), .b = int32_t(vk_code) });
 	auto efn = top_focus(focus_stack);
 	if(efn) {
 		if(auto ei = efn->get_interface(iface::editable_text); ei) {
@@ -5494,6 +6620,9 @@ bool root::on_key_up(uint32_t scancode, uint32_t vk_code) {
 		}
 	}
 
+	// as for a click, only the node and what the command invalidates are redrawn
+	if(last_mcommand_sent != mcommand::none)
+		invalidate_render(last_mcommand_target);
 	if(last_mcommand_sent == mcommand::alt) {
 		last_mcommand_target->on_rbutton_up(*this);
 		last_mcommand_sent = mcommand::none;
@@ -5516,6 +6645,9 @@ bool root::on_key_up(uint32_t scancode, uint32_t vk_code) {
 
 void root::load_definitions(char const* data, size_t size) {
 	file_base = data;
+	lazy_definitions_resolved = false;
+	retained.clear();
+	invalidate_measurements(); // type ids may now mean other elements
 
 	serialization::in_buffer buf(data, size);
 
@@ -5523,10 +6655,11 @@ void root::load_definitions(char const* data, size_t size) {
 
 	for(uint32_t i = 0; i < num_sounds; ++i) {
 		sound_handle h{ int32_t(i) };
-		system.load_sound(h, buf.read<std::wstring_view>());
+		system.load_sound(h, buf.read<native_string_view>());
 	}
 
 	auto num_brush = buf.read<uint16_t>();
+	opaque_brushes.assign(num_brush, false);
 
 	for(uint16_t i = 0; i < num_brush; ++i) {
 		// regular slot
@@ -5535,9 +6668,10 @@ void root::load_definitions(char const* data, size_t size) {
 			if(color_brush) {
 				auto c = buf.read< brush_color>();
 				system.add_color_brush(i, c, false);
+				opaque_brushes[i] = c.a >= 1.0f;
 			} else {
 				auto c = buf.read< brush_color>();
-				system.add_image_color_brush(i, buf.read<std::wstring_view>(), c, false);
+				system.add_image_color_brush(i, buf.read<native_string_view>(), c, false);
 			}
 		}
 		// disabled slot
@@ -5546,9 +6680,11 @@ void root::load_definitions(char const* data, size_t size) {
 			if(color_brush) {
 				auto c = buf.read< brush_color>();
 				system.add_color_brush(i, c, true);
+				opaque_brushes[i] = opaque_brushes[i] && c.a >= 1.0f;
 			} else {
 				auto c = buf.read< brush_color>();
-				system.add_image_color_brush(i, buf.read<std::wstring_view>(), c, true);
+				system.add_image_color_brush(i, buf.read<native_string_view>(), c, true);
+				opaque_brushes[i] = false;
 			}
 		}
 		// highlights
@@ -5564,7 +6700,7 @@ void root::load_definitions(char const* data, size_t size) {
 		int32_t sub_index = buf.read<int16_t>();
 		auto x_ems = buf.read<em>();
 		auto y_ems = buf.read<em>();
-		auto fn = buf.read<std::wstring_view>();
+		auto fn = buf.read<native_string_view>();
 		bool is_svg = buf.read<bool>();
 		if(is_svg) {
 			system.add_svg_to_icon_slot(slot, fn, x_ems, y_ems, sub_index);
@@ -5579,11 +6715,12 @@ void root::load_definitions(char const* data, size_t size) {
 		int32_t sub_index = buf.read<int16_t>();
 		auto x_ems = buf.read<em>();
 		auto y_ems = buf.read<em>();
-		auto fn = buf.read<std::wstring_view>();
+		auto fn = buf.read<native_string_view>();
 		system.add_to_image_slot(slot, fn, x_ems, y_ems, sub_index);
 	}
 
 	defined_element_types = buf.read<uint32_t>();
+	free_nodes.resize(defined_element_types);
 	d_on_update.resize(defined_element_types, nullptr);
 	d_on_gain_focus.resize(defined_element_types, nullptr);
 	d_on_lose_focus.resize(defined_element_types, nullptr);
@@ -5644,12 +6781,12 @@ void root::load_definitions(char const* data, size_t size) {
 	d_info_brush = buf.read_fixed<uint16_t>(defined_element_types);
 
 	{
-		auto cspan = buf.read_fixed<decltype(d_fixed_children)::value_container_type>(d_fixed_children_content);
+		auto cspan = buf.read_fixed<decltype(d_fixed_children)::value_type>(d_fixed_children_content);
 		auto bspan = buf.read_fixed<decltype(d_fixed_children)::bucket_type>(d_fixed_children_buckets);
 		d_fixed_children = decltype(d_fixed_children)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_window_children)::value_container_type>(d_window_children_content);
+		auto cspan = buf.read_fixed<decltype(d_window_children)::value_type>(d_window_children_content);
 		auto bspan = buf.read_fixed<decltype(d_window_children)::bucket_type>(d_window_children_buckets);
 		d_window_children = decltype(d_window_children)(cspan, bspan);
 	}
@@ -5659,22 +6796,22 @@ void root::load_definitions(char const* data, size_t size) {
 	d_background_definition = buf.read_fixed<background_definition>(defined_element_types);
 
 	{
-		auto cspan = buf.read_fixed<decltype(d_divider_index)::value_container_type>(d_divider_index_content);
+		auto cspan = buf.read_fixed<decltype(d_divider_index)::value_type>(d_divider_index_content);
 		auto bspan = buf.read_fixed<decltype(d_divider_index)::bucket_type>(d_divider_index_buckets);
 		d_divider_index = decltype(d_divider_index)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_horizontal_orientation)::value_container_type>(d_horizontal_orientation_content);
+		auto cspan = buf.read_fixed<decltype(d_horizontal_orientation)::value_type>(d_horizontal_orientation_content);
 		auto bspan = buf.read_fixed<decltype(d_horizontal_orientation)::bucket_type>(d_horizontal_orientation_buckets);
 		d_horizontal_orientation = decltype(d_horizontal_orientation)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_column_properties)::value_container_type>(d_column_properties_content);
+		auto cspan = buf.read_fixed<decltype(d_column_properties)::value_type>(d_column_properties_content);
 		auto bspan = buf.read_fixed<decltype(d_column_properties)::bucket_type>(d_column_properties_buckets);
 		d_column_properties = decltype(d_column_properties)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_page_ui_definitions)::value_container_type>(d_page_ui_definitions_content);
+		auto cspan = buf.read_fixed<decltype(d_page_ui_definitions)::value_type>(d_page_ui_definitions_content);
 		auto bspan = buf.read_fixed<decltype(d_page_ui_definitions)::bucket_type>(d_page_ui_definitions_buckets);
 		d_page_ui_definitions = decltype(d_page_ui_definitions)(cspan, bspan);
 	}
@@ -5686,89 +6823,106 @@ void root::load_definitions(char const* data, size_t size) {
 		}
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_interaction_sound)::value_container_type>(d_interaction_sound_content);
+		auto cspan = buf.read_fixed<decltype(d_interaction_sound)::value_type>(d_interaction_sound_content);
 		auto bspan = buf.read_fixed<decltype(d_interaction_sound)::bucket_type>(d_interaction_sound_buckets);
 		d_interaction_sound = decltype(d_interaction_sound)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_image_information)::value_container_type>(d_image_information_content);
+		auto cspan = buf.read_fixed<decltype(d_image_information)::value_type>(d_image_information_content);
 		auto bspan = buf.read_fixed<decltype(d_image_information)::bucket_type>(d_image_information_buckets);
 		d_image_information = decltype(d_image_information)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_child_data_type)::value_container_type>(d_child_dt_content);
+		auto cspan = buf.read_fixed<decltype(d_child_data_type)::value_type>(d_child_dt_content);
 		auto bspan = buf.read_fixed<decltype(d_child_data_type)::bucket_type>(d_child_dt_buckets);
 		d_child_data_type = decltype(d_child_data_type)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_on_update_raw)::value_container_type>(d_on_update_raw_content);
+		auto cspan = buf.read_fixed<decltype(d_on_update_raw)::value_type>(d_on_update_raw_content);
 		auto bspan = buf.read_fixed<decltype(d_on_update_raw)::bucket_type>(d_on_update_raw_buckets);
 		d_on_update_raw = decltype(d_on_update_raw)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_on_gain_focus_raw)::value_container_type>(d_on_gain_focus_raw_content);
+		auto cspan = buf.read_fixed<decltype(d_on_gain_focus_raw)::value_type>(d_on_gain_focus_raw_content);
 		auto bspan = buf.read_fixed<decltype(d_on_gain_focus_raw)::bucket_type>(d_on_gain_focus_raw_buckets);
 		d_on_gain_focus_raw = decltype(d_on_gain_focus_raw)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_on_lose_focus_raw)::value_container_type>(d_on_lose_focus_raw_content);
+		auto cspan = buf.read_fixed<decltype(d_on_lose_focus_raw)::value_type>(d_on_lose_focus_raw_content);
 		auto bspan = buf.read_fixed<decltype(d_on_lose_focus_raw)::bucket_type>(d_on_lose_focus_raw_buckets);
 		d_on_lose_focus_raw = decltype(d_on_lose_focus_raw)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_on_visible_raw)::value_container_type>(d_on_visible_raw_content);
+		auto cspan = buf.read_fixed<decltype(d_on_visible_raw)::value_type>(d_on_visible_raw_content);
 		auto bspan = buf.read_fixed<decltype(d_on_visible_raw)::bucket_type>(d_on_visible_raw_buckets);
 		d_on_visible_raw = decltype(d_on_visible_raw)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_on_hide_raw)::value_container_type>(d_on_hide_raw_content);
+		auto cspan = buf.read_fixed<decltype(d_on_hide_raw)::value_type>(d_on_hide_raw_content);
 		auto bspan = buf.read_fixed<decltype(d_on_hide_raw)::bucket_type>(d_on_hide_raw_buckets);
 		d_on_hide_raw = decltype(d_on_hide_raw)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_on_create_raw)::value_container_type>(d_on_create_raw_content);
+		auto cspan = buf.read_fixed<decltype(d_on_create_raw)::value_type>(d_on_create_raw_content);
 		auto bspan = buf.read_fixed<decltype(d_on_create_raw)::bucket_type>(d_on_create_raw_buckets);
 		d_on_create_raw = decltype(d_on_create_raw)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_user_fn_a_raw)::value_container_type>(d_user_fn_a_raw_content);
+		auto cspan = buf.read_fixed<decltype(d_user_fn_a_raw)::value_type>(d_user_fn_a_raw_content);
 		auto bspan = buf.read_fixed<decltype(d_user_fn_a_raw)::bucket_type>(d_user_fn_a_raw_buckets);
 		d_user_fn_a_raw = decltype(d_user_fn_a_raw)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_user_fn_b_raw)::value_container_type>(d_user_fn_b_raw_content);
+		auto cspan = buf.read_fixed<decltype(d_user_fn_b_raw)::value_type>(d_user_fn_b_raw_content);
 		auto bspan = buf.read_fixed<decltype(d_user_fn_b_raw)::bucket_type>(d_user_fn_b_raw_buckets);
 		d_user_fn_b_raw = decltype(d_user_fn_b_raw)(cspan, bspan);
 	}
 	{
-		auto cspan = buf.read_fixed<decltype(d_user_mouse_fn_a_raw)::value_container_type>(d_user_mouse_fn_a_raw_content);
+		auto cspan = buf.read_fixed<decltype(d_user_mouse_fn_a_raw)::value_type>(d_user_mouse_fn_a_raw_content);
 		auto bspan = buf.read_fixed<decltype(d_user_mouse_fn_a_raw)::bucket_type>(d_user_mouse_fn_a_raw_buckets);
 		d_user_mouse_fn_a_raw = decltype(d_user_mouse_fn_a_raw)(cspan, bspan);
 	}
 }
 
+void invalidate_render(root& r, ui_node const& n) {
+	r.invalidate_render(&n);
+}
+
 bool node_is_visible(root& r, ui_node& n) {
-	if((n.behavior_flags & (behavior::functionally_hidden | behavior::visually_hidden)) != 0)
-		return false;
-	if(&n == r.node_repository[0].get())
-		return true;
-	if(!n.parent)
-		return false;
-	return node_is_visible(r, *n.parent);
+	return r.get_placement(n).visible;
 }
 
 void root::on_update() {
-	node_repository[0]->on_update(*this);
-
-	if(system.is_mouse_cursor_visible())
+	record(replay::entry{ .type = replay::entry_type::update });
+	needs_update = false;
+	// nothing is redrawn unless the pass changes it: functions that move, show or hide their own node are
+	// caught below, text providers report new text, and other changes go through invalidate_render
+	update_pass.run(*this, *node_repository[0], [&](uint32_t type_id) {
+		return [fn = get_on_update(type_id)](root& r, ui_node& n) {
+			auto position = n.position;
+			auto flags = n.behavior_flags;
+			fn(r, n);
+			if(position != n.position || flags != n.behavior_flags)
+				r.node_state_changed(n, flags);
+		};
+	});
+	// the last probe stands unless the pass reported a change, which drops it along with the placements
+	if(system.is_mouse_cursor_visible()) {
+		++unrecorded_depth;
 		on_mouse_move(latest_mouse_position);
+		--unrecorded_depth;
+	}
 }
 
 void root::on_workspace_resized(resize_type t, layout_position p) {
+	record(replay::entry{ .type = replay::entry_type::workspace_resized, .a = int32_t(t), .b = p.x.value, .c = p.y.value });
+	invalidate_all_rendering();
+	invalidate_layout();
 	if(t != resize_type::minimize) {
 		if(node_repository[0]->position.width != p.x || node_repository[0]->position.height != p.y) {
 			node_repository[0]->force_resize(*this, p);
 		}
+		needs_layout = false;
 	}
 }
 
@@ -5779,12 +6933,58 @@ em root::minimum_height() {
 	return node_repository[0]->minimum_height(*this);
 }
 
-layout_position root::workspace_placement(ui_node& n) {
-	layout_position running_total = layout_position{ n.position.x, n.position.y };
-	for(auto p = n.parent; p; p = p->parent) {
-		running_total = running_total + layout_position{ p->position.x, p->position.y };
+void root::node_state_changed(ui_node& n, uint32_t old_flags) {
+	constexpr uint32_t hidden = behavior::functionally_hidden | behavior::visually_hidden;
+
+	bool parent_visible = n.parent ? get_placement(*n.parent).visible : (!node_repository.empty() && &n == node_repository[0].get());
+	bool was_visible = parent_visible && (old_flags & hidden) == 0;
+	invalidate_render(&n);
+	bool is_visible = get_placement(n).visible;
+	if(was_visible && !is_visible)
+		n.on_hide(*this);
+	else if(!was_visible && is_visible)
+		n.on_visible(*this);
+}
+
+root::cached_placement root::get_placement(ui_node& n) {
+	constexpr uint32_t hidden = behavior::functionally_hidden | behavior::visually_hidden;
+
+	// layout workers share the root, so they walk the chain instead of using the cache
+	if(in_parallel_layout) {
+		cached_placement result{ .at = content_position{ }, .visible = (n.behavior_flags & hidden) == 0 };
+		ui_node const* top = &n;
+		for(auto p = n.parent; p; p = p->parent) {
+			result.at = result.at + p->child_content_offset(*top);
+			if((p->behavior_flags & hidden) != 0)
+				result.visible = false;
+			top = p;
+		}
+		result.at = result.at + layout_position{ top->position.x, top->position.y };
+		if(top != node_repository[0].get())
+			result.visible = false;
+		return result;
+	}
+
+	if(auto it = placements.find(&n); it != placements.end() && it->second.generation == placement_generation)
+		return it->second;
+
+	cached_placement result{ .at = to_content(layout_position{ n.position.x, n.position.y }), .visible = (n.behavior_flags & hidden) == 0, .generation = placement_generation };
+	if(n.parent) {
+		auto base = get_placement(*n.parent);
+		result.at = base.at + n.parent->child_content_offset(n);
+		result.visible = result.visible && base.visible;
+	} else if(node_repository.empty() || &n != node_repository[0].get()) {
+		result.visible = false;
 	}
-	return running_total;
+	// the recursion may have grown the map, so the entry is looked up again
+	placements.insert_or_assign(&n, result);
+	return result;
+}
+content_position root::workspace_content_placement(ui_node& n) {
+	return get_placement(n).at;
+}
+layout_position root::workspace_placement(ui_node& n) {
+	return to_layout(workspace_content_placement(n));
 }
 
 void root::make_base_element() {
@@ -5,10 +5,14 @@
 #include <string_view>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <variant>
 #include <optional>
 #include <chrono>
 #include <array>
+#include <span>
+#include <algorithm>
+#include <type_traits>
 
 namespace minui {
 
@@ -185,7 +189,7 @@ struct metrics {
 	uint32_t bidiLevel;
 };
 struct hit_test_metrics {
-	metrics metrics;
+	text::metrics metrics;
 	bool is_inside;
 	bool is_trailing;
 };
@@ -245,6 +249,12 @@ enum class input_mode {
 enum class prompt_mode {
 	hidden, keyboard, controller
 };
+enum class click_type {
+	singlec, doublec, triplec
+};
+enum class resize_type {
+	minimize, maximize, normal
+};
 enum class animation_type : uint8_t {
 	fade, slide, flip, none
 };
@@ -311,24 +321,64 @@ struct em {
 	int16_t value = 0; // fixed point sizes in terms of 100ths of an em
 	auto operator<=>(em const& o) const noexcept = default;
 };
+// arithmetic on em is done in 32 bits and clamped, so results out of range stick at the edge instead of wrapping
+inline em saturate_em(int32_t v) noexcept {
+	return em{ int16_t(v < INT16_MIN ? INT16_MIN : (v > INT16_MAX ? INT16_MAX : v)) };
+}
 inline em operator+(em a, em b) noexcept {
-	return em{ int16_t(a.value + b.value) };
+	return saturate_em(int32_t(a.value) + int32_t(b.value));
 }
 inline em operator-(em a, em b) noexcept {
-	return em{ int16_t(a.value - b.value) };
+	return saturate_em(int32_t(a.value) - int32_t(b.value));
 }
 inline em operator+(em a, int32_t b) noexcept {
-	return em{ int16_t(a.value + b * 100) };
+	return saturate_em(int32_t(a.value) + b * 100);
 }
 inline em operator-(em a, int32_t b) noexcept {
-	return em{ int16_t(a.value - b * 100) };
+	return saturate_em(int32_t(a.value) - b * 100);
 }
 inline em operator*(em a, int32_t b) noexcept {
-	return em{ int16_t(a.value * b) };
+	return saturate_em(int32_t(a.value) * b);
 }
 inline em operator/(em a, int32_t b) noexcept {
 	return em{ int16_t(a.value / b) };
 }
+// a * numerator / denominator without overflowing the intermediate product
+inline em scale_em(em a, int32_t numerator, int32_t denominator) noexcept {
+	return saturate_em(int32_t(a.value) * numerator / denominator);
+}
+
+// em sized for positions within content that may extend far beyond the visible area, such as
+// the placement of an element relative to the workspace; sizes and stored positions remain em
+struct content_em {
+	int32_t value = 0; // 100ths of an em
+	auto operator<=>(content_em const& o) const noexcept = default;
+};
+inline content_em to_content(em v) noexcept {
+	return content_em{ v.value };
+}
+inline em to_em(content_em v) noexcept {
+	return saturate_em(v.value);
+}
+inline content_em operator+(content_em a, content_em b) noexcept {
+	return content_em{ a.value + b.value };
+}
+inline content_em operator-(content_em a, content_em b) noexcept {
+	return content_em{ a.value - b.value };
+}
+inline content_em operator+(content_em a, em b) noexcept {
+	return content_em{ a.value + b.value };
+}
+inline content_em operator-(content_em a, em b) noexcept {
+	return content_em{ a.value - b.value };
+}
+inline content_em operator*(content_em a, int32_t b) noexcept {
+	return content_em{ a.value * b };
+}
+inline content_em operator/(content_em a, int32_t b) noexcept {
+	return content_em{ a.value / b };
+}
+
 struct layout_position {
 	em x;
 	em y;
@@ -340,11 +390,33 @@ inline layout_position operator-(layout_position a, layout_position b) noexcept
 	return layout_position{ a.x - b.x, a.y - b.y };
 }
 
+struct content_position {
+	content_em x;
+	content_em y;
+};
+inline content_position to_content(layout_position p) noexcept {
+	return content_position{ to_content(p.x), to_content(p.y) };
+}
+inline layout_position to_layout(content_position p) noexcept {
+	return layout_position{ to_em(p.x), to_em(p.y) };
+}
+inline content_position operator+(content_position a, content_position b) noexcept {
+	return content_position{ a.x + b.x, a.y + b.y };
+}
+inline content_position operator-(content_position a, content_position b) noexcept {
+	return content_position{ a.x - b.x, a.y - b.y };
+}
+inline content_position operator+(content_position a, layout_position b) noexcept {
+	return content_position{ a.x + b.x, a.y + b.y };
+}
+
 struct layout_rect {
 	em x;
 	em y;
 	em width;
 	em height;
+
+	bool operator==(layout_rect const&) const = default;
 };
 inline layout_rect operator+(layout_rect a, layout_position b) noexcept {
 	return layout_rect{ a.x + b.x, a.y + b.y, a.width, a.height };
@@ -352,6 +424,26 @@ inline layout_rect operator+(layout_rect a, layout_position b) noexcept {
 inline layout_rect operator-(layout_rect a, layout_position b) noexcept {
 	return layout_rect{ a.x - b.x, a.y - b.y, a.width, a.height };
 }
+inline bool intersects(layout_rect a, layout_rect b) noexcept {
+	return int32_t(a.x.value) < int32_t(b.x.value) + b.width.value && int32_t(b.x.value) < int32_t(a.x.value) + a.width.value
+		&& int32_t(a.y.value) < int32_t(b.y.value) + b.height.value && int32_t(b.y.value) < int32_t(a.y.value) + a.height.value;
+}
+inline bool contains(layout_rect outer, layout_rect inner) noexcept {
+	return outer.x <= inner.x && outer.y <= inner.y
+		&& int32_t(inner.x.value) + inner.width.value <= int32_t(outer.x.value) + outer.width.value
+		&& int32_t(inner.y.value) + inner.height.value <= int32_t(outer.y.value) + outer.height.value;
+}
+inline bool contains(layout_rect r, layout_position p) noexcept {
+	return r.x <= p.x && r.y <= p.y && int32_t(p.x.value) < int32_t(r.x.value) + r.width.value && int32_t(p.y.value) < int32_t(r.y.value) + r.height.value;
+}
+// empty (zero width or height) if the rectangles do not overlap
+inline layout_rect intersection(layout_rect a, layout_rect b) noexcept {
+	auto x0 = std::max(int32_t(a.x.value), int32_t(b.x.value));
+	auto y0 = std::max(int32_t(a.y.value), int32_t(b.y.value));
+	auto x1 = std::min(int32_t(a.x.value) + a.width.value, int32_t(b.x.value) + b.width.value);
+	auto y1 = std::min(int32_t(a.y.value) + a.height.value, int32_t(b.y.value) + b.height.value);
+	return layout_rect{ saturate_em(x0), saturate_em(y0), saturate_em(std::max(x1 - x0, 0)), saturate_em(std::max(y1 - y0, 0)) };
+}
 
 struct animation_description {
 	screen_space_rect animated_region;
@@ -377,7 +469,7 @@ struct animation_status_struct {
 
 struct interactable_state {
 private:
-	uint8_t data = 0ui8;
+	uint8_t data = uint8_t(0);
 	struct impl_key_type {
 	};
 	struct impl_group_type {
@@ -388,7 +480,7 @@ public:
 	constexpr static impl_group_type group{ };
 	constexpr static impl_key_type key{ };
 
-	interactable_state() : data(0ui8) {
+	interactable_state() : data(uint8_t(0)) {
 	}
 	interactable_state(impl_group_type, uint8_t v) {
 		data = uint8_t((0x1F & v) | 0x40);
@@ -408,6 +500,7 @@ public:
 	bool holds_data() const {
 		return (0xE0 & data) != 0x00;
 	}
+	bool operator==(interactable_state const&) const = default;
 };
 
 enum class interactable_orientation : uint8_t {
@@ -441,7 +534,9 @@ struct sound_handle {
 };
 
 class ui_node;
+class root;
 class system_interface;
+class monotype_data_source;
 
 enum class rendering_modifiers : uint8_t {
 	none,
@@ -484,6 +579,18 @@ public:
 	}
 	virtual void add_item(void const* data) = 0;
 	virtual void clear_contents() = 0;
+	// replaces the contents with count items of item_size bytes stored contiguously starting at first; returns
+	// false, leaving the contents as they were, if item_size is not the size of the column's item data type
+	virtual bool set_items(void const* first, size_t count, size_t item_size) = 0;
+	template<typename T>
+	bool set_items(std::span<T const> items) {
+		static_assert(std::is_trivially_copyable_v<T>, "rows receive their items by copying bytes");
+		return set_items(static_cast<void const*>(items.data()), items.size(), sizeof(T));
+	}
+	// reads items in place from source until cleared or replaced; source must outlive the binding
+	virtual void set_data_source(monotype_data_source const* source) = 0;
+	// item currently bound to a visible row, or nullptr
+	virtual void const* get_item(ui_node const& row) const = 0;
 };
 class istatic_text : public iface_base {
 public:
@@ -514,7 +621,7 @@ public:
 	virtual int32_t get_number_of_text_lines(system_interface&) = 0;
 	virtual int32_t get_starting_display_line() = 0;
 	virtual em get_single_line_width(system_interface&) = 0;
-	virtual void set_starting_display_line(int32_t v) = 0;
+	virtual void set_starting_display_line(system_interface& s, int32_t v) = 0;
 	virtual em get_line_height(system_interface&) = 0;
 	virtual void resize_to_width(system_interface& s, int32_t w) = 0;
 
@@ -560,6 +667,8 @@ public:
 	virtual void consume_mouse_event(system_interface& win, int32_t x, int32_t y, uint32_t buttons) = 0;
 };
 
+// measurement functions (get_single_line_width, get_line_height, get_number_of_text_lines, resize_to_width)
+// may be called concurrently on distinct providers during a parallel layout pass
 class static_text_provider : public istatic_text {
 public:
 	virtual ~static_text_provider() = 0;
@@ -568,6 +677,8 @@ class editable_text_provider : public ieditable_text {
 public:
 	virtual ~editable_text_provider() = 0;
 };
+inline static_text_provider::~static_text_provider() { }
+inline editable_text_provider::~editable_text_provider() { }
 
 class file {
 public:
@@ -587,6 +698,22 @@ public:
 	virtual ~directory() { }
 };
 
+enum class primitive_type : uint8_t {
+	rectangle, empty_rectangle, icon, image, background, line_highlight_mode, text, clip
+};
+// one draw call as plain data; fields that a type does not use keep their defaults
+struct draw_primitive {
+	screen_space_rect rect{ 0, 0, 0, 0 };
+	layout_rect layout{ }; // background interior, or text bounds
+	istatic_text* text = nullptr;
+	int32_t handle = -1; // icon or image
+	int32_t sub_slot = 0;
+	uint16_t brush = 0;
+	primitive_type type = primitive_type::rectangle;
+	rendering_modifiers display_flags = rendering_modifiers::none;
+	bool flag = false; // highlight mode on, text in focus, or clipping on
+};
+
 class system_interface {
 public:
 	virtual void register_root(root& r) = 0;
@@ -624,6 +751,10 @@ public:
 	// FILE FUNCTIONS
 	virtual std::unique_ptr<directory> get_root_directory() = 0;
 
+	// SCHEDULING FUNCTIONS
+	// may be called from any thread: wakes the host loop, which then asks the root for an update
+	virtual void post_update_request() = 0;
+
 	// SOUND FUNCTIONS
 	virtual void  load_sound(sound_handle, native_string_view file_name) = 0;
 	virtual void play_sound(sound_handle) = 0;
@@ -681,6 +812,13 @@ public:
 	virtual void background(image_handle img, uint16_t brush, screen_space_rect, layout_rect interior, rendering_modifiers display_flags = rendering_modifiers::none, int32_t sub_slot = 0) = 0;
 	virtual void icon(icon_handle ico, screen_space_rect, uint16_t br, rendering_modifiers display_flags = rendering_modifiers::none, int32_t sub_slot = 0) = 0;
 	virtual void set_line_highlight_mode(bool highlight_on) = 0;
+	// restricts drawing to the rectangle until the next call; clip_on = false draws everywhere again
+	virtual void set_clip(screen_space_rect r, bool clip_on) = 0;
+	// called during each render, before any primitives are submitted, with the areas that changed since the
+	// previous one; empty if nothing did
+	virtual void set_damaged_regions(std::span<const screen_space_rect> regions) = 0;
+	// draws the primitives in order; the default issues one call per primitive
+	virtual void submit_primitives(std::span<const draw_primitive> primitives);
 
 	
 	virtual void stop_ui_animations() = 0;
@@ -701,6 +839,37 @@ public:
 	virtual void set_brush_highlights(uint16_t id, float line_shading, float highlight_shading, float line_highlight_shading) = 0;
 };
 
+inline void system_interface::submit_primitives(std::span<const draw_primitive> primitives) {
+	for(auto& p : primitives) {
+		switch(p.type) {
+			case primitive_type::rectangle:
+				rectangle(p.rect, p.display_flags, p.brush);
+				break;
+			case primitive_type::empty_rectangle:
+				empty_rectangle(p.rect, p.display_flags, p.brush);
+				break;
+			case primitive_type::icon:
+				icon(icon_handle{ p.handle }, p.rect, p.brush, p.display_flags, p.sub_slot);
+				break;
+			case primitive_type::image:
+				image(image_handle{ p.handle }, p.rect, p.sub_slot);
+				break;
+			case primitive_type::background:
+				background(image_handle{ p.handle }, p.brush, p.rect, p.layout, p.display_flags, p.sub_slot);
+				break;
+			case primitive_type::line_highlight_mode:
+				set_line_highlight_mode(p.flag);
+				break;
+			case primitive_type::text:
+				p.text->render(*this, p.layout, p.brush, p.display_flags, p.flag);
+				break;
+			case primitive_type::clip:
+				set_clip(p.rect, p.flag);
+				break;
+		}
+	}
+}
+
 namespace behavior {
 
 constexpr inline uint32_t focus_free = 0x00000000; // lose focus if mouse leaves
@@ -731,6 +900,9 @@ constexpr inline uint32_t interaction_info = 0x00010000; // takes a right click
 constexpr inline uint32_t interaction_focus = 0x00020000; // takes a mouse hover / shift click / expand-or-take-focus action
 constexpr inline uint32_t interaction_hold = 0x00040000; // wants to know if the click/interaction is sustained (wants a start and end message)
 
+constexpr inline uint32_t layout_uniform_size = 0x00080000; // size does not depend on the element's data, so one measurement may serve it whatever it shows
+constexpr inline uint32_t update_batched = 0x00100000; // on_update may run with the other elements of its type, after the depth first pass, see update_scheduler
+
 constexpr inline uint32_t interaction_flagged = 0x80000000; // set if the element is currently labeled with an interactable tag
 
 }
@@ -739,6 +911,18 @@ struct postponed_render {
 	ui_node* n;
 	layout_position offset;
 };
+// pop-ups waiting to be drawn or probed after the rest of the tree; backed by the root's per frame memory
+using postponed_list = std::pmr::vector<postponed_render>;
+
+// what a node needs from an update pass; see ui_node::begin_update
+enum class update_mode : uint8_t {
+	skip, // nothing, for the node or its subtree
+	with_function, // its type's on_update function, then update_children
+	no_function, // only update_children
+	whole_subtree // on_update, which updates the subtree itself
+};
+// the children an update continues with
+using update_list = std::pmr::vector<ui_node*>;
 
 class root;
 
@@ -763,34 +947,93 @@ struct probe_result {
 	std::array<sub_result, size_t(mouse_interactivity::count)> type_array;
 };
 
-class type_erased_vector {
+class monotype_data_source {
 public:
-	virtual void const* operator[](size_t index) const = 0;
 	virtual size_t size() const = 0;
+	virtual void const* element(size_t index) const = 0;
+	// must change whenever the contents change
+	virtual uint64_t version() const = 0;
+	// optional per item version; 0 means the item's bytes are compared instead
+	virtual uint64_t element_version(size_t /*index*/) const {
+		return 0;
+	}
+	virtual ~monotype_data_source() { }
+};
+
+class type_erased_vector : public monotype_data_source {
+public:
+	virtual void const* operator[](size_t index) const = 0;
 	virtual void pop_back() = 0;
 	virtual void push_back(void const* v) = 0;
+	virtual void assign(void const* first, size_t count) = 0;
 	virtual void clear() = 0;
+	virtual size_t element_size() const = 0;
 	virtual ~type_erased_vector() { }
 };
 
 template<typename T>
 class type_erased_vector_impl : public type_erased_vector {
 	std::vector<T> contents;
+	uint64_t contents_version = 0;
 public:
 	void const* operator[](size_t index) const final {
 		return reinterpret_cast<void const*>(&contents[index]);
 	}
+	void const* element(size_t index) const final {
+		return reinterpret_cast<void const*>(&contents[index]);
+	}
 	size_t size() const final {
 		return contents.size();
 	}
+	uint64_t version() const final {
+		return contents_version;
+	}
 	void pop_back() final {
 		contents.pop_back();
+		++contents_version;
 	}
 	void push_back(void const* v) final {
 		contents.push_back(*reinterpret_cast<T const*>(v));
+		++contents_version;
+	}
+	void assign(void const* first, size_t count) final {
+		auto f = reinterpret_cast<T const*>(first);
+		contents.assign(f, f + count);
+		++contents_version;
 	}
 	void clear() final {
 		contents.clear();
+		++contents_version;
+	}
+	size_t element_size() const final {
+		return sizeof(T);
+	}
+};
+
+// exposes a caller-owned array without copying it; call touch() after modifying the array
+template<typename T>
+class span_data_source : public monotype_data_source {
+	std::span<T const> contents;
+	uint64_t contents_version = 0;
+public:
+	span_data_source() = default;
+	span_data_source(std::span<T const> contents) : contents(contents) { }
+
+	void reset(std::span<T const> c) {
+		contents = c;
+		++contents_version;
+	}
+	void touch() {
+		++contents_version;
+	}
+	size_t size() const final {
+		return contents.size();
+	}
+	void const* element(size_t index) const final {
+		return reinterpret_cast<void const*>(&contents[index]);
+	}
+	uint64_t version() const final {
+		return contents_version;
 	}
 };
 
@@ -805,51 +1048,70 @@ public:
 	layout_rect position;
 	
 	virtual size_t size() const = 0;
-	virtual void render(root& r, layout_position offset, std::vector<postponed_render>& postponed) = 0;
+	virtual void render(root& r, layout_position offset, postponed_list& postponed) = 0;
 	virtual uint32_t child_count() const {
 		return 0;
 	}
-	virtual ui_node* get_child(uint32_t index) const {
+	virtual ui_node* get_child(uint32_t /*index*/) const {
 		return nullptr;
 	}
+	// Where a child sits within this node's content. Containers whose content may reach beyond the em
+	// range keep the exact offset and return it here; the child's position holds it clamped.
+	virtual content_position child_content_offset(ui_node const& child) const {
+		return to_content(layout_position{ child.position.x, child.position.y });
+	}
 	virtual page_information get_page_information() {
 		return page_information{ 0, 0 };
 	}
-	virtual void change_page(root& r, int32_t new_page) { }
+	virtual void change_page(root& /*r*/, int32_t /*new_page*/) { }
 	
-	virtual void force_resize(root& r, layout_position size) { // forces both dimensions
+	// When parallel layout is enabled (root::set_layout_threads), containers may run force_resize, resize,
+	// minimum_width and minimum_height on sibling subtrees at the same time. An implementation may then only
+	// modify its own subtree, may create or release nodes only through root, and may only make measurement
+	// calls on its own text provider. Updates, which run user functions (e.g. binding rows), go through
+	// root::run_after_parallel_layout so that they run on the calling thread.
+	virtual void force_resize(root& /*r*/, layout_position size) { // forces both dimensions
 		position.width = size.x;
 		position.height = size.y;
 	}
-	virtual void resize(root& r, layout_position maximum_space, em desired_width, em desired_height) { // -1 for don't care
+	virtual void resize(root& /*r*/, layout_position /*maximum_space*/, em desired_width, em desired_height) { // -1 for don't care
 		if(desired_width.value != -1) position.width = desired_width;
 		if(desired_height.value != -1) position.height = desired_height;
 	}
-	virtual em minimum_width(root& r) {
+	virtual em minimum_width(root& /*r*/) {
 		return em{ 0 };
 	}
-	virtual em minimum_height(root& r) {
+	virtual em minimum_height(root& /*r*/) {
 		return em{ 0 };
 	}
 	
-	virtual probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, std::vector<postponed_render>& postponed) = 0;
+	virtual probe_result mouse_probe(root& r, layout_position probe_pos, layout_position offset, postponed_list& postponed) = 0;
 	virtual interactable_result interactable_layout(root& r) = 0;
-	virtual void on_lbutton(root& r, layout_position pos) { }
-	virtual void on_rbutton(root& r, layout_position pos) { }
-	virtual void on_lbutton_up(root& r) { }
-	virtual void on_rbutton_up(root& r) { }
-	virtual void on_scroll(root& r, layout_position pos, int32_t amount) { }
-	virtual void on_mouse_enter(root& r) { }
-	virtual void on_mouse_leave(root& r) { }
-	virtual void on_gain_focus(root& r) { }
-	virtual void on_lose_focus(root& r) { }
-	virtual void on_visible(root& r) { }
-	virtual void on_hide(root& r) { }
+	virtual void on_lbutton(root& /*r*/, layout_position /*pos*/) { }
+	virtual void on_rbutton(root& /*r*/, layout_position /*pos*/) { }
+	virtual void on_lbutton_up(root& /*r*/) { }
+	virtual void on_rbutton_up(root& /*r*/) { }
+	virtual void on_scroll(root& /*r*/, layout_position /*pos*/, int32_t /*amount*/) { }
+	virtual void on_mouse_enter(root& /*r*/) { }
+	virtual void on_mouse_leave(root& /*r*/) { }
+	virtual void on_gain_focus(root& /*r*/) { }
+	virtual void on_lose_focus(root& /*r*/) { }
+	virtual void on_visible(root& /*r*/) { }
+	virtual void on_hide(root& /*r*/) { }
 	virtual void on_update(root& r) = 0;
-	virtual void on_create(root& r) { }
-	virtual void on_reload(root& r) { } // used to force a reload of text in case of system-wide font / locale changes
-	virtual void on_text_update(root& r) { } // called after a modifying function is applied to the edit interface
-	virtual iface_base* get_interface(iface v) {
+	// The root's update pass is split into steps so that it can set aside the nodes of types with
+	// behavior::update_batched and run each such type's on_update function over all of them together (see
+	// update_scheduler). begin_update says what the node needs before its function runs; update_children
+	// does the rest of the node's update once it has, and adds the children to update next. A node that keeps
+	// the default is updated by its on_update.
+	virtual update_mode begin_update(root& /*r*/) {
+		return update_mode::whole_subtree;
+	}
+	virtual void update_children(root& /*r*/, update_list& /*children*/) { }
+	virtual void on_create(root& /*r*/) { }
+	virtual void on_reload(root& /*r*/) { } // used to force a reload of text in case of system-wide font / locale changes
+	virtual void on_text_update(root& /*r*/) { } // called after a modifying function is applied to the edit interface
+	virtual iface_base* get_interface(iface /*v*/) {
 		return nullptr;
 	}
 	
@@ -895,8 +1157,8 @@ struct relative_child_range {
 };
 struct background_definition {
 	image_handle image; // if -1, use brush instead
-	layout_rect exterior_edge_offsets;
-	layout_rect texture_interior_region;
+	layout_rect exterior_edge_offsets{ };
+	layout_rect texture_interior_region{ };
 	uint16_t brush; // if -1, transparent
 	uint8_t left_border = 0;
 	uint8_t right_border = 0;
@@ -922,6 +1184,10 @@ struct page_ui_definitions {
 	uint16_t text = 0;
 	bool vertical_arrangement = false;
 };
+struct array_reference {
+	uint32_t file_offset;
+	uint32_t count;
+};
 struct saved_text_information {
 	layout_rect margins;
 	array_reference default_text_key;
@@ -944,6 +1210,8 @@ struct text_information {
 	text_information() noexcept = default;
 	text_information(text_information const&) noexcept = default;
 	text_information(text_information&&) noexcept = default;
+	text_information& operator=(text_information const&) noexcept = default;
+	text_information& operator=(text_information&&) noexcept = default;
 	text_information(saved_text_information const& i) : margins(i.margins), default_text_key(i.default_text_key), font(i.font), minimum_space(i.minimum_space), alignment(i.alignment), multiline(i.multiline), text_resolved(false) {}
 
 };
@@ -961,10 +1229,6 @@ struct child_data_type {
 	uint16_t data_type;
 	uint16_t child_control_type;
 };
-struct array_reference {
-	uint32_t file_offset;
-	uint32_t count;
-};
 
 using user_function = void (*)(root& r, ui_node&);
 
@@ -974,6 +1238,8 @@ void run_datatype_constructor(char* address, uint32_t data_type_id);
 void run_datatype_destructor(char* address, uint32_t data_type_id);
 std::unique_ptr<type_erased_vector> make_vector_of(uint32_t data_type_id);
 user_function lookup_function(std::string_view name);
+// for what the system owns on a node's behalf, such as its text: the node now draws differently
+void invalidate_render(root& r, ui_node const& n);
 
 namespace impl { // to be wrapped in a generated hpp file mapping to the appropriate types
 char* get_local_data(root& r, ui_node*, uint32_t data_type);
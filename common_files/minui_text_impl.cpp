@@ -12,10 +12,14 @@
 #include <optional>
 #include <chrono>
 #include <array>
-#include <icu.h>
 #include <assert.h>
 
+#ifdef _WIN32
+#include <icu.h>
 #pragma comment(lib, "icu.lib")
+#else
+#include <unicode/uchar.h>
+#endif
 
 namespace minui {
 namespace text {
@@ -774,6 +778,41 @@ bool requires_surrogate_pair(uint32_t codepoint) {
 	return codepoint >= 0x10000;
 }
 
+// appends the codepoint as UTF-16 or UTF-8, whichever native text is, and returns the code units added
+uint32_t append_codepoint(std::vector<native_char>& text, uint32_t codepoint) {
+	if constexpr(sizeof(native_char) == 1) {
+		if(codepoint < 0x80) {
+			text.push_back(native_char(codepoint));
+			return 1;
+		} else if(codepoint < 0x800) {
+			text.push_back(native_char(0xC0 | (codepoint >> 6)));
+			text.push_back(native_char(0x80 | (codepoint & 0x3F)));
+			return 2;
+		} else if(codepoint < 0x10000) {
+			text.push_back(native_char(0xE0 | (codepoint >> 12)));
+			text.push_back(native_char(0x80 | ((codepoint >> 6) & 0x3F)));
+			text.push_back(native_char(0x80 | (codepoint & 0x3F)));
+			return 3;
+		} else {
+			text.push_back(native_char(0xF0 | (codepoint >> 18)));
+			text.push_back(native_char(0x80 | ((codepoint >> 12) & 0x3F)));
+			text.push_back(native_char(0x80 | ((codepoint >> 6) & 0x3F)));
+			text.push_back(native_char(0x80 | (codepoint & 0x3F)));
+			return 4;
+		}
+	} else {
+		if(requires_surrogate_pair(codepoint)) {
+			auto p = make_surrogate_pair(codepoint);
+			text.push_back(native_char(p.high));
+			text.push_back(native_char(p.low));
+			return 2;
+		} else {
+			text.push_back(native_char(codepoint));
+			return 1;
+		}
+	}
+}
+
 bool cursor_ignorable16(uint16_t at_position, uint16_t trailing) {
 	if(at_position >= 0xDC00 && at_position <= 0xDFFF) {
 		return false; // low surrogate
@@ -1286,57 +1325,35 @@ body_result process_body_data(backing_arrays& container, char const* start, char
 					std::string temp(char_name);
 					uint32_t val = std::strtoul(temp.c_str(), nullptr, 0);
 
-					if(!requires_surrogate_pair(val)) {
-						++utf16_codepoint_index;
-						container.text_data.push_back(wchar_t(val));
-					} else {
-						utf16_codepoint_index += 2;
-						auto p = make_surrogate_pair(val);
-						container.text_data.push_back(wchar_t(p.high));
-						container.text_data.push_back(wchar_t(p.low));
-					}
+					utf16_codepoint_index += append_codepoint(container.text_data, val);
 				} else if(char_name == "em-space") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2003));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2003);
 				} else if(char_name == "en-space") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2002));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2002);
 				} else if(char_name == "3rd-em") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2004));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2004);
 				} else if(char_name == "4th-em") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2005));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2005);
 				} else if(char_name == "6th-em") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2006));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2006);
 				} else if(char_name == "thin-space") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2009));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2009);
 				} else if(char_name == "hair-space") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x200A));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x200A);
 				} else if(char_name == "figure-space") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2007));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2007);
 				} else if(char_name == "ideo-space") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x3000));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x3000);
 				} else if(char_name == "hyphen") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2010));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2010);
 				} else if(char_name == "figure-dash") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2012));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2012);
 				} else if(char_name == "en-dash") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2013));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2013);
 				} else if(char_name == "em-dash") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2014));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2014);
 				} else if(char_name == "minus") {
-					++utf16_codepoint_index;
-					container.text_data.push_back(wchar_t(0x2212));
+					utf16_codepoint_index += append_codepoint(container.text_data, 0x2212);
 				} else {
 					++utf16_codepoint_index;
 					container.text_data.push_back(L'?');
@@ -1425,15 +1442,7 @@ body_result process_body_data(backing_arrays& container, char const* start, char
 				}
 			}
 		} else {
-			if(requires_surrogate_pair(c)) {
-				auto sp = make_surrogate_pair(c);
-				container.text_data.push_back(wchar_t(sp.high));
-				container.text_data.push_back(wchar_t(sp.low));
-				utf16_codepoint_index += 2;
-			} else {
-				++utf16_codepoint_index;
-				container.text_data.push_back(wchar_t(c));
-			}
+			utf16_codepoint_index += append_codepoint(container.text_data, c);
 		}
 	} // while start < end
 
@@ -85,6 +85,7 @@ void populate_with_file_content(backing_arrays& container, char const* start, ch
 void reset(backing_arrays& container);
 formatted_text perform_substitutions(backing_arrays& container, std::array<text::attribute_type, text::max_attributes> const& lookup, text::text_source body_text, text::text_source const* parameters, size_t parameter_count);
 handle lookup_entry(backing_arrays& container, std::string_view name);
+text::variable get_variable(backing_arrays& container, std::string_view name);
 
 }
 }
@@ -0,0 +1,648 @@
+#include "software_rasterizer.hpp"
+
+#include <stdint.h>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MINUI_RASTER_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MINUI_RASTER_SSE2 1
+#endif
+
+namespace minui {
+namespace headless {
+
+namespace {
+
+// x / 255 rounded, exact for x <= 255 * 255
+inline uint32_t div255(uint32_t x) {
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+inline uint32_t over(uint32_t d, uint32_t s) {
+	uint32_t inv = 255 - (s >> 24);
+	uint32_t result = 0;
+	for(uint32_t shift = 0; shift < 32; shift += 8) {
+		uint32_t c = ((s >> shift) & 0xFF) + div255(((d >> shift) & 0xFF) * inv);
+		result |= std::min(c, uint32_t(255)) << shift;
+	}
+	return result;
+}
+inline uint32_t scale(uint32_t color, uint32_t coverage) {
+	uint32_t result = 0;
+	for(uint32_t shift = 0; shift < 32; shift += 8)
+		result |= div255(((color >> shift) & 0xFF) * coverage) << shift;
+	return result;
+}
+
+#ifdef MINUI_RASTER_SSE2
+inline __m128i div255_epi16(__m128i x) {
+	auto t = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+// two premultiplied pixels as 16 bit lanes
+inline __m128i over_epi16(__m128i dest, __m128i source) {
+	auto alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, 0xFF), 0xFF);
+	auto inv = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+	return _mm_add_epi16(source, div255_epi16(_mm_mullo_epi16(dest, inv)));
+}
+#endif
+#ifdef MINUI_RASTER_AVX2
+inline __m256i div255_epi16(__m256i x) {
+	auto t = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+inline __m256i over_epi16(__m256i dest, __m256i source) {
+	auto alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(source, 0xFF), 0xFF);
+	auto inv = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+	return _mm256_add_epi16(source, div255_epi16(_mm256_mullo_epi16(dest, inv)));
+}
+#endif
+
+screen_space_rect intersect(screen_space_rect a, screen_space_rect b) {
+	auto x0 = std::max(a.x, b.x);
+	auto y0 = std::max(a.y, b.y);
+	auto x1 = std::min(a.x + a.width, b.x + b.width);
+	auto y1 = std::min(a.y + a.height, b.y + b.height);
+	return screen_space_rect{ x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0) };
+}
+
+}
+
+uint32_t premultiplied(brush_color c) {
+	auto a = std::clamp(c.a, 0.0f, 1.0f);
+	auto to_byte = [](float v) { return uint8_t(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f)); };
+	return pack_rgba(to_byte(c.r * a), to_byte(c.g * a), to_byte(c.b * a), to_byte(a));
+}
+
+//
+// spans
+//
+
+namespace spans {
+
+void fill(uint32_t* dest, int32_t count, uint32_t color) {
+	int32_t i = 0;
+#if defined(MINUI_RASTER_AVX2)
+	auto c8 = _mm256_set1_epi32(int32_t(color));
+	for(; i + 8 <= count; i += 8)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), c8);
+#endif
+#if defined(MINUI_RASTER_SSE2)
+	auto c4 = _mm_set1_epi32(int32_t(color));
+	for(; i + 4 <= count; i += 4)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), c4);
+#endif
+	for(; i < count; ++i)
+		dest[i] = color;
+}
+
+void blend_solid(uint32_t* dest, int32_t count, uint32_t color) {
+	if((color >> 24) == 255) {
+		fill(dest, count, color);
+		return;
+	}
+	if(color == 0)
+		return;
+
+	int32_t i = 0;
+	uint32_t inv_alpha = 255 - (color >> 24);
+#if defined(MINUI_RASTER_AVX2)
+	{
+		auto zero = _mm256_setzero_si256();
+		auto source = _mm256_unpacklo_epi8(_mm256_set1_epi32(int32_t(color)), zero);
+		auto inv = _mm256_set1_epi16(int16_t(inv_alpha));
+		for(; i + 8 <= count; i += 8) {
+			auto d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dest + i));
+			auto lo = _mm256_add_epi16(source, div255_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv)));
+			auto hi = _mm256_add_epi16(source, div255_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_packus_epi16(lo, hi));
+		}
+	}
+#endif
+#if defined(MINUI_RASTER_SSE2)
+	{
+		auto zero = _mm_setzero_si128();
+		auto source = _mm_unpacklo_epi8(_mm_set1_epi32(int32_t(color)), zero);
+		auto inv = _mm_set1_epi16(int16_t(inv_alpha));
+		for(; i + 4 <= count; i += 4) {
+			auto d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dest + i));
+			auto lo = _mm_add_epi16(source, div255_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv)));
+			auto hi = _mm_add_epi16(source, div255_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(lo, hi));
+		}
+	}
+#endif
+	for(; i < count; ++i)
+		dest[i] = over(dest[i], color);
+}
+
+void blend_mask(uint32_t* dest, uint8_t const* coverage, int32_t count, uint32_t color) {
+	int32_t i = 0;
+#if defined(MINUI_RASTER_SSE2)
+	auto zero = _mm_setzero_si128();
+	auto c = _mm_unpacklo_epi8(_mm_set1_epi32(int32_t(color)), zero);
+	for(; i + 4 <= count; i += 4) {
+		int32_t m4;
+		std::memcpy(&m4, coverage + i, 4);
+		if(m4 == 0)
+			continue;
+		auto m = _mm_unpacklo_epi8(_mm_cvtsi32_si128(m4), zero); // m0 m1 m2 m3 as 16 bit lanes
+		m = _mm_unpacklo_epi16(m, m); // m0 m0 m1 m1 m2 m2 m3 m3
+		auto m_lo = _mm_unpacklo_epi32(m, m); // each of m0, m1 in four lanes
+		auto m_hi = _mm_unpackhi_epi32(m, m);
+
+		auto d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dest + i));
+		auto lo = over_epi16(_mm_unpacklo_epi8(d, zero), div255_epi16(_mm_mullo_epi16(c, m_lo)));
+		auto hi = over_epi16(_mm_unpackhi_epi8(d, zero), div255_epi16(_mm_mullo_epi16(c, m_hi)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for(; i < count; ++i) {
+		if(coverage[i] != 0)
+			dest[i] = over(dest[i], scale(color, coverage[i]));
+	}
+}
+
+void blend_pixels(uint32_t* dest, uint32_t const* source, int32_t count) {
+	int32_t i = 0;
+#if defined(MINUI_RASTER_AVX2)
+	{
+		auto zero = _mm256_setzero_si256();
+		for(; i + 8 <= count; i += 8) {
+			auto s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + i));
+			auto d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dest + i));
+			auto lo = over_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero));
+			auto hi = over_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_packus_epi16(lo, hi));
+		}
+	}
+#endif
+#if defined(MINUI_RASTER_SSE2)
+	{
+		auto zero = _mm_setzero_si128();
+		for(; i + 4 <= count; i += 4) {
+			auto s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i));
+			auto d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dest + i));
+			auto lo = over_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero));
+			auto hi = over_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(lo, hi));
+		}
+	}
+#endif
+	for(; i < count; ++i)
+		dest[i] = over(dest[i], source[i]);
+}
+
+}
+
+//
+// rasterizer
+//
+
+bitmap const* rasterizer::find(std::vector<keyed_bitmap> const& in, int32_t handle, int32_t sub_slot) {
+	for(auto& k : in) {
+		if(k.key.handle == handle && k.key.sub_slot == sub_slot)
+			return k.bmp.width > 0 && k.bmp.height > 0 ? &k.bmp : nullptr;
+	}
+	return nullptr;
+}
+void rasterizer::store(std::vector<keyed_bitmap>& in, int32_t handle, int32_t sub_slot, bitmap&& b) {
+	for(auto& k : in) {
+		if(k.key.handle == handle && k.key.sub_slot == sub_slot) {
+			k.bmp = std::move(b);
+			return;
+		}
+	}
+	in.push_back(keyed_bitmap{ slot_key{ handle, sub_slot }, std::move(b) });
+}
+
+void rasterizer::set_icon(icon_handle ico, int32_t sub_slot, bitmap mask) {
+	store(icons, ico.value, sub_slot, std::move(mask));
+}
+void rasterizer::set_image(image_handle img, int32_t sub_slot, bitmap b) {
+	store(images, img.value, sub_slot, std::move(b));
+}
+void rasterizer::set_brush_image(uint16_t brush, bool as_disabled, bitmap b) {
+	store(brush_images, brush, as_disabled ? 1 : 0, std::move(b));
+}
+void rasterizer::set_glyph(native_char c, bitmap mask) {
+	store(glyphs, int32_t(c), 0, std::move(mask));
+}
+
+void rasterizer::clear(uint32_t color) {
+	spans::fill(pixels.data(), int32_t(pixels.size()), color);
+}
+
+screen_space_rect rasterizer::place(pass const& p, screen_space_rect r) const {
+	if(!p.s.left_to_right)
+		r.x = width - (r.x + r.width);
+	return r;
+}
+
+void rasterizer::fill_rect(pass& p, screen_space_rect r, uint32_t color) {
+	r = intersect(r, p.clip);
+	for(int32_t y = r.y; y < r.y + r.height; ++y)
+		spans::blend_solid(pixels.data() + size_t(y) * size_t(width) + size_t(r.x), r.width, color);
+}
+
+void rasterizer::fill_brush(pass& p, screen_space_rect r, uint16_t brush, rendering_modifiers display_flags) {
+	if(brush >= p.s.brush_collection.size())
+		return;
+	bool disabled = display_flags == rendering_modifiers::disabled;
+
+	if(auto img = find(brush_images, brush, disabled ? 1 : 0); img) {
+		r = intersect(r, p.clip);
+		for(int32_t y = r.y; y < r.y + r.height; ++y) {
+			auto source_row = img->pixels.data() + size_t(y % img->height) * size_t(img->width);
+			auto dest = pixels.data() + size_t(y) * size_t(width);
+			for(int32_t x = r.x; x < r.x + r.width; ) {
+				auto sx = x % img->width;
+				auto run = std::min(img->width - sx, r.x + r.width - x);
+				spans::blend_pixels(dest + x, source_row + sx, run);
+				x += run;
+			}
+		}
+		return;
+	}
+
+	auto& b = p.s.brush_collection[brush];
+	fill_rect(p, r, premultiplied(disabled ? b.disabled_color : b.color));
+}
+
+// lightens or darkens highlighted elements and alternate lines, like the D2D backend's empty_rectangle
+void rasterizer::shade(pass& p, screen_space_rect r, uint16_t brush, rendering_modifiers display_flags) {
+	if(brush >= p.s.brush_collection.size())
+		return;
+	auto& b = p.s.brush_collection[brush];
+	bool highlighted = display_flags == rendering_modifiers::highlighted;
+	float shading = p.line_highlight ? (highlighted ? b.line_highlight_shading : b.line_shading) : (highlighted ? b.highlight_shading : 0.0f);
+	if(shading == 0.0f)
+		return;
+
+	auto o = uint8_t(std::lround(std::min(std::abs(shading), 1.0f) * 255.0f));
+	fill_rect(p, r, shading > 0.0f ? pack_rgba(o, o, o, o) : pack_rgba(0, 0, 0, o));
+}
+
+// draws the source region [sx0, sx1) x [sy0, sy1) of b stretched over dest
+void rasterizer::blit(pass& p, bitmap const& b, screen_space_rect dest, float sx0, float sy0, float sx1, float sy1, bool flip) {
+	if(dest.width <= 0 || dest.height <= 0)
+		return;
+	auto r = intersect(dest, p.clip);
+	if(r.width <= 0 || r.height <= 0)
+		return;
+
+	float x_step = (sx1 - sx0) / float(dest.width);
+	float y_step = (sy1 - sy0) / float(dest.height);
+	p.row.resize(size_t(r.width));
+	for(int32_t y = r.y; y < r.y + r.height; ++y) {
+		auto sy = std::clamp(int32_t(sy0 + (float(y - dest.y) + 0.5f) * y_step), 0, b.height - 1);
+		auto source_row = b.pixels.data() + size_t(sy) * size_t(b.width);
+		for(int32_t x = r.x; x < r.x + r.width; ++x) {
+			auto dx = flip ? (2 * dest.x + dest.width - 1 - x) : x;
+			auto sx = std::clamp(int32_t(sx0 + (float(dx - dest.x) + 0.5f) * x_step), 0, b.width - 1);
+			p.row[size_t(x - r.x)] = source_row[sx];
+		}
+		spans::blend_pixels(pixels.data() + size_t(y) * size_t(width) + size_t(r.x), p.row.data(), r.width);
+	}
+}
+
+void rasterizer::blit_mask(pass& p, bitmap const& b, screen_space_rect dest, uint32_t color, bool flip) {
+	if(dest.width <= 0 || dest.height <= 0)
+		return;
+	auto r = intersect(dest, p.clip);
+	if(r.width <= 0 || r.height <= 0)
+		return;
+
+	p.coverage.resize(size_t(r.width));
+	for(int32_t y = r.y; y < r.y + r.height; ++y) {
+		auto sy = std::min(int32_t(int64_t(y - dest.y) * b.height / dest.height), b.height - 1);
+		auto source_row = b.pixels.data() + size_t(sy) * size_t(b.width);
+		for(int32_t x = r.x; x < r.x + r.width; ++x) {
+			auto dx = flip ? (2 * dest.x + dest.width - 1 - x) : x;
+			auto sx = std::min(int32_t(int64_t(dx - dest.x) * b.width / dest.width), b.width - 1);
+			p.coverage[size_t(x - r.x)] = uint8_t(source_row[sx] >> 24);
+		}
+		spans::blend_mask(pixels.data() + size_t(y) * size_t(width) + size_t(r.x), p.coverage.data(), r.width, color);
+	}
+}
+
+// aliased, like the D2D backend: a pixel is covered if its center is within half the width of the segment
+void rasterizer::line(pass& p, screen_space_point start, screen_space_point end, float line_width, uint32_t color) {
+	float half = std::max(line_width, 1.0f) / 2.0f;
+	if(start.y == end.y || start.x == end.x) {
+		auto x0 = std::min(start.x, end.x);
+		auto y0 = std::min(start.y, end.y);
+		auto x1 = std::max(start.x, end.x);
+		auto y1 = std::max(start.y, end.y);
+		auto thickness = std::max(int32_t(std::lround(line_width)), 1);
+		if(start.y == end.y)
+			fill_rect(p, screen_space_rect{ x0, y0 - thickness / 2, x1 - x0, thickness }, color);
+		else
+			fill_rect(p, screen_space_rect{ x0 - thickness / 2, y0, thickness, y1 - y0 }, color);
+		return;
+	}
+
+	auto extent = int32_t(std::ceil(half));
+	auto r = intersect(screen_space_rect{ std::min(start.x, end.x) - extent, std::min(start.y, end.y) - extent, std::abs(end.x - start.x) + 2 * extent, std::abs(end.y - start.y) + 2 * extent }, p.clip);
+	if(r.width <= 0 || r.height <= 0)
+		return;
+
+	float dx = float(end.x - start.x);
+	float dy = float(end.y - start.y);
+	float length_sq = dx * dx + dy * dy;
+	p.coverage.resize(size_t(r.width));
+	for(int32_t y = r.y; y < r.y + r.height; ++y) {
+		for(int32_t x = r.x; x < r.x + r.width; ++x) {
+			float px = float(x) + 0.5f - float(start.x);
+			float py = float(y) + 0.5f - float(start.y);
+			float t = std::clamp((px * dx + py * dy) / length_sq, 0.0f, 1.0f);
+			float ex = px - t * dx;
+			float ey = py - t * dy;
+			p.coverage[size_t(x - r.x)] = ex * ex + ey * ey <= half * half ? 255 : 0;
+		}
+		spans::blend_mask(pixels.data() + size_t(y) * size_t(width) + size_t(r.x), p.coverage.data(), r.width, color);
+	}
+}
+
+// the interior edges are fractions of 2048, applied to the destination and the bitmap alike
+void rasterizer::nine_slice(pass& p, bitmap const& b, screen_space_rect dest, layout_rect interior, bool flip) {
+	float left = float(interior.x.value) / 2048.0f;
+	float top = float(interior.y.value) / 2048.0f;
+	float right = float(interior.width.value) / 2048.0f;
+	float bottom = float(interior.height.value) / 2048.0f;
+
+	auto piece = [&](float fx0, float fy0, float fx1, float fy1) {
+		auto x0 = dest.x + int32_t(std::lround(float(dest.width) * fx0));
+		auto x1 = dest.x + int32_t(std::lround(float(dest.width) * fx1));
+		auto y0 = dest.y + int32_t(std::lround(float(dest.height) * fy0));
+		auto y1 = dest.y + int32_t(std::lround(float(dest.height) * fy1));
+		screen_space_rect d{ x0, y0, x1 - x0, y1 - y0 };
+		if(flip)
+			d.x = dest.x + dest.width - (d.x - dest.x) - d.width;
+		blit(p, b, d, float(b.width) * fx0, float(b.height) * fy0, float(b.width) * fx1, float(b.height) * fy1, flip);
+	};
+
+	if(left > 0.0f && top > 0.0f)
+		piece(0.0f, 0.0f, left, top);
+	if(right > 0.0f && top > 0.0f)
+		piece(1.0f - right, 0.0f, 1.0f, top);
+	if(left > 0.0f && bottom > 0.0f)
+		piece(0.0f, 1.0f - bottom, left, 1.0f);
+	if(right > 0.0f && bottom > 0.0f)
+		piece(1.0f - right, 1.0f - bottom, 1.0f, 1.0f);
+	if(left > 0.0f)
+		piece(0.0f, top, left, 1.0f - bottom);
+	if(right > 0.0f)
+		piece(1.0f - right, top, 1.0f, 1.0f - bottom);
+	if(top > 0.0f)
+		piece(left, 0.0f, 1.0f - right, top);
+	if(bottom > 0.0f)
+		piece(left, 1.0f - bottom, 1.0f - right, 1.0f);
+	piece(left, top, 1.0f - right, 1.0f - bottom);
+}
+
+// lays the characters out on the headless monospace grid and stamps each one's glyph mask
+void rasterizer::text(pass& p, text_command const& c, native_string_view chars) {
+	if(c.brush >= p.s.brush_collection.size())
+		return;
+	auto& b = p.s.brush_collection[c.brush];
+	auto color = premultiplied(c.display_flags == rendering_modifiers::disabled ? b.disabled_color : b.color);
+
+	auto rect = place(p, c.rect);
+	auto outer_clip = p.clip;
+	p.clip = intersect(p.clip, rect);
+
+	auto layout = p.s.get_monospace_layout(c.font, c.multiline ? c.rect.width : 0);
+	int32_t line = 0;
+	int32_t column = 0;
+	for(size_t i = 0; i < chars.size(); ++i) {
+		if(chars[i] == NATIVE('\n')) {
+			++line;
+			column = 0;
+			continue;
+		}
+		if(layout.chars_per_line > 0 && column == layout.chars_per_line) {
+			++line;
+			column = 0;
+		}
+		auto y = rect.y + (line - c.starting_line) * layout.line_height;
+		if(y >= p.clip.y + p.clip.height)
+			break;
+		if(line >= c.starting_line) {
+			if(auto g = find(glyphs, int32_t(chars[i]), 0); g) {
+				auto x = p.s.left_to_right ? rect.x + column * layout.advance : rect.x + rect.width - (column + 1) * layout.advance;
+				blit_mask(p, *g, screen_space_rect{ x, y, layout.advance, layout.line_height }, color, false);
+			}
+		}
+		++column;
+	}
+
+	p.clip = outer_clip;
+}
+
+void rasterizer::execute(pass& p, command_header const& h, uint8_t const* payload) {
+	switch(h.type) {
+		case command_type::rectangle:
+		{
+			auto c = command_buffer::read<rectangle_command>(payload);
+			auto r = place(p, c.rect);
+			fill_brush(p, r, c.brush, c.display_flags);
+			shade(p, r, c.brush, c.display_flags);
+		}
+			break;
+		case command_type::empty_rectangle:
+		{
+			auto c = command_buffer::read<rectangle_command>(payload);
+			shade(p, place(p, c.rect), c.brush, c.display_flags);
+		}
+			break;
+		case command_type::line:
+		{
+			auto c = command_buffer::read<line_command>(payload);
+			if(c.brush >= p.s.brush_collection.size())
+				break;
+			auto start = c.start;
+			auto end = c.end;
+			if(!p.s.left_to_right) {
+				start.x = width - start.x;
+				end.x = width - end.x;
+			}
+			line(p, start, end, float(p.s.pixels_per_em) * c.width, premultiplied(p.s.brush_collection[c.brush].color));
+		}
+			break;
+		case command_type::interactable:
+			break;
+		case command_type::image:
+		{
+			auto c = command_buffer::read<image_command>(payload);
+			if(auto b = find(images, c.img.value, c.sub_slot); b)
+				blit(p, *b, place(p, c.rect), 0.0f, 0.0f, float(b->width), float(b->height), false);
+		}
+			break;
+		case command_type::background:
+		{
+			auto c = command_buffer::read<background_command>(payload);
+			if(auto b = find(images, c.img.value, c.sub_slot); b) {
+				auto r = place(p, c.rect);
+				nine_slice(p, *b, r, c.interior, !p.s.left_to_right);
+				shade(p, r, c.brush, c.display_flags);
+			}
+		}
+			break;
+		case command_type::icon:
+		{
+			auto c = command_buffer::read<icon_command>(payload);
+			if(c.brush >= p.s.brush_collection.size())
+				break;
+			if(auto b = find(icons, c.ico.value, c.sub_slot); b) {
+				auto& br = p.s.brush_collection[c.brush];
+				auto color = premultiplied(c.display_flags == rendering_modifiers::disabled ? br.disabled_color : br.color);
+				blit_mask(p, *b, place(p, c.rect), color, !p.s.left_to_right);
+			}
+		}
+			break;
+		case command_type::line_highlight_mode:
+			p.line_highlight = command_buffer::read<line_highlight_mode_command>(payload).highlight_on;
+			break;
+		case command_type::text:
+		{
+			auto c = command_buffer::read<text_command>(payload);
+			p.chars.resize(c.length); // the payload is not aligned for native_char
+			if(c.length != 0)
+				std::memcpy(p.chars.data(), payload + sizeof(text_command), c.length * sizeof(native_char));
+			text(p, c, p.chars);
+		}
+			break;
+		case command_type::clip:
+		{
+			auto c = command_buffer::read<clip_command>(payload);
+			p.clip = c.clip_on ? intersect(p.bounds, place(p, c.rect)) : p.bounds;
+		}
+			break;
+	}
+}
+
+void rasterizer::draw(system const& s, screen_space_rect region) {
+	pass p{ s };
+	p.bounds = intersect(region, screen_space_rect{ 0, 0, width, height });
+	p.clip = p.bounds;
+
+	s.commands.for_each([&](command_header const& h, uint8_t const* payload) {
+		execute(p, h, payload);
+	});
+}
+
+// the pixels a command may touch; state changes affect every tile
+screen_space_rect rasterizer::command_bounds(system const& s, command_header const& h, uint8_t const* payload) const {
+	auto everything = screen_space_rect{ 0, 0, width, height };
+	auto mirror = [&](screen_space_rect r) {
+		if(!s.left_to_right)
+			r.x = width - (r.x + r.width);
+		return r;
+	};
+	switch(h.type) {
+		case command_type::rectangle:
+		case command_type::empty_rectangle:
+			return mirror(command_buffer::read<rectangle_command>(payload).rect);
+		case command_type::line:
+		{
+			auto c = command_buffer::read<line_command>(payload);
+			auto extent = int32_t(std::ceil(std::max(float(s.pixels_per_em) * c.width, 1.0f))) + 1;
+			auto x0 = std::min(c.start.x, c.end.x);
+			auto x1 = std::max(c.start.x, c.end.x);
+			auto y0 = std::min(c.start.y, c.end.y);
+			auto y1 = std::max(c.start.y, c.end.y);
+			if(!s.left_to_right) {
+				auto t = width - x1;
+				x1 = width - x0;
+				x0 = t;
+			}
+			return screen_space_rect{ x0 - extent, y0 - extent, x1 - x0 + 2 * extent, y1 - y0 + 2 * extent };
+		}
+		case command_type::interactable:
+			return screen_space_rect{ 0, 0, 0, 0 };
+		case command_type::image:
+			return mirror(command_buffer::read<image_command>(payload).rect);
+		case command_type::background:
+			return mirror(command_buffer::read<background_command>(payload).rect);
+		case command_type::icon:
+			return mirror(command_buffer::read<icon_command>(payload).rect);
+		case command_type::text:
+			return mirror(command_buffer::read<text_command>(payload).rect);
+		case command_type::line_highlight_mode:
+		case command_type::clip:
+			return everything;
+	}
+	return everything;
+}
+
+void rasterizer::draw_tiles(system const& s, task_pool& pool, uint32_t background, std::span<const screen_space_rect> damaged, bool everything) {
+	auto tiles_x = (width + tile_size - 1) / tile_size;
+	auto tiles_y = (height + tile_size - 1) / tile_size;
+	auto tile_count = size_t(tiles_x) * size_t(tiles_y);
+	if(tile_bins.size() != tile_count)
+		tile_bins.resize(tile_count);
+
+	// covers the tiles that r touches
+	auto tile_range = [&](screen_space_rect r, auto&& f) {
+		r = intersect(r, screen_space_rect{ 0, 0, width, height });
+		if(r.width <= 0 || r.height <= 0)
+			return;
+		for(int32_t ty = r.y / tile_size; ty <= (r.y + r.height - 1) / tile_size; ++ty) {
+			for(int32_t tx = r.x / tile_size; tx <= (r.x + r.width - 1) / tile_size; ++tx)
+				f(size_t(ty) * size_t(tiles_x) + size_t(tx));
+		}
+	};
+
+	tile_active.assign(tile_count, uint8_t(everything ? 1 : 0));
+	for(auto& r : damaged) {
+		tile_range(r, [&](size_t t) { tile_active[t] = 1; });
+	}
+	active_tiles.clear();
+	for(size_t t = 0; t < tile_count; ++t) {
+		if(tile_active[t] != 0) {
+			active_tiles.push_back(uint32_t(t));
+			tile_bins[t].clear();
+		}
+	}
+	tiles_drawn = uint32_t(active_tiles.size());
+	if(active_tiles.empty())
+		return;
+
+	auto base = s.commands.data.data();
+	s.commands.for_each([&](command_header const& h, uint8_t const* payload) {
+		auto offset = uint32_t(payload - base - sizeof(command_header));
+		tile_range(command_bounds(s, h, payload), [&](size_t t) {
+			if(tile_active[t] != 0)
+				tile_bins[t].push_back(offset);
+		});
+	});
+
+	pool.parallel_for(active_tiles.size(), [&](size_t i) {
+		auto t = active_tiles[i];
+		auto tx = int32_t(t % uint32_t(tiles_x));
+		auto ty = int32_t(t / uint32_t(tiles_x));
+		screen_space_rect tile{ tx * tile_size, ty * tile_size, std::min(tile_size, width - tx * tile_size), std::min(tile_size, height - ty * tile_size) };
+
+		for(int32_t y = tile.y; y < tile.y + tile.height; ++y)
+			spans::fill(pixels.data() + size_t(y) * size_t(width) + size_t(tile.x), tile.width, background);
+
+		pass p{ s };
+		p.bounds = tile;
+		p.clip = tile;
+		for(auto offset : tile_bins[t]) {
+			command_header h;
+			std::memcpy(&h, base + offset, sizeof(command_header));
+			execute(p, h, base + offset + sizeof(command_header));
+		}
+	});
+}
+
+}
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "system_headless.hpp"
+#include "task_pool.hpp"
+
+#include <stdint.h>
+#include <vector>
+#include <span>
+#include <algorithm>
+
+namespace minui {
+namespace headless {
+
+// 8 bit per channel pixels, stored r, g, b, a in memory order. Bitmaps handed to the rasterizer are
+// premultiplied; icon and glyph bitmaps only use their alpha channel.
+struct bitmap {
+	int32_t width = 0;
+	int32_t height = 0;
+	std::vector<uint32_t> pixels;
+
+	bitmap() = default;
+	bitmap(int32_t width, int32_t height, uint32_t fill = 0) : width(width), height(height), pixels(size_t(std::max(width, 0)) * size_t(std::max(height, 0)), fill) { }
+};
+
+constexpr uint32_t pack_rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+	return uint32_t(r) | (uint32_t(g) << 8) | (uint32_t(b) << 16) | (uint32_t(a) << 24);
+}
+uint32_t premultiplied(brush_color c);
+
+// the span kernels the rasterizer is built from; each uses AVX2 or SSE2 when the compiler targets them
+namespace spans {
+
+void fill(uint32_t* dest, int32_t count, uint32_t color); // replaces the pixels
+void blend_solid(uint32_t* dest, int32_t count, uint32_t color); // premultiplied source over
+void blend_mask(uint32_t* dest, uint8_t const* coverage, int32_t count, uint32_t color); // color scaled by coverage, over
+void blend_pixels(uint32_t* dest, uint32_t const* source, int32_t count); // premultiplied source over
+
+}
+
+// Draws the commands recorded by a headless system into an RGBA framebuffer. Rectangles, image brushes,
+// 9-slice backgrounds, lines, icons, images, text and the highlight / disabled shading are covered; images
+// are sampled nearest-neighbour. Interactable prompts are not drawn.
+class rasterizer {
+	struct slot_key {
+		int32_t handle = 0;
+		int32_t sub_slot = 0;
+	};
+	struct keyed_bitmap {
+		slot_key key;
+		bitmap bmp;
+	};
+	std::vector<keyed_bitmap> icons;
+	std::vector<keyed_bitmap> images;
+	std::vector<keyed_bitmap> brush_images; // sub_slot 0 regular, 1 disabled
+	std::vector<keyed_bitmap> glyphs; // handle is the character
+
+	static bitmap const* find(std::vector<keyed_bitmap> const& in, int32_t handle, int32_t sub_slot);
+	static void store(std::vector<keyed_bitmap>& in, int32_t handle, int32_t sub_slot, bitmap&& b);
+
+	// the state of one replay; separate passes over disjoint regions may run at the same time
+	struct pass {
+		system const& s;
+		screen_space_rect bounds{ }; // drawing is limited to this, intersected with any clip command
+		screen_space_rect clip{ };
+		bool line_highlight = false;
+		std::vector<uint32_t> row{ }; // scratch
+		std::vector<uint8_t> coverage{ }; // scratch
+		native_string chars{ }; // scratch
+	};
+
+	screen_space_rect place(pass const& p, screen_space_rect r) const; // applies right to left mirroring
+	void fill_rect(pass& p, screen_space_rect r, uint32_t color);
+	void fill_brush(pass& p, screen_space_rect r, uint16_t brush, rendering_modifiers display_flags);
+	void shade(pass& p, screen_space_rect r, uint16_t brush, rendering_modifiers display_flags);
+	void blit(pass& p, bitmap const& b, screen_space_rect dest, float sx0, float sy0, float sx1, float sy1, bool flip);
+	void blit_mask(pass& p, bitmap const& b, screen_space_rect dest, uint32_t color, bool flip);
+	void line(pass& p, screen_space_point start, screen_space_point end, float width, uint32_t color);
+	void nine_slice(pass& p, bitmap const& b, screen_space_rect dest, layout_rect interior, bool flip);
+	void text(pass& p, text_command const& c, native_string_view chars);
+	void execute(pass& p, command_header const& h, uint8_t const* payload);
+	screen_space_rect command_bounds(system const& s, command_header const& h, uint8_t const* payload) const;
+
+	// per tile lists of the commands that touch it, as offsets into the command buffer
+	std::vector<std::vector<uint32_t>> tile_bins;
+	std::vector<uint8_t> tile_active;
+	std::vector<uint32_t> active_tiles;
+	void draw_tiles(system const& s, task_pool& pool, uint32_t background, std::span<const screen_space_rect> damaged, bool everything);
+public:
+	int32_t width = 0;
+	int32_t height = 0;
+	int32_t tile_size = 64;
+	uint32_t tiles_drawn = 0; // by the last draw_tiled
+	std::vector<uint32_t> pixels;
+
+	rasterizer(int32_t width, int32_t height) : width(width), height(height), pixels(size_t(width) * size_t(height), 0) { }
+
+	void set_icon(icon_handle ico, int32_t sub_slot, bitmap mask);
+	void set_image(image_handle img, int32_t sub_slot, bitmap b);
+	void set_brush_image(uint16_t brush, bool as_disabled, bitmap b); // tiled from the framebuffer origin
+	void set_glyph(native_char c, bitmap mask); // stretched to each character cell
+
+	void clear(uint32_t color);
+	// replays s.commands, touching only the pixels inside region; the bitmaps must not change meanwhile
+	void draw(system const& s, screen_space_rect region);
+	void draw(system const& s) {
+		draw(s, screen_space_rect{ 0, 0, width, height });
+	}
+	// Clears to background and replays s.commands one tile at a time, spreading the tiles over the pool.
+	// Every tile is drawn by one job with the commands in order, so the result does not depend on the thread
+	// count and matches draw. The second form redraws only the tiles that touch the damaged regions.
+	void draw_tiled(system const& s, task_pool& pool, uint32_t background) {
+		draw_tiles(s, pool, background, std::span<const screen_space_rect>{ }, true);
+	}
+	void draw_tiled(system const& s, task_pool& pool, uint32_t background, std::span<const screen_space_rect> damaged) {
+		draw_tiles(s, pool, background, damaged, false);
+	}
+	uint32_t pixel(int32_t x, int32_t y) const {
+		return pixels[size_t(y) * size_t(width) + size_t(x)];
+	}
+};
+
+}
+}
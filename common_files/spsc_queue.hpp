@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+
+namespace minui {
+
+// A fixed capacity ring for handing values from one producer thread to one consumer thread without locks.
+// push may only be called from the producer and pop only from the consumer; either may be the same thread.
+// The capacity is rounded up to a power of two.
+template<typename T>
+class spsc_queue {
+	static constexpr size_t line = 64; // keeps the two indices on separate cache lines
+
+	std::unique_ptr<T[]> slots;
+	size_t mask = 0;
+
+	alignas(line) std::atomic<size_t> head = 0; // next slot to read; written by the consumer
+	alignas(line) std::atomic<size_t> tail = 0; // next slot to write; written by the producer
+
+	static size_t round_up(size_t n) {
+		size_t r = 1;
+		while(r < n)
+			r <<= 1;
+		return r;
+	}
+public:
+	explicit spsc_queue(size_t capacity) : slots(new T[round_up(capacity)]), mask(round_up(capacity) - 1) { }
+	spsc_queue(spsc_queue const&) = delete;
+	spsc_queue& operator=(spsc_queue const&) = delete;
+
+	// false if the queue is full, in which case v is not added
+	bool push(T const& v) {
+		auto t = tail.load(std::memory_order_relaxed);
+		if(t - head.load(std::memory_order_acquire) > mask)
+			return false;
+		slots[t & mask] = v;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+	// false if the queue is empty
+	bool pop(T& out) {
+		auto h = head.load(std::memory_order_relaxed);
+		if(h == tail.load(std::memory_order_acquire))
+			return false;
+		out = slots[h & mask];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+	bool empty() const {
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+	size_t capacity() const {
+		return mask + 1;
+	}
+};
+
+}
@@ -8,6 +8,9 @@
 #include <array>
 #include <span>
 #include <bit>
+#include <optional>
+#include <type_traits>
+#include <algorithm>
 #include "unordered_dense.h"
 
 namespace serialization {
@@ -44,6 +47,8 @@ public:
 	}
 	template<typename T>
 	void write_fixed(T const* d, size_t count) {
+		if(count == 0)
+			return;
 		auto start_size = data_.size();
 		data_.resize(start_size + sizeof(T) * count, 0);
 		std::memcpy(data_.data() + start_size, d, sizeof(T) * count);
@@ -52,7 +57,7 @@ public:
 	void write_variable(T const* d, size_t count) {
 		uint32_t c = uint32_t(count);
 		write(c);
-		write_fixed(T, count);
+		write_fixed(d, count);
 	}
 	void write_relocation(std::function<void(out_buffer&)>&& f) {
 		auto reloc_address = data_.size();
@@ -95,40 +100,40 @@ public:
 	in_buffer(char const* base_offset, char const* data, size_t size, size_t base_size) : base_offset(base_offset), data(data), size(size), base_size(base_size) {
 	}
 
+	// strings are stored as a length followed by their characters
 	template<typename T>
 	T read() {
-		T temp = T{ };
-		if(read_position + sizeof(T) <= size) {
-			std::memcpy(&temp, data + read_position, sizeof(T));
-			read_position += sizeof(T);
+		if constexpr(std::is_same_v<T, std::string_view>) {
+			auto s = read_variable<char>();
+			return std::string_view(s.data(), s.size());
+		} else if constexpr(std::is_same_v<T, std::wstring_view>) {
+			auto s = read_variable<wchar_t>();
+			return std::wstring_view(s.data(), s.size());
+		} else {
+			T temp = T{ };
+			if(read_position + sizeof(T) <= size) {
+				std::memcpy(&temp, data + read_position, sizeof(T));
+				read_position += sizeof(T);
+			}
+			return temp;
 		}
-		return temp;
 	}
 	template<typename T>
-	std::span<T const> read_fixed(size_t count) const {
+	std::span<T const> read_fixed(size_t count) {
 		auto len = std::min(count, (size - read_position) / sizeof(T));
 		auto start = (T const*)(data + read_position);
+		read_position += len * sizeof(T);
 		return std::span<T const>(start, start + len);
 	}
 	template<typename T>
-	std::span<T const> read_variable() const {
+	std::span<T const> read_variable() {
 		auto count = read<uint32_t>();
-		return read_fixed(count);
+		return read_fixed<T>(count);
 	}
 	in_buffer read_relocation() {
 		uint32_t offset = read<uint32_t>();
 		return in_buffer(base_offset, base_offset + offset, (base_offset + base_size) - (base_offset + offset), base_size);
 	}
-	template<>
-	std::string_view read<std::string_view>() {
-		auto s = read_variable<char>();
-		return std::string_view(s.data(), s.size());
-	}
-	template<>
-	std::wstring_view read<std::wstring_view>() {
-		auto s = read_variable<wchar_t>();
-		return std::wstring_view(s.data(), s.size());
-	}
 };
 
 }
@@ -146,16 +151,12 @@ template <class Key,
 	class Bucket>
 class table_view : public base_table_type_map<T> {
 	using underlying_value_type = std::pair<Key, T>;
-	using underlying_container_type = std::span<std::pair<Key, T>>;
 
 public:
-	using value_container_type = std::span<std::pair<Key, T>>;
+	// both the values and the buckets are read in place from a loaded file
+	using value_container_type = std::span<std::pair<Key, T> const>;
 
 private:
-	using bucket_alloc =
-		typename std::allocator_traits<typename value_container_type::allocator_type>::template rebind_alloc<Bucket>;
-	using bucket_alloc_traits = std::allocator_traits<bucket_alloc>;
-
 	static constexpr uint8_t initial_shifts = 64 - 2; // 2^(64-m_shift) number of buckets
 	static constexpr float default_max_load_factor = 0.8F;
 
@@ -170,7 +171,7 @@ public:
 	using const_reference = typename value_container_type::const_reference;
 	using pointer = typename value_container_type::pointer;
 	using const_pointer = typename value_container_type::const_pointer;
-	using const_iterator = typename value_container_type::const_iterator;
+	using const_iterator = typename value_container_type::iterator; // the span is already of const values
 	using iterator = typename value_container_type::iterator;
 	using bucket_type = Bucket;
 
@@ -182,7 +183,7 @@ private:
 	static_assert(std::is_trivially_copyable_v<Bucket>, "assert we can just memset / memcpy");
 
 	value_container_type m_values; // Contains all the key-value pairs in one densely stored container. No holes.
-	std::span<bucket_type> m_buckets;
+	std::span<bucket_type const> m_buckets;
 	uint8_t m_shifts = initial_shifts;
 
 	Hash m_hash{ };
@@ -196,8 +197,8 @@ private:
 	}
 
 	// Helper to access bucket through pointer types
-	[[nodiscard]] static constexpr auto at(bucket_pointer bucket_ptr, size_t offset) -> Bucket& {
-		return *(bucket_ptr + static_cast<typename std::allocator_traits<bucket_alloc>::difference_type>(offset));
+	[[nodiscard]] static constexpr auto at(Bucket const* bucket_ptr, size_t offset) -> Bucket const& {
+		return *(bucket_ptr + static_cast<std::ptrdiff_t>(offset));
 	}
 
 	// use the dist_inc and dist_dec functions so that uint16_t types work without warning
@@ -372,7 +373,7 @@ private:
 
 public:
 	explicit table_view(value_container_type m_values,
-		std::span<bucket_type> m_buckets,
+		std::span<bucket_type const> m_buckets,
 		Hash const& hash = Hash(),
 		KeyEqual const& equal = KeyEqual())
 		: m_values(m_values),
@@ -390,7 +391,7 @@ public:
 		m_shifts = other.m_shifts;
 	}
 
-	table_view() : table_view(value_container_type{ }, std::span<bucket_type>{}) {
+	table_view() : table_view(value_container_type{ }, std::span<bucket_type const>{}) {
 
 	}
 
@@ -538,6 +539,10 @@ public:
 		return m_buckets.size();
 	}
 
+	static constexpr auto max_size() noexcept -> size_t {
+		return size_t{ 1 } << (sizeof(value_idx_type) * 8 - 1);
+	}
+
 	static constexpr auto max_bucket_count() noexcept -> size_t { // NOLINT(modernize-use-nodiscard)
 		return max_size();
 	}
@@ -600,9 +605,8 @@ ANKERL_UNORDERED_DENSE_EXPORT template <class Key,
 	class T,
 	class Hash = hash<Key>,
 	class KeyEqual = std::equal_to<Key>,
-	class AllocatorOrContainer = std::allocator<std::pair<Key, T>>,
 	class Bucket = bucket_type::standard>
-	using map_view = detail::table_view<Key, T, Hash, KeyEqual, AllocatorOrContainer, Bucket>;
+	using map_view = detail::table_view<Key, T, Hash, KeyEqual, Bucket>;
 
 }
 }
@@ -0,0 +1,682 @@
+#include "system_headless.hpp"
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+
+namespace minui {
+namespace headless {
+
+namespace {
+
+native_string to_native(std::filesystem::path const& p) {
+#ifdef _WIN64
+	return p.wstring();
+#else
+	return p.string();
+#endif
+}
+
+native_string ascii_to_native(std::string_view s) {
+	return native_string(s.begin(), s.end());
+}
+
+std::string native_to_ascii(native_string_view s) {
+	std::string result;
+	result.reserve(s.size());
+	for(auto c : s)
+		result.push_back(uint32_t(c) < 0x80 ? char(c) : '?');
+	return result;
+}
+
+}
+
+//
+// recorded draw commands
+//
+
+uint64_t draw_stream_hash(command_buffer const& commands, uint64_t seed) {
+	uint64_t h = seed;
+	auto mix = [&](int64_t v) {
+		h = (h ^ uint64_t(v)) * 0x100000001b3ull;
+	};
+	auto mix_rect = [&](screen_space_rect r) {
+		mix(r.x);
+		mix(r.y);
+		mix(r.width);
+		mix(r.height);
+	};
+	auto mix_float = [&](float f) {
+		uint32_t bits = 0;
+		std::memcpy(&bits, &f, sizeof(bits));
+		mix(bits);
+	};
+
+	commands.for_each([&](command_header const& hd, uint8_t const* payload) {
+		mix(int64_t(hd.type));
+		switch(hd.type) {
+			case command_type::rectangle:
+			case command_type::empty_rectangle:
+			{
+				auto c = command_buffer::read<rectangle_command>(payload);
+				mix_rect(c.rect);
+				mix(c.brush);
+				mix(int64_t(c.display_flags));
+				break;
+			}
+			case command_type::line:
+			{
+				auto c = command_buffer::read<line_command>(payload);
+				mix(c.start.x);
+				mix(c.start.y);
+				mix(c.end.x);
+				mix(c.end.y);
+				mix_float(c.width);
+				mix(c.brush);
+				break;
+			}
+			case command_type::interactable:
+			{
+				auto c = command_buffer::read<interactable_command>(payload);
+				mix(c.location.x);
+				mix(c.location.y);
+				mix(c.key);
+				mix(c.is_group);
+				mix(int64_t(c.orientation));
+				mix(int64_t(c.display_flags));
+				mix(c.fg_brush);
+				mix(c.hl_brush);
+				mix(c.info_brush);
+				mix(c.bg_brush);
+				break;
+			}
+			case command_type::image:
+			{
+				auto c = command_buffer::read<image_command>(payload);
+				mix(c.img.value);
+				mix_rect(c.rect);
+				mix(c.sub_slot);
+				break;
+			}
+			case command_type::background:
+			{
+				auto c = command_buffer::read<background_command>(payload);
+				mix(c.img.value);
+				mix_rect(c.rect);
+				mix(c.interior.x.value);
+				mix(c.interior.y.value);
+				mix(c.interior.width.value);
+				mix(c.interior.height.value);
+				mix(c.sub_slot);
+				mix(c.brush);
+				mix(int64_t(c.display_flags));
+				break;
+			}
+			case command_type::icon:
+			{
+				auto c = command_buffer::read<icon_command>(payload);
+				mix(c.ico.value);
+				mix_rect(c.rect);
+				mix(c.sub_slot);
+				mix(c.brush);
+				mix(int64_t(c.display_flags));
+				break;
+			}
+			case command_type::line_highlight_mode:
+				mix(command_buffer::read<line_highlight_mode_command>(payload).highlight_on);
+				break;
+			case command_type::clip:
+			{
+				auto c = command_buffer::read<clip_command>(payload);
+				mix_rect(c.rect);
+				mix(c.clip_on);
+				break;
+			}
+			case command_type::text:
+			{
+				auto c = command_buffer::read<text_command>(payload);
+				mix_rect(c.rect);
+				mix(c.starting_line);
+				mix(c.brush);
+				mix(c.font.id);
+				mix(int64_t(c.display_flags));
+				mix(c.in_focus);
+				mix(c.multiline);
+				auto chars = payload + sizeof(text_command);
+				for(uint32_t i = 0; i < c.length; ++i) {
+					native_char ch;
+					std::memcpy(&ch, chars + i * sizeof(native_char), sizeof(native_char));
+					mix(int64_t(ch));
+				}
+				break;
+			}
+		}
+	});
+	return h;
+}
+
+//
+// files
+//
+
+char const* fs_file::data() {
+	if(!loaded) {
+		loaded = true;
+		std::ifstream in(path, std::ios::binary);
+		if(in) {
+			in.seekg(0, std::ios::end);
+			auto sz = in.tellg();
+			in.seekg(0, std::ios::beg);
+			if(sz > 0) {
+				contents.resize(size_t(sz));
+				in.read(contents.data(), sz);
+			}
+		}
+	}
+	return contents.data();
+}
+size_t fs_file::size() {
+	data();
+	return contents.size();
+}
+native_string fs_file::name() {
+	return to_native(path.filename());
+}
+
+std::unique_ptr<file> fs_directory::open_file(native_string_view name) {
+	auto p = path / std::filesystem::path(native_string(name));
+	std::error_code ec;
+	if(!std::filesystem::is_regular_file(p, ec))
+		return nullptr;
+	return std::make_unique<fs_file>(std::move(p));
+}
+std::unique_ptr<directory> fs_directory::open_directory(native_string_view name) {
+	return std::make_unique<fs_directory>(path / std::filesystem::path(native_string(name)));
+}
+std::vector<std::unique_ptr<file>> fs_directory::list_files() {
+	std::vector<std::unique_ptr<file>> result;
+	std::error_code ec;
+	for(auto& e : std::filesystem::directory_iterator(path, ec)) {
+		if(e.is_regular_file(ec))
+			result.push_back(std::make_unique<fs_file>(e.path()));
+	}
+	std::sort(result.begin(), result.end(), [](auto const& a, auto const& b) { return static_cast<fs_file&>(*a).path < static_cast<fs_file&>(*b).path; });
+	return result;
+}
+std::vector<std::unique_ptr<directory>> fs_directory::list_directories() {
+	std::vector<std::unique_ptr<directory>> result;
+	std::error_code ec;
+	for(auto& e : std::filesystem::directory_iterator(path, ec)) {
+		if(e.is_directory(ec))
+			result.push_back(std::make_unique<fs_directory>(e.path()));
+	}
+	std::sort(result.begin(), result.end(), [](auto const& a, auto const& b) { return static_cast<fs_directory&>(*a).path < static_cast<fs_directory&>(*b).path; });
+	return result;
+}
+native_string fs_directory::name() {
+	return to_native(path.filename());
+}
+
+//
+// monospace layout
+//
+
+int32_t monospace_layout::count_lines(native_string_view t) const {
+	int32_t lines = 1;
+	int32_t column = 0;
+	for(auto c : t) {
+		if(c == NATIVE('\n')) {
+			++lines;
+			column = 0;
+			continue;
+		}
+		if(chars_per_line > 0 && column == chars_per_line) {
+			++lines;
+			column = 0;
+		}
+		++column;
+	}
+	return lines;
+}
+screen_space_point monospace_layout::position_of(native_string_view t, uint32_t index) const {
+	int32_t line = 0;
+	int32_t column = 0;
+	for(uint32_t i = 0; i < t.size(); ++i) {
+		if(t[i] == NATIVE('\n')) {
+			if(i == index)
+				return screen_space_point{ column, line };
+			++line;
+			column = 0;
+			continue;
+		}
+		if(chars_per_line > 0 && column == chars_per_line) {
+			++line;
+			column = 0;
+		}
+		if(i == index)
+			return screen_space_point{ column, line };
+		++column;
+	}
+	return screen_space_point{ column, line };
+}
+uint32_t monospace_layout::index_at(native_string_view t, int32_t column, int32_t target_line) const {
+	int32_t line = 0;
+	int32_t col = 0;
+	for(uint32_t i = 0; i < t.size(); ++i) {
+		if(t[i] == NATIVE('\n')) {
+			if(line == target_line)
+				return i;
+			++line;
+			col = 0;
+			continue;
+		}
+		if(chars_per_line > 0 && col == chars_per_line) {
+			if(line == target_line)
+				return i;
+			++line;
+			col = 0;
+		}
+		if(line == target_line && col == column)
+			return i;
+		++col;
+	}
+	return uint32_t(t.size());
+}
+int32_t monospace_layout::longest_line(native_string_view t) const {
+	int32_t longest = 0;
+	int32_t column = 0;
+	for(auto c : t) {
+		if(c == NATIVE('\n')) {
+			column = 0;
+			continue;
+		}
+		if(chars_per_line > 0 && column == chars_per_line)
+			column = 0;
+		++column;
+		longest = std::max(longest, column);
+	}
+	return longest;
+}
+
+monospace_layout system::get_monospace_layout(text::font_handle f, int32_t width) const {
+	float scale = (f && f.id < font_collection.size()) ? font_collection[f.id].scale : 1.0f;
+	monospace_layout result;
+	result.advance = std::max(1, int32_t(float(pixels_per_em) * scale / 2.0f));
+	result.line_height = std::max(1, int32_t(float(pixels_per_em) * scale));
+	result.chars_per_line = width > 0 ? std::max(1, width / result.advance) : 0;
+	return result;
+}
+
+//
+// text providers
+//
+
+template<typename base>
+monospace_layout text_provider_base<base>::get_layout(system_interface& s) const {
+	return static_cast<system&>(s).get_monospace_layout(font, multiline ? wrap_width : 0);
+}
+
+template<typename base>
+void text_provider_base<base>::redraw(system_interface& s) {
+	if(auto r = static_cast<system&>(s).minui_root; r)
+		invalidate_render(*r, attached);
+}
+template<typename base>
+void text_provider_base<base>::set_starting_display_line(system_interface& s, int32_t v) {
+	if(starting_line == v)
+		return;
+	starting_line = v;
+	redraw(s);
+}
+template<typename base>
+void text_provider_base<base>::set_text(system_interface& s, text::formatted_text&& t) {
+	// as the direct write provider does, unchanged text is left alone
+	if(internal_text.text_content == t.text_content)
+		return;
+	internal_text = std::move(t);
+	relayout(s);
+	redraw(s);
+}
+template<typename base>
+void text_provider_base<base>::set_alignment(system_interface& s, text::content_alignment a) {
+	if(alignment == a)
+		return;
+	alignment = a;
+	redraw(s);
+}
+template<typename base>
+void text_provider_base<base>::set_font(system_interface& s, text::font_handle f) {
+	if(font == f)
+		return;
+	font = f;
+	relayout(s);
+	redraw(s);
+}
+template<typename base>
+void text_provider_base<base>::set_is_multiline(system_interface& s, bool m) {
+	if(multiline == m)
+		return;
+	multiline = m;
+	relayout(s);
+	redraw(s);
+}
+template<typename base>
+int32_t text_provider_base<base>::get_number_of_displayed_lines(system_interface& s) {
+	if(displayed_height <= 0)
+		return lines_used;
+	return std::max(1, displayed_height / get_layout(s).line_height);
+}
+template<typename base>
+em text_provider_base<base>::get_single_line_width(system_interface& s) {
+	auto l = static_cast<system&>(s).get_monospace_layout(font, 0);
+	return s.to_ui_space(float(l.longest_line(internal_text.text_content) * l.advance));
+}
+template<typename base>
+em text_provider_base<base>::get_line_height(system_interface& s) {
+	return s.to_ui_space(float(get_layout(s).line_height));
+}
+template<typename base>
+void text_provider_base<base>::render(system_interface& s, layout_rect r, uint16_t brush, rendering_modifiers display_flags, bool in_focus) {
+	auto screen_rect = s.to_screen_space(r);
+	displayed_height = screen_rect.height;
+
+	text_command c{ screen_rect, uint32_t(internal_text.text_content.size()), starting_line, brush, font, display_flags, in_focus, multiline };
+	static_cast<system&>(s).commands.push(command_type::text, c, internal_text.text_content.data(), internal_text.text_content.size() * sizeof(native_char));
+}
+template<typename base>
+screen_space_rect text_provider_base<base>::get_character_bounds(system_interface& s, uint32_t position) const {
+	auto l = get_layout(s);
+	auto p = l.position_of(internal_text.text_content, position);
+	return screen_space_rect{ p.x * l.advance, (p.y - starting_line) * l.line_height, l.advance, l.line_height };
+}
+template<typename base>
+istatic_text::mouse_test_result text_provider_base<base>::get_position(system_interface& s, screen_space_point pt) {
+	auto l = get_layout(s);
+	native_string_view t = internal_text.text_content;
+
+	int32_t line = starting_line + (pt.y >= 0 ? pt.y / l.line_height : -1);
+	int32_t column = pt.x >= 0 ? pt.x / l.advance : -1;
+	bool inside = line >= 0 && line < lines_used && column >= 0;
+
+	auto index = l.index_at(t, std::max(column, 0), std::clamp(line, 0, std::max(lines_used - 1, 0)));
+	bool on_char = index < t.size() && t[index] != NATIVE('\n') && l.position_of(t, index).x == std::max(column, 0);
+	bool trailing = on_char && (pt.x - std::max(column, 0) * l.advance) * 2 >= l.advance;
+
+	return istatic_text::mouse_test_result{ index, on_char ? 1u : 0u, inside && on_char, trailing };
+}
+
+template class text_provider_base<static_text_provider>;
+template class text_provider_base<editable_text_provider>;
+
+void editable_text::set_read_only(system_interface& s, bool is_read_only) {
+	if(read_only == is_read_only)
+		return;
+	read_only = is_read_only;
+	redraw(s); // edit_control draws read only text as disabled
+}
+void editable_text::set_cursor_position(system_interface&, uint32_t p, bool extend_selection) {
+	cursor_position = std::min(p, uint32_t(internal_text.text_content.size()));
+	if(!extend_selection)
+		anchor_position = cursor_position;
+}
+void editable_text::insert_codepoint(system_interface& s, uint32_t codepoint) {
+	if(read_only)
+		return;
+	native_char c = native_char(codepoint);
+	insert_text(s, std::min(cursor_position, anchor_position), std::max(cursor_position, anchor_position), native_string_view(&c, 1));
+}
+void editable_text::insert_text(system_interface& s, uint32_t position_start, uint32_t position_end, native_string_view content) {
+	if(read_only)
+		return;
+	auto& t = internal_text.text_content;
+	position_start = std::min(position_start, uint32_t(t.size()));
+	position_end = std::clamp(position_end, position_start, uint32_t(t.size()));
+	t.replace(position_start, position_end - position_start, content);
+	internal_text.formatting_content.clear();
+	cursor_position = position_start + uint32_t(content.size());
+	anchor_position = cursor_position;
+	relayout(s);
+}
+void editable_text::send_command(system_interface& s, edit_command c, bool extend_selection) {
+	auto& t = internal_text.text_content;
+	auto sel_start = std::min(cursor_position, anchor_position);
+	auto sel_end = std::max(cursor_position, anchor_position);
+	auto l = get_layout(s);
+
+	switch(c) {
+		case edit_command::new_line:
+			if(multiline)
+				insert_codepoint(s, uint32_t('\n'));
+			break;
+		case edit_command::tab:
+			insert_codepoint(s, uint32_t('\t'));
+			break;
+		case edit_command::backspace:
+		case edit_command::backspace_word:
+			if(sel_start != sel_end)
+				insert_text(s, sel_start, sel_end, native_string_view{});
+			else if(cursor_position > 0)
+				insert_text(s, cursor_position - 1, cursor_position, native_string_view{});
+			break;
+		case edit_command::delete_char:
+		case edit_command::delete_word:
+			if(sel_start != sel_end)
+				insert_text(s, sel_start, sel_end, native_string_view{});
+			else if(cursor_position < t.size())
+				insert_text(s, cursor_position, cursor_position + 1, native_string_view{});
+			break;
+		case edit_command::delete_selection:
+			insert_text(s, sel_start, sel_end, native_string_view{});
+			break;
+		case edit_command::cursor_left:
+		case edit_command::cursor_left_word:
+			set_cursor_position(s, cursor_position > 0 ? cursor_position - 1 : 0, extend_selection);
+			break;
+		case edit_command::cursor_right:
+		case edit_command::cursor_right_word:
+			set_cursor_position(s, cursor_position + 1, extend_selection);
+			break;
+		case edit_command::cursor_up:
+		{
+			auto p = l.position_of(t, cursor_position);
+			if(p.y > 0)
+				set_cursor_position(s, l.index_at(t, p.x, p.y - 1), extend_selection);
+			break;
+		}
+		case edit_command::cursor_down:
+		{
+			auto p = l.position_of(t, cursor_position);
+			if(p.y + 1 < lines_used)
+				set_cursor_position(s, l.index_at(t, p.x, p.y + 1), extend_selection);
+			break;
+		}
+		case edit_command::to_line_start:
+			set_cursor_position(s, l.index_at(t, 0, l.position_of(t, cursor_position).y), extend_selection);
+			break;
+		case edit_command::to_line_end:
+		{
+			auto line = l.position_of(t, cursor_position).y;
+			set_cursor_position(s, line + 1 < lines_used ? l.index_at(t, 0, line + 1) - 1 : uint32_t(t.size()), extend_selection);
+			break;
+		}
+		case edit_command::to_text_start:
+			set_cursor_position(s, 0, extend_selection);
+			break;
+		case edit_command::to_text_end:
+			set_cursor_position(s, uint32_t(t.size()), extend_selection);
+			break;
+		case edit_command::cut:
+			if(sel_start != sel_end) {
+				s.text_to_clipboard(native_string_view(t).substr(sel_start, sel_end - sel_start));
+				insert_text(s, sel_start, sel_end, native_string_view{});
+			}
+			break;
+		case edit_command::copy:
+			if(sel_start != sel_end)
+				s.text_to_clipboard(native_string_view(t).substr(sel_start, sel_end - sel_start));
+			break;
+		case edit_command::paste:
+		{
+			auto content = s.text_from_clipboard();
+			insert_text(s, sel_start, sel_end, content);
+			break;
+		}
+		case edit_command::select_all:
+		case edit_command::select_current_section:
+			anchor_position = 0;
+			cursor_position = uint32_t(t.size());
+			break;
+		case edit_command::select_current_word:
+		{
+			auto is_word = [](native_char ch) { return ch != NATIVE(' ') && ch != NATIVE('\n') && ch != NATIVE('\t'); };
+			uint32_t start = std::min(cursor_position, uint32_t(t.size()));
+			uint32_t end = start;
+			while(start > 0 && is_word(t[start - 1]))
+				--start;
+			while(end < t.size() && is_word(t[end]))
+				++end;
+			anchor_position = start;
+			cursor_position = end;
+			break;
+		}
+		case edit_command::undo:
+		case edit_command::redo:
+			break;
+	}
+}
+ieditable_text::detailed_mouse_test_result editable_text::get_detailed_position(system_interface& s, screen_space_point pt) {
+	auto r = get_position(s, pt);
+	auto l = get_layout(s);
+	auto p = l.position_of(internal_text.text_content, r.position);
+	int32_t dx = pt.x - p.x * l.advance;
+	int32_t dy = pt.y - (p.y - starting_line) * l.line_height;
+	uint32_t quadrent = (dx * 2 >= l.advance ? 1u : 0u) + (dy * 2 >= l.line_height ? 2u : 0u);
+	return detailed_mouse_test_result{ r.position, quadrent };
+}
+
+//
+// system
+//
+
+void system::display_fatal_error_message(native_string_view msg) {
+	std::fprintf(stderr, "%s\n", native_to_ascii(msg).c_str());
+	std::abort();
+}
+
+void system::load_sound(sound_handle h, native_string_view file_name) {
+	if(h.value < 0)
+		return;
+	if(size_t(h.value) >= sound_collection.size())
+		sound_collection.resize(size_t(h.value) + 1);
+	sound_collection[h.value] = native_string(file_name);
+}
+
+void system::set_locale(native_string_view id) {
+	locale = native_string(id);
+	font_collection.clear();
+	text::reset(text_data);
+}
+
+void system::make_font_definition(text::font_handle slot, text::font&& font_object) {
+	if(slot.id >= font_collection.size())
+		font_collection.resize(size_t(slot.id) + 1);
+	font_collection[slot.id] = std::move(font_object);
+}
+
+void system::add_localization_file(native_string_view file_name) {
+	auto dir = get_root_directory();
+	auto locale_dir = dir->open_directory(NATIVE("locale"));
+	auto ind_dir = locale_dir->open_directory(locale);
+	auto f = ind_dir->open_file(file_name);
+	if(!f)
+		return;
+	auto start = f->data();
+	text::populate_with_file_content(text_data, start, start + f->size());
+}
+
+text::formatted_text system::fp_to_text(double value, int32_t precision, bool show_plus) {
+	text::formatted_text result;
+	if(std::isfinite(value)) {
+		char buffer[64] = { 0 };
+		std::snprintf(buffer, sizeof(buffer), show_plus ? "%+.*f" : "%.*f", int(std::max(precision, 0)), value);
+		result.text_content = ascii_to_native(buffer);
+		result.provided_attribues[0] = (value == 1.0 && precision == 0) ? text::attribute_type::one : text::attribute_type::other;
+		result.provided_attribues[1] = text::attribute_type::ord_other;
+		result.provided_attribues[2] = value == 0 ? text::attribute_type::z : text::attribute_type::undefined;
+	} else {
+		result.text_content = std::isnan(value) ? NATIVE("#NAN") : (value > 0 ? (show_plus ? NATIVE("+inf") : NATIVE("inf")) : NATIVE("-inf"));
+		result.provided_attribues[0] = text::attribute_type::other;
+		result.provided_attribues[1] = text::attribute_type::ord_other;
+	}
+	return result;
+}
+text::formatted_text system::int_to_text(int64_t value, bool show_plus) {
+	text::formatted_text result;
+	auto str = std::to_string(value);
+	result.text_content = ascii_to_native((show_plus && value >= 0) ? ("+" + str) : str);
+	result.provided_attribues[0] = std::abs(value) == 1 ? text::attribute_type::one : text::attribute_type::other;
+	result.provided_attribues[1] = text::attribute_type::ord_other;
+	result.provided_attribues[2] = value == 0 ? text::attribute_type::z : text::attribute_type::undefined;
+	return result;
+}
+int64_t system::text_to_int(native_string_view text) {
+	auto str = native_to_ascii(text);
+	return std::strtoll(str.c_str(), nullptr, 10);
+}
+double system::text_to_double(native_string_view text) {
+	auto str = native_to_ascii(text);
+	return std::strtod(str.c_str(), nullptr);
+}
+
+text::formatted_text system::perform_substitutions(text::text_source body_text, text::text_source const* parameters, size_t parameter_count) {
+	std::array<text::attribute_type, text::max_attributes> attr = { text::attribute_type::undefined };
+	return text::perform_substitutions(text_data, attr, body_text, parameters, parameter_count);
+}
+
+layout_position system::get_icon_size(icon_handle ico) {
+	if(ico.value < 0 || size_t(ico.value) >= icon_collection.size() || icon_collection[ico.value].sub_items.empty())
+		return layout_position{ em{ 0 }, em{ 0 } };
+	return icon_collection[ico.value].sub_items[0];
+}
+void system::add_to_icon_slot(icon_handle slot, native_string_view, em x_ems, em y_ems, int32_t sub_index) {
+	if(slot.value < 0 || sub_index < 0)
+		return;
+	if(size_t(slot.value) >= icon_collection.size())
+		icon_collection.resize(size_t(slot.value) + 1);
+	auto& items = icon_collection[slot.value].sub_items;
+	if(size_t(sub_index) >= items.size())
+		items.resize(size_t(sub_index) + 1);
+	items[sub_index] = layout_position{ x_ems, y_ems };
+}
+void system::add_to_image_slot(image_handle slot, native_string_view, em x_ems, em y_ems, int32_t sub_index) {
+	if(slot.value < 0 || sub_index < 0)
+		return;
+	if(size_t(slot.value) >= image_collection.size())
+		image_collection.resize(size_t(slot.value) + 1);
+	auto& items = image_collection[slot.value].sub_items;
+	if(size_t(sub_index) >= items.size())
+		items.resize(size_t(sub_index) + 1);
+	items[sub_index] = layout_position{ x_ems, y_ems };
+}
+
+void system::add_color_brush(uint16_t id, brush_color c, bool as_disabled) {
+	if(id >= brush_collection.size())
+		brush_collection.resize(size_t(id) + 1);
+	if(as_disabled)
+		brush_collection[id].disabled_color = c;
+	else
+		brush_collection[id].color = c;
+}
+void system::set_brush_highlights(uint16_t id, float line_shading, float highlight_shading, float line_highlight_shading) {
+	if(id >= brush_collection.size())
+		brush_collection.resize(size_t(id) + 1);
+	brush_collection[id].line_shading = line_shading;
+	brush_collection[id].highlight_shading = highlight_shading;
+	brush_collection[id].line_highlight_shading = line_highlight_shading;
+}
+
+}
+}
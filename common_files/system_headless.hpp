@@ -0,0 +1,599 @@
+#pragma once
+
+#include "minui_interfaces.hpp"
+#include "minui_text_impl.hpp"
+#include "draw_batching.hpp"
+#include "latency_tracker.hpp"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstring>
+#include <filesystem>
+#include <atomic>
+
+namespace minui {
+namespace headless {
+
+//
+// recorded draw commands
+//
+
+enum class command_type : uint8_t {
+	rectangle, empty_rectangle, line, interactable, image, background, icon, line_highlight_mode, text, clip
+};
+
+struct command_header {
+	command_type type;
+	uint8_t reserved = 0;
+	uint16_t reserved2 = 0;
+	uint32_t payload_size = 0;
+};
+
+struct rectangle_command {
+	screen_space_rect rect;
+	uint16_t brush;
+	rendering_modifiers display_flags;
+};
+struct line_command {
+	screen_space_point start;
+	screen_space_point end;
+	float width;
+	uint16_t brush;
+};
+struct interactable_command {
+	screen_space_point location;
+	int32_t key;
+	bool is_group;
+	interactable_orientation orientation;
+	rendering_modifiers display_flags;
+	uint16_t fg_brush;
+	uint16_t hl_brush;
+	uint16_t info_brush;
+	uint16_t bg_brush;
+};
+struct image_command {
+	image_handle img;
+	screen_space_rect rect;
+	int32_t sub_slot;
+};
+struct background_command {
+	image_handle img;
+	screen_space_rect rect;
+	layout_rect interior;
+	int32_t sub_slot;
+	uint16_t brush;
+	rendering_modifiers display_flags;
+};
+struct icon_command {
+	icon_handle ico;
+	screen_space_rect rect;
+	int32_t sub_slot;
+	uint16_t brush;
+	rendering_modifiers display_flags;
+};
+struct line_highlight_mode_command {
+	bool highlight_on;
+};
+struct clip_command {
+	screen_space_rect rect;
+	bool clip_on;
+};
+struct text_command { // followed by length native_chars
+	screen_space_rect rect;
+	uint32_t length;
+	int32_t starting_line;
+	uint16_t brush;
+	text::font_handle font;
+	rendering_modifiers display_flags;
+	bool in_focus;
+	bool multiline;
+};
+
+// a flat byte stream of command_header + payload records
+class command_buffer {
+public:
+	std::vector<uint8_t> data;
+	uint32_t command_count = 0;
+
+	template<typename T>
+	void push(command_type t, T const& payload, void const* extra = nullptr, size_t extra_size = 0) {
+		command_header h{ t, 0, 0, uint32_t(sizeof(T) + extra_size) };
+		auto at = data.size();
+		data.resize(at + sizeof(command_header) + sizeof(T) + extra_size);
+		std::memcpy(data.data() + at, &h, sizeof(command_header));
+		std::memcpy(data.data() + at + sizeof(command_header), &payload, sizeof(T));
+		if(extra_size != 0)
+			std::memcpy(data.data() + at + sizeof(command_header) + sizeof(T), extra, extra_size);
+		++command_count;
+	}
+	void clear() {
+		data.clear();
+		command_count = 0;
+	}
+
+	// f(command_header const&, uint8_t const* payload)
+	template<typename F>
+	void for_each(F&& f) const {
+		size_t pos = 0;
+		while(pos + sizeof(command_header) <= data.size()) {
+			command_header h;
+			std::memcpy(&h, data.data() + pos, sizeof(command_header));
+			f(h, data.data() + pos + sizeof(command_header));
+			pos += sizeof(command_header) + h.payload_size;
+		}
+	}
+	template<typename T>
+	static T read(uint8_t const* payload) {
+		T v;
+		std::memcpy(&v, payload, sizeof(T));
+		return v;
+	}
+};
+
+// Hashes the commands by their field values rather than their bytes, so padding inside the payloads does not
+// matter. Passing the previous result as the seed chains the streams of several frames.
+uint64_t draw_stream_hash(command_buffer const& commands, uint64_t seed = 0xcbf29ce484222325ull);
+
+//
+// files
+//
+
+class fs_file : public file {
+public:
+	std::filesystem::path path;
+	std::vector<char> contents;
+	bool loaded = false;
+
+	fs_file(std::filesystem::path p) : path(std::move(p)) { }
+
+	char const* data() final;
+	size_t size() final;
+	native_string name() final;
+};
+
+class fs_directory : public directory {
+public:
+	std::filesystem::path path;
+
+	fs_directory(std::filesystem::path p) : path(std::move(p)) { }
+
+	std::unique_ptr<file> open_file(native_string_view name) final;
+	std::unique_ptr<directory> open_directory(native_string_view name) final;
+	std::vector<std::unique_ptr<file>> list_files() final;
+	std::vector<std::unique_ptr<directory>> list_directories() final;
+	native_string name() final;
+};
+
+//
+// text
+//
+
+class system;
+
+// Monospace layout: every character advances half an em and every line is one em tall, scaled by the font's
+// scale. Lines break at newlines and, for multiline text, wherever the next character would pass the width.
+struct monospace_layout {
+	int32_t advance = 0; // screen space
+	int32_t line_height = 0; // screen space
+	int32_t chars_per_line = 0; // 0 for unlimited
+
+	int32_t count_lines(native_string_view t) const;
+	screen_space_point position_of(native_string_view t, uint32_t index) const; // in characters / lines
+	uint32_t index_at(native_string_view t, int32_t column, int32_t line) const;
+	int32_t longest_line(native_string_view t) const;
+};
+
+template<typename base>
+class text_provider_base : public base {
+public:
+	text::formatted_text internal_text;
+	ui_node& attached;
+	int32_t wrap_width = 0; // screen space, 0 before the first resize_to_width
+	int32_t displayed_height = 0; // screen space, from the last render
+	int32_t starting_line = 0;
+	int32_t lines_used = 1;
+	text::content_alignment alignment = text::content_alignment::leading;
+	text::font_handle font;
+	bool multiline = false;
+
+	text_provider_base(ui_node& attached) : attached(attached) { }
+
+	monospace_layout get_layout(system_interface& s) const;
+	void redraw(system_interface& s);
+	void relayout(system_interface& s) {
+		lines_used = multiline ? get_layout(s).count_lines(internal_text.text_content) : 1;
+	}
+
+	text::formatted_text_reference view_text(system_interface&) const final {
+		return internal_text;
+	}
+	// the setters that change what is drawn redraw the attached node
+	void set_text(system_interface& s, text::formatted_text&& t) final;
+	text::content_alignment get_alignment() const final {
+		return alignment;
+	}
+	void set_alignment(system_interface& s, text::content_alignment a) final;
+	text::font_handle get_font() const final {
+		return font;
+	}
+	void set_font(system_interface& s, text::font_handle f) final;
+	bool get_is_multiline() const final {
+		return multiline;
+	}
+	void set_is_multiline(system_interface& s, bool m) final;
+	int32_t get_number_of_displayed_lines(system_interface& s) final;
+	int32_t get_number_of_text_lines(system_interface&) final {
+		return lines_used;
+	}
+	int32_t get_starting_display_line() final {
+		return starting_line;
+	}
+	void set_starting_display_line(system_interface& s, int32_t v) final;
+	em get_single_line_width(system_interface& s) final;
+	em get_line_height(system_interface& s) final;
+	void resize_to_width(system_interface& s, int32_t w) final {
+		wrap_width = w;
+		relayout(s);
+	}
+	void render(system_interface& s, layout_rect r, uint16_t brush, rendering_modifiers display_flags = rendering_modifiers::none, bool in_focus = false) final;
+	screen_space_rect get_character_bounds(system_interface& s, uint32_t position) const final;
+	istatic_text::mouse_test_result get_position(system_interface& s, screen_space_point pt) final;
+};
+
+class static_text : public text_provider_base<static_text_provider> {
+public:
+	static_text(ui_node& attached) : text_provider_base<static_text_provider>(attached) { }
+};
+
+class editable_text : public text_provider_base<editable_text_provider> {
+public:
+	uint32_t cursor_position = 0;
+	uint32_t anchor_position = 0;
+	edit_contents contents = edit_contents::generic_text;
+	bool read_only = false;
+	bool has_focus = false;
+
+	editable_text(ui_node& attached) : text_provider_base<editable_text_provider>(attached) { }
+
+	edit_contents content_type() const final {
+		return contents;
+	}
+	uint32_t get_cursor_position() const final {
+		return cursor_position;
+	}
+	uint32_t get_cursor_position_under_point(system_interface& s, screen_space_point pt) final {
+		return get_position(s, pt).position;
+	}
+	void set_cursor_position(system_interface&, uint32_t p, bool extend_selection) final;
+	void insert_codepoint(system_interface& s, uint32_t codepoint) final;
+	void send_command(system_interface& s, edit_command c, bool extend_selection) final;
+	void insert_text(system_interface& s, uint32_t position_start, uint32_t position_end, native_string_view content) final;
+	uint32_t get_selection_anchor() const final {
+		return anchor_position;
+	}
+	void set_read_only(system_interface& s, bool is_read_only) final;
+	bool is_read_only() const final {
+		return read_only;
+	}
+	detailed_mouse_test_result get_detailed_position(system_interface& s, screen_space_point pt) final;
+	void on_focus(system_interface&) final {
+		has_focus = true;
+	}
+	void on_lose_focus(system_interface&) final {
+		has_focus = false;
+	}
+	void move_cursor_by_screen_pt(system_interface& s, screen_space_point pt, bool extend_selection) final {
+		set_cursor_position(s, get_position(s, pt).position, extend_selection);
+	}
+	void consume_mouse_event(system_interface&, int32_t, int32_t, uint32_t) final {
+	}
+};
+
+//
+// the system
+//
+
+// A system_interface without a window or a GPU. Everything drawn is appended to a command buffer,
+// text is laid out with monospace metrics, and files are read from a directory on disk.
+class system : public system_interface {
+public:
+	struct icon_slot {
+		std::vector<layout_position> sub_items;
+	};
+	struct brush_slot {
+		brush_color color;
+		brush_color disabled_color;
+		float line_shading = 0.0f;
+		float highlight_shading = 0.0f;
+		float line_highlight_shading = 0.0f;
+	};
+
+	// state changes needed to draw one submitted batch, as submitted and after sorting
+	struct batch_statistics {
+		uint32_t primitives = 0;
+		uint32_t state_changes_before = 0;
+		uint32_t state_changes_after = 0;
+	};
+
+	command_buffer commands;
+	std::vector<screen_space_rect> damaged_regions; // as passed to the last set_damaged_regions
+	// one entry per submit_primitives call, for the most recent batch_history_limit calls
+	static constexpr size_t batch_history_limit = 256;
+	std::deque<batch_statistics> batch_history;
+	std::vector<draw_primitive> batch;
+	draw_batching::sorter batch_sorter;
+
+	std::filesystem::path asset_root;
+	std::vector<text::font> font_collection;
+	std::vector<icon_slot> icon_collection;
+	std::vector<icon_slot> image_collection;
+	std::vector<brush_slot> brush_collection;
+	std::vector<native_string> sound_collection;
+	text::backing_arrays text_data;
+
+	root* minui_root = nullptr;
+	layout_position workspace;
+	int32_t pixels_per_em = 20;
+	native_string clipboard;
+	native_string window_title;
+	native_string locale;
+	native_string locale_name;
+	std::array<int32_t, 256> key_states = { 0 };
+	std::atomic<bool> update_posted = false;
+	uint32_t batches_submitted = 0;
+	uint32_t sounds_played = 0;
+	uint32_t animations_started = 0;
+	uint32_t frames_presented = 0;
+	latency_tracker* latency = nullptr; // told about each present, such as a root's tracker
+	bool left_to_right = true;
+	bool sort_batches = true;
+	bool cursor_visible = true;
+	bool minimized = false;
+	bool maximized = false;
+	bool closed = false;
+
+	system(std::filesystem::path asset_root, layout_position workspace, int32_t pixels_per_em = 20) : asset_root(std::move(asset_root)), workspace(workspace), pixels_per_em(pixels_per_em) {
+	}
+
+	void register_root(root& r) final {
+		minui_root = &r;
+	}
+
+	// WINDOW FUNCTIONS
+	layout_position get_workspace() const final {
+		return workspace;
+	}
+	void hide_mouse_cursor() final {
+		cursor_visible = false;
+	}
+	void show_mouse_cursor() final {
+		cursor_visible = true;
+	}
+	bool is_mouse_cursor_visible() const final {
+		return cursor_visible;
+	}
+	int32_t get_key_state(uint32_t scan_code) const final {
+		return scan_code < key_states.size() ? key_states[scan_code] : 0;
+	}
+	bool is_shift_held_down() const final {
+		return key_states[0x10] != 0;
+	}
+	bool is_ctrl_held_down() const final {
+		return key_states[0x11] != 0;
+	}
+	uint32_t get_window_dpi() const final {
+		return 96;
+	}
+	bool is_maximized() const final {
+		return maximized;
+	}
+	bool is_minimized() const final {
+		return minimized;
+	}
+	void maximize() final {
+		maximized = true;
+		minimized = false;
+	}
+	void minimize() final {
+		minimized = true;
+		maximized = false;
+	}
+	void restore() final {
+		minimized = false;
+		maximized = false;
+	}
+	void close() final {
+		closed = true;
+	}
+	void set_window_title(native_char const* t) final {
+		window_title = t;
+	}
+	bool window_has_focus() const final {
+		return true;
+	}
+
+	int32_t to_screen_space(em v) const final {
+		return int32_t(v.value) * pixels_per_em / 100;
+	}
+	screen_space_point to_screen_space(layout_position p) const final {
+		return screen_space_point{ to_screen_space(p.x), to_screen_space(p.y) };
+	}
+	screen_space_rect to_screen_space(layout_rect r) const final {
+		return screen_space_rect{ to_screen_space(r.x), to_screen_space(r.y), to_screen_space(r.width), to_screen_space(r.height) };
+	}
+	em to_ui_space(float v) const final {
+		return saturate_em(int32_t(v * 100.0f / float(pixels_per_em)));
+	}
+	layout_position to_ui_space(screen_space_point p) const final {
+		return layout_position{ to_ui_space(float(p.x)), to_ui_space(float(p.y)) };
+	}
+	layout_rect to_ui_space(screen_space_rect r) const final {
+		return layout_rect{ to_ui_space(float(r.x)), to_ui_space(float(r.y)), to_ui_space(float(r.width)), to_ui_space(float(r.height)) };
+	}
+
+	// SYSTEM FUNCTIONS
+	void display_fatal_error_message(native_string_view) final;
+	void text_to_clipboard(native_string_view t) final {
+		clipboard = native_string(t);
+	}
+	native_string text_from_clipboard() final {
+		return clipboard;
+	}
+
+	// FILE FUNCTIONS
+	std::unique_ptr<directory> get_root_directory() final {
+		return std::make_unique<fs_directory>(asset_root);
+	}
+
+	// SCHEDULING FUNCTIONS
+	void post_update_request() final {
+		update_posted.store(true, std::memory_order_release);
+	}
+	// true once per batch of posted requests
+	bool take_posted_update() {
+		return update_posted.exchange(false, std::memory_order_acq_rel);
+	}
+
+	// SOUND FUNCTIONS
+	void load_sound(sound_handle h, native_string_view file_name) final;
+	void play_sound(sound_handle) final {
+		++sounds_played;
+	}
+
+	// LOCALE FUNCTION
+	void set_locale(native_string_view id) final;
+	void set_locale_name(native_string name) final {
+		locale_name = std::move(name);
+	}
+	void set_ltr_mode(bool is_ltr) final {
+		left_to_right = is_ltr;
+	}
+	bool get_ltr() const final {
+		return left_to_right;
+	}
+	native_string_view get_locale_name() final {
+		return locale_name;
+	}
+	native_string_view get_locale() final {
+		return locale;
+	}
+
+	// TEXT FUNCTIONS
+	std::unique_ptr<static_text_provider> make_text(ui_node& n) final {
+		return std::make_unique<static_text>(n);
+	}
+	std::unique_ptr<editable_text_provider> make_editable_text(ui_node& n) final {
+		return std::make_unique<editable_text>(n);
+	}
+
+	void add_font_file_to_collection(native_string_view) final {
+	}
+	void finalize_font_collection() final {
+	}
+	void make_font_definition(text::font_handle slot, text::font&& font_object) final;
+	void add_font_fallback(text::font_handle, text::font_fallback&&) final {
+	}
+	void add_localization_file(native_string_view file_name) final;
+
+	text::handle get_hande(std::string_view key) final {
+		return text::lookup_entry(text_data, key);
+	}
+	text::formatted_text fp_to_text(double fp, int32_t precision, bool show_plus = false) final;
+	text::formatted_text int_to_text(int64_t value, bool show_plus = false) final;
+	int64_t text_to_int(native_string_view text) final;
+	double text_to_double(native_string_view text) final;
+
+	text::formatted_text perform_substitutions(text::text_source body_text, text::text_source const* parameters, size_t parameter_count) final;
+	text::variable get_text_variable(std::string_view name) final {
+		return text::get_variable(text_data, name);
+	}
+
+	monospace_layout get_monospace_layout(text::font_handle f, int32_t width) const;
+
+	// GRAPHICS FUNCTIONS
+	void rectangle(screen_space_rect content_rect, rendering_modifiers display_flags, uint16_t brush) final {
+		commands.push(command_type::rectangle, rectangle_command{ content_rect, brush, display_flags });
+	}
+	void empty_rectangle(screen_space_rect content_rect, rendering_modifiers display_flags, uint16_t brush) final {
+		commands.push(command_type::empty_rectangle, rectangle_command{ content_rect, brush, display_flags });
+	}
+	void line(screen_space_point start, screen_space_point end, float width, uint16_t brush) final {
+		commands.push(command_type::line, line_command{ start, end, width, brush });
+	}
+	void interactable(screen_space_point location, interactable_state state, uint16_t fg_brush, uint16_t hl_brush, uint16_t info_brush, uint16_t bg_brush, interactable_orientation o, rendering_modifiers display_flags = rendering_modifiers::none) final {
+		commands.push(command_type::interactable, interactable_command{ location, state.get_key(), state.holds_group(), o, display_flags, fg_brush, hl_brush, info_brush, bg_brush });
+	}
+	void image(image_handle img, screen_space_rect r, int32_t sub_slot = 0) final {
+		commands.push(command_type::image, image_command{ img, r, sub_slot });
+	}
+	void background(image_handle img, uint16_t brush, screen_space_rect r, layout_rect interior, rendering_modifiers display_flags = rendering_modifiers::none, int32_t sub_slot = 0) final {
+		commands.push(command_type::background, background_command{ img, r, interior, sub_slot, brush, display_flags });
+	}
+	void icon(icon_handle ico, screen_space_rect r, uint16_t br, rendering_modifiers display_flags = rendering_modifiers::none, int32_t sub_slot = 0) final {
+		commands.push(command_type::icon, icon_command{ ico, r, sub_slot, br, display_flags });
+	}
+	void set_line_highlight_mode(bool highlight_on) final {
+		commands.push(command_type::line_highlight_mode, line_highlight_mode_command{ highlight_on });
+	}
+	void set_clip(screen_space_rect r, bool clip_on) final {
+		commands.push(command_type::clip, clip_command{ r, clip_on });
+	}
+	void submit_primitives(std::span<const draw_primitive> primitives) final {
+		++batches_submitted;
+		batch.assign(primitives.begin(), primitives.end());
+		batch_statistics stats;
+		stats.primitives = uint32_t(primitives.size());
+		stats.state_changes_before = draw_batching::count_state_changes(batch);
+		if(sort_batches)
+			batch_sorter.sort(batch, *this);
+		stats.state_changes_after = draw_batching::count_state_changes(batch);
+		if(batch_history.size() == batch_history_limit)
+			batch_history.pop_front();
+		batch_history.push_back(stats);
+		system_interface::submit_primitives(batch);
+	}
+	void set_damaged_regions(std::span<const screen_space_rect> regions) final {
+		damaged_regions.assign(regions.begin(), regions.end());
+	}
+	// stands in for the swap chain present that follows a render
+	void present() {
+		++frames_presented;
+		if(latency)
+			latency->presented(latency_tracker::clock::now());
+	}
+
+	void stop_ui_animations() final {
+	}
+	void prepare_ui_animation() final {
+	}
+	void prepare_layered_ui_animation() final {
+	}
+	void start_ui_animation(animation_description) final {
+		++animations_started;
+	}
+	void register_in_place_animation() final {
+	}
+
+	layout_position get_icon_size(icon_handle ico) final;
+	void add_to_icon_slot(icon_handle slot, native_string_view file_name, em x_ems, em y_ems, int32_t sub_index) final;
+	void add_svg_to_icon_slot(icon_handle slot, native_string_view file_name, em x_ems, em y_ems, int32_t sub_index) final {
+		add_to_icon_slot(slot, file_name, x_ems, y_ems, sub_index);
+	}
+	int32_t get_icon_set_size(icon_handle ico) final {
+		return (ico.value >= 0 && size_t(ico.value) < icon_collection.size()) ? int32_t(icon_collection[ico.value].sub_items.size()) : 0;
+	}
+	void add_to_image_slot(image_handle slot, native_string_view file_name, em x_ems, em y_ems, int32_t sub_index) final;
+	int32_t get_image_set_size(image_handle img) final {
+		return (img.value >= 0 && size_t(img.value) < image_collection.size()) ? int32_t(image_collection[img.value].sub_items.size()) : 0;
+	}
+
+	void add_color_brush(uint16_t id, brush_color c, bool as_disabled) final;
+	void add_image_color_brush(uint16_t id, native_string_view, brush_color c, bool as_disabled) final {
+		add_color_brush(id, c, as_disabled);
+	}
+	void set_brush_highlights(uint16_t id, float line_shading, float highlight_shading, float line_highlight_shading) final;
+};
+
+}
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <cstddef>
+
+namespace minui {
+
+// A small work-stealing pool for fork-join style loops. Each worker owns a queue; it takes work from
+// the back of its own queue and steals from the front of the others when it runs dry. The thread calling
+// parallel_for takes part in the work and returns only once every index has been processed.
+class task_pool {
+	// one parallel_for call
+	struct batch {
+		std::function<void(size_t)> const* body = nullptr;
+		std::atomic<size_t> remaining = 0;
+		std::mutex error_lock;
+		std::exception_ptr error; // the first exception a job threw
+	};
+	struct job {
+		batch* owner = nullptr;
+		size_t index = 0;
+	};
+	struct worker_queue {
+		std::mutex lock;
+		std::deque<job> jobs;
+	};
+
+	std::vector<std::unique_ptr<worker_queue>> queues; // one per worker, plus one for the calling thread
+	std::vector<std::thread> workers;
+	std::mutex sleep_lock;
+	std::condition_variable wake;
+	std::atomic<ptrdiff_t> pending_jobs = 0; // may dip below zero while a batch is being published
+	bool shutting_down = false;
+
+	bool try_pop(size_t home, job& out) {
+		{
+			auto& q = *queues[home];
+			std::lock_guard lg(q.lock);
+			if(!q.jobs.empty()) {
+				out = q.jobs.back();
+				q.jobs.pop_back();
+				return true;
+			}
+		}
+		for(size_t i = 1; i < queues.size(); ++i) {
+			auto& q = *queues[(home + i) % queues.size()];
+			std::lock_guard lg(q.lock);
+			if(!q.jobs.empty()) {
+				out = q.jobs.front();
+				q.jobs.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+	static void run(job const& j) {
+		try {
+			(*j.owner->body)(j.index);
+		} catch(...) {
+			std::lock_guard lg(j.owner->error_lock);
+			if(!j.owner->error)
+				j.owner->error = std::current_exception();
+		}
+		j.owner->remaining.fetch_sub(1, std::memory_order_acq_rel);
+	}
+	void worker_loop(size_t home) {
+		while(true) {
+			job j;
+			if(try_pop(home, j)) {
+				pending_jobs.fetch_sub(1, std::memory_order_acq_rel);
+				run(j);
+				continue;
+			}
+			std::unique_lock ul(sleep_lock);
+			wake.wait(ul, [&]() { return shutting_down || pending_jobs.load(std::memory_order_acquire) > 0; });
+			if(shutting_down)
+				return;
+		}
+	}
+public:
+	// thread_count includes the calling thread; a pool of 1 runs everything inline
+	explicit task_pool(uint32_t thread_count) {
+		if(thread_count == 0)
+			thread_count = 1;
+		for(uint32_t i = 0; i < thread_count; ++i)
+			queues.push_back(std::make_unique<worker_queue>());
+		for(uint32_t i = 1; i < thread_count; ++i)
+			workers.emplace_back([this, i]() { worker_loop(i); });
+	}
+	~task_pool() {
+		{
+			std::lock_guard lg(sleep_lock);
+			shutting_down = true;
+		}
+		wake.notify_all();
+		for(auto& w : workers)
+			w.join();
+	}
+	task_pool(task_pool const&) = delete;
+	task_pool& operator=(task_pool const&) = delete;
+
+	uint32_t thread_count() const {
+		return uint32_t(queues.size());
+	}
+
+	// runs body(0) ... body(count - 1), possibly concurrently. If any of them throws, the first exception
+	// is rethrown on the calling thread once every index has been processed.
+	void parallel_for(size_t count, std::function<void(size_t)> const& body) {
+		if(count == 0)
+			return;
+		batch b;
+		b.body = &body;
+		b.remaining.store(count, std::memory_order_relaxed);
+		if(workers.empty() || count == 1) {
+			for(size_t i = 0; i < count; ++i)
+				run(job{ &b, i });
+			if(b.error)
+				std::rethrow_exception(b.error);
+			return;
+		}
+
+		// the jobs are queued before the count is raised, so no worker wakes up to empty queues; one that
+		// takes a job first only pushes the count below zero until it is published
+		for(size_t i = 0; i < count; ++i) {
+			auto& q = *queues[i % queues.size()];
+			std::lock_guard lg(q.lock);
+			q.jobs.push_back(job{ &b, i });
+		}
+		{
+			std::lock_guard lg(sleep_lock);
+			pending_jobs.fetch_add(ptrdiff_t(count), std::memory_order_acq_rel);
+		}
+		wake.notify_all();
+
+		while(b.remaining.load(std::memory_order_acquire) != 0) {
+			job j;
+			if(try_pop(0, j)) {
+				pending_jobs.fetch_sub(1, std::memory_order_acq_rel);
+				run(j);
+			} else {
+				std::this_thread::yield();
+			}
+		}
+		if(b.error)
+			std::rethrow_exception(b.error);
+	}
+};
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "minui_interfaces.hpp"
+
+#include <stdint.h>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <memory_resource>
+
+namespace minui {
+
+// Runs an update pass over a tree. Nodes are updated depth first, as update_subtree does, except for nodes
+// whose type opts in with behavior::update_batched. The walk sets those aside, subtree and all. Once it
+// ends, the functions of the nodes set aside run grouped by type, one type's function over all of its
+// nodes in a tight loop, and then the walk continues depth first into each of their subtrees in tree order,
+// setting aside the batched nodes it meets there for the next round. So a node's function only runs once
+// every ancestor has been fully updated, the nodes of one type in a round are updated in tree order, and a
+// tree without batched types is updated exactly as a depth first walk would.
+//
+// A large round is taken in slices of chunk_size nodes, so that the nodes each step touches are still in the
+// cache for the next step; a slice still gives each type's function a run long enough to stay hot.
+//
+// Node needs type_id, behavior_flags, begin_update(Context&), update_children(Context&,
+// std::pmr::vector<Node*>&) and on_update(Context&); function_of(type_id) gives something callable as
+// f(Context&, Node&).
+template<typename Node, typename Context>
+class update_scheduler {
+	std::vector<Node*> pending; // of the depth first walk, next on top
+	std::pmr::vector<Node*> children;
+	std::vector<Node*> set_aside; // for the next round
+	std::vector<Node*> round;
+	std::vector<std::vector<Node*>> buckets; // by type id; kept between passes so they stop allocating
+	std::vector<uint32_t> types_seen; // that have nodes in buckets, in the order first seen
+
+	void push_children(Context& c, Node& n) {
+		children.clear();
+		n.update_children(c, children);
+		pending.insert(pending.end(), children.rbegin(), children.rend());
+	}
+	template<typename FunctionOf>
+	void walk(Context& c, FunctionOf& function_of) {
+		while(!pending.empty()) {
+			auto n = pending.back();
+			pending.pop_back();
+			switch(n->begin_update(c)) {
+				case update_mode::skip:
+					continue;
+				case update_mode::whole_subtree:
+					n->on_update(c);
+					continue;
+				case update_mode::with_function:
+					if((n->behavior_flags & behavior::update_batched) != 0) {
+						set_aside.push_back(n);
+						continue;
+					}
+					function_of(n->type_id)(c, *n);
+					break;
+				case update_mode::no_function:
+					break;
+			}
+			push_children(c, *n);
+		}
+	}
+	template<typename FunctionOf>
+	void run_slice(Context& c, std::span<Node* const> nodes, FunctionOf& function_of) {
+		for(auto n : nodes) {
+			if(n->type_id >= buckets.size())
+				buckets.resize(n->type_id + 1);
+			if(buckets[n->type_id].empty())
+				types_seen.push_back(n->type_id);
+			buckets[n->type_id].push_back(n);
+		}
+		for(auto t : types_seen) {
+			auto&& fn = function_of(t);
+			for(auto n : buckets[t])
+				fn(c, *n);
+			functions_batched += uint32_t(buckets[t].size());
+			buckets[t].clear();
+			++batches;
+		}
+		types_seen.clear();
+
+		for(auto n : nodes) {
+			push_children(c, *n);
+			walk(c, function_of);
+		}
+	}
+public:
+	static constexpr size_t chunk_size = 512;
+
+	// of the last pass
+	uint32_t rounds = 0; // of batches, after the first walk
+	uint32_t batches = 0; // runs of one type's function
+	uint32_t functions_batched = 0;
+
+	template<typename FunctionOf>
+	void run(Context& c, Node& top, FunctionOf&& function_of) {
+		rounds = 0;
+		batches = 0;
+		functions_batched = 0;
+
+		set_aside.clear();
+		pending.clear();
+		pending.push_back(&top);
+		walk(c, function_of);
+		while(!set_aside.empty()) {
+			++rounds;
+			std::swap(round, set_aside);
+			set_aside.clear();
+			for(size_t start = 0; start < round.size(); start += chunk_size)
+				run_slice(c, std::span<Node* const>(round).subspan(start, std::min(chunk_size, round.size() - start)), function_of);
+		}
+	}
+};
+
+}
@@ -1,7 +1,131 @@
 #define CATCH_CONFIG_MAIN 1
+#define CATCH_CONFIG_ENABLE_BENCHMARKING 1
 #include "catch.hpp"
 
 #include "../common_files/minui_text_impl.cpp"
+#include "../common_files/task_pool.hpp"
+#include "../common_files/system_headless.cpp"
+#include "../common_files/minui_core_impl.cpp"
+#include "../common_files/damage_tracker.hpp"
+#include "../common_files/software_rasterizer.cpp"
+#include "../common_files/frame_arena.hpp"
+#include "../common_files/spsc_queue.hpp"
+#include "../common_files/input_replay.hpp"
+#include "../common_files/update_scheduler.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <map>
+#include <set>
+#include <thread>
+#include <stdexcept>
+#include <unordered_map>
+
+// every allocation made through a replaced global operator new, for checking that steady state work allocates
+// nothing; all the forms are replaced, so that each new is paired with its own delete
+static std::atomic<uint64_t> global_allocations = 0;
+
+static void* counted_allocation(std::size_t size) noexcept {
+	global_allocations.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size != 0 ? size : 1);
+}
+static void* counted_allocation(std::size_t size, std::align_val_t al) noexcept {
+	global_allocations.fetch_add(1, std::memory_order_relaxed);
+	auto alignment = static_cast<std::size_t>(al);
+	size = size != 0 ? (size + alignment - 1) / alignment * alignment : alignment;
+#ifdef _MSC_VER
+	return _aligned_malloc(size, alignment);
+#else
+	return std::aligned_alloc(alignment, size);
+#endif
+}
+static void counted_free(void* p, std::align_val_t) noexcept {
+#ifdef _MSC_VER
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size) {
+	if(auto p = counted_allocation(size); p)
+		return p;
+	throw std::bad_alloc{ };
+}
+void* operator new[](std::size_t size) {
+	if(auto p = counted_allocation(size); p)
+		return p;
+	throw std::bad_alloc{ };
+}
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept {
+	return counted_allocation(size);
+}
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+	return counted_allocation(size);
+}
+void* operator new(std::size_t size, std::align_val_t al) {
+	if(auto p = counted_allocation(size, al); p)
+		return p;
+	throw std::bad_alloc{ };
+}
+void* operator new[](std::size_t size, std::align_val_t al) {
+	if(auto p = counted_allocation(size, al); p)
+		return p;
+	throw std::bad_alloc{ };
+}
+void* operator new(std::size_t size, std::align_val_t al, std::nothrow_t const&) noexcept {
+	return counted_allocation(size, al);
+}
+void* operator new[](std::size_t size, std::align_val_t al, std::nothrow_t const&) noexcept {
+	return counted_allocation(size, al);
+}
+
+// gcc inlines these into new-expressions and then takes the free for a mismatch with the new
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, std::nothrow_t const&) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p, std::nothrow_t const&) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, std::align_val_t al) noexcept {
+	counted_free(p, al);
+}
+void operator delete[](void* p, std::align_val_t al) noexcept {
+	counted_free(p, al);
+}
+void operator delete(void* p, std::size_t, std::align_val_t al) noexcept {
+	counted_free(p, al);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t al) noexcept {
+	counted_free(p, al);
+}
+void operator delete(void* p, std::align_val_t al, std::nothrow_t const&) noexcept {
+	counted_free(p, al);
+}
+void operator delete[](void* p, std::align_val_t al, std::nothrow_t const&) noexcept {
+	counted_free(p, al);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
 
 TEST_CASE("file loading", "text parsing") {
@@ -18,7 +142,7 @@ TEST_CASE("file loading", "text parsing") {
 	REQUIRE(bool(keyB) == true);
 
 	auto entry_text = minui::text::perform_substitutions(container, { minui::text::attribute_type::undefined }, keyB, nullptr, 0);
-	REQUIRE(entry_text.text_content == L"more text");
+	REQUIRE(entry_text.text_content == NATIVE("more text"));
 }
 
 TEST_CASE("substitutions A", "text parsing") {
@@ -45,7 +169,7 @@ TEST_CASE("substitutions A", "text parsing") {
 	
 	{
 		minui::text::formatted_text value_0;
-		value_0.text_content = L"0";
+		value_0.text_content = NATIVE("0");
 		value_0.provided_attribues[0] = minui::text::attribute_type::other;
 		value_0.provided_attribues[1] = minui::text::attribute_type::z;
 		value_0.provided_attribues[2] = minui::text::attribute_type::undefined;
@@ -53,31 +177,2488 @@ TEST_CASE("substitutions A", "text parsing") {
 		minui::text::text_source parameters[] = { minui::text::text_source{ value_0, x1 }, minui::text::text_source{ apple, v1 } };
 		auto entry_text = minui::text::perform_substitutions(container, { minui::text::attribute_type::undefined }, body, parameters, 2);
 
-		REQUIRE(entry_text.text_content == L"I have no apples.");
+		REQUIRE(entry_text.text_content == NATIVE("I have no apples."));
 	}
 
 	{
 		minui::text::formatted_text value_1;
-		value_1.text_content = L"1";
+		value_1.text_content = NATIVE("1");
 		value_1.provided_attribues[0] = minui::text::attribute_type::one;
 		value_1.provided_attribues[1] = minui::text::attribute_type::undefined;
 
 		minui::text::text_source parameters[] = { minui::text::text_source{ value_1, x1 }, minui::text::text_source{ apple, v1 } };
 		auto entry_text = minui::text::perform_substitutions(container, { minui::text::attribute_type::undefined }, body, parameters, 2);
 
-		REQUIRE(entry_text.text_content == L"I have an apple.");
+		REQUIRE(entry_text.text_content == NATIVE("I have an apple."));
 	}
 
 	{
 		minui::text::formatted_text value_3;
-		value_3.text_content = L"3";
+		value_3.text_content = NATIVE("3");
 		value_3.provided_attribues[0] = minui::text::attribute_type::other;
 		value_3.provided_attribues[1] = minui::text::attribute_type::undefined;
 
 		minui::text::text_source parameters[] = { minui::text::text_source{ value_3, x1 }, minui::text::text_source{ apple, v1 } };
 		auto entry_text = minui::text::perform_substitutions(container, { minui::text::attribute_type::undefined }, body, parameters, 2);
 
-		REQUIRE(entry_text.text_content == L"I have 3 apples.");
+		REQUIRE(entry_text.text_content == NATIVE("I have 3 apples."));
 	}
 	
-}
\ No newline at end of file
+}
+
+TEST_CASE("parallel for", "task pool") {
+	for(uint32_t threads : { 1u, 2u, 4u, 8u }) {
+		minui::task_pool pool(threads);
+		REQUIRE(pool.thread_count() == threads);
+
+		std::vector<std::atomic<int32_t>> visits(1000);
+		pool.parallel_for(visits.size(), [&](size_t i) { visits[i].fetch_add(1); });
+		for(auto& v : visits)
+			REQUIRE(v.load() == 1);
+
+		// the pool can be reused and nested loops complete
+		std::atomic<int32_t> total = 0;
+		pool.parallel_for(16, [&](size_t) {
+			pool.parallel_for(16, [&](size_t) { total.fetch_add(1); });
+		});
+		REQUIRE(total.load() == 256);
+
+		// an exception reaches the caller once every index has run, and the pool still works after it
+		std::atomic<int32_t> ran = 0;
+		REQUIRE_THROWS_AS(pool.parallel_for(64, [&](size_t i) {
+			ran.fetch_add(1);
+			if(i % 16 == 3)
+				throw std::runtime_error("job failed");
+		}), std::runtime_error);
+		REQUIRE(ran.load() == 64);
+		ran = 0;
+		pool.parallel_for(64, [&](size_t) { ran.fetch_add(1); });
+		REQUIRE(ran.load() == 64);
+	}
+}
+
+TEST_CASE("em arithmetic saturates", "layout coordinates") {
+	minui::em big{ 30000 };
+	REQUIRE((big + big).value == INT16_MAX);
+	REQUIRE((minui::em{ -30000 } - big).value == INT16_MIN);
+	REQUIRE((big * 4).value == INT16_MAX);
+	REQUIRE((big + 500).value == INT16_MAX);
+
+	// 3/4 of a 300 em wide window used to wrap around in the intermediate product
+	REQUIRE(minui::scale_em(minui::em{ 30000 }, 3, 4).value == 22500);
+	REQUIRE(minui::scale_em(minui::em{ 30000 }, 2, 3).value == 20000);
+
+	minui::layout_position a{ minui::em{ 32000 }, minui::em{ -32000 } };
+	auto sum = a + a;
+	REQUIRE(sum.x.value == INT16_MAX);
+	REQUIRE(sum.y.value == INT16_MIN);
+}
+
+TEST_CASE("content coordinates", "layout coordinates") {
+	minui::content_position total = minui::to_content(minui::layout_position{ minui::em{ 20000 }, minui::em{ 100 } });
+	for(int32_t i = 0; i < 10; ++i) {
+		total = total + minui::layout_position{ minui::em{ 20000 }, minui::em{ -20000 } };
+	}
+	REQUIRE(total.x.value == 220000);
+	REQUIRE(total.y.value == -199900);
+
+	auto clamped = minui::to_layout(total);
+	REQUIRE(clamped.x.value == INT16_MAX);
+	REQUIRE(clamped.y.value == INT16_MIN);
+
+	auto back = minui::to_layout(total - total + minui::layout_position{ minui::em{ 1234 }, minui::em{ -4321 } });
+	REQUIRE(back.x.value == 1234);
+	REQUIRE(back.y.value == -4321);
+}
+
+struct headless_test_node : public minui::ui_node {
+	size_t size() const override {
+		return sizeof(headless_test_node);
+	}
+	void render(minui::root&, minui::layout_position, minui::postponed_list&) override {
+	}
+	minui::probe_result mouse_probe(minui::root&, minui::layout_position, minui::layout_position, minui::postponed_list&) override {
+		return minui::probe_result{ };
+	}
+	minui::interactable_result interactable_layout(minui::root&) override {
+		return minui::interactable_result{ };
+	}
+	void on_update(minui::root&) override {
+	}
+};
+
+TEST_CASE("headless draw recording", "headless") {
+	minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 2000 }, minui::em{ 1000 } }, 20);
+
+	s.rectangle(minui::screen_space_rect{ 1, 2, 3, 4 }, minui::rendering_modifiers::none, 5);
+	s.icon(minui::icon_handle{ 7 }, minui::screen_space_rect{ 0, 0, 20, 20 }, 2);
+
+	headless_test_node n;
+	minui::headless::static_text t(n);
+	minui::text::formatted_text ft;
+	ft.text_content = NATIVE("hello world");
+	t.set_text(s, std::move(ft));
+	t.render(s, minui::layout_rect{ minui::em{ 100 }, minui::em{ 0 }, minui::em{ 600 }, minui::em{ 100 } }, 3);
+
+	REQUIRE(s.commands.command_count == 3);
+
+	std::vector<minui::headless::command_type> types;
+	s.commands.for_each([&](minui::headless::command_header const& h, uint8_t const* payload) {
+		types.push_back(h.type);
+		if(h.type == minui::headless::command_type::text) {
+			auto c = minui::headless::command_buffer::read<minui::headless::text_command>(payload);
+			REQUIRE(c.rect.x == 20);
+			REQUIRE(c.length == 11);
+			REQUIRE(h.payload_size == sizeof(minui::headless::text_command) + 11 * sizeof(minui::native_char));
+		}
+	});
+	REQUIRE(types == std::vector<minui::headless::command_type>{ minui::headless::command_type::rectangle, minui::headless::command_type::icon, minui::headless::command_type::text });
+}
+
+TEST_CASE("headless monospace text", "headless") {
+	minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 2000 }, minui::em{ 1000 } }, 20);
+	headless_test_node n;
+
+	minui::headless::static_text t(n);
+	t.set_is_multiline(s, true);
+	t.resize_to_width(s, 50); // 10 pixel advance -> 5 characters per line
+	minui::text::formatted_text ft;
+	ft.text_content = NATIVE("hello world");
+	t.set_text(s, std::move(ft));
+
+	REQUIRE(t.get_number_of_text_lines(s) == 3);
+	REQUIRE(t.get_line_height(s).value == 100);
+	REQUIRE(t.get_single_line_width(s).value == 550);
+
+	auto bounds = t.get_character_bounds(s, 6);
+	REQUIRE(bounds.x == 10);
+	REQUIRE(bounds.y == 20);
+
+	auto hit = t.get_position(s, minui::screen_space_point{ 12, 25 });
+	REQUIRE(hit.position == 6);
+	REQUIRE(hit.inside);
+	REQUIRE(!hit.trailing);
+
+	minui::headless::editable_text e(n);
+	e.insert_text(s, 0, 0, NATIVE("abc"));
+	e.send_command(s, minui::ieditable_text::edit_command::cursor_left, true);
+	e.send_command(s, minui::ieditable_text::edit_command::copy, false);
+	REQUIRE(s.text_from_clipboard() == NATIVE("c"));
+	e.send_command(s, minui::ieditable_text::edit_command::backspace, false);
+	REQUIRE(std::basic_string_view<minui::native_char>(e.view_text(s).text_content, e.view_text(s).text_length) == NATIVE("ab"));
+}
+
+TEST_CASE("damage tracker regions", "headless") {
+	minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 4000 }, minui::em{ 3000 } }, 20);
+	minui::damage_tracker damage;
+	auto frame = [&]() {
+		damage.set_bounds(minui::screen_space_rect{ 0, 0, 800, 600 });
+		s.set_damaged_regions(damage.get_regions());
+		damage.clear();
+	};
+
+	// the first frame is drawn in full
+	frame();
+	REQUIRE(s.damaged_regions.size() == 1);
+	REQUIRE(s.damaged_regions[0].width == 800);
+	REQUIRE(s.damaged_regions[0].height == 600);
+
+	// nothing changed
+	frame();
+	REQUIRE(s.damaged_regions.empty());
+
+	// hover moves between two distant buttons: both, and only both, are redrawn
+	damage.add(minui::screen_space_rect{ 20, 20, 100, 40 });
+	damage.add(minui::screen_space_rect{ 600, 500, 100, 40 });
+	frame();
+	REQUIRE(s.damaged_regions.size() == 2);
+
+	// hover moves between neighbouring buttons in a column: one region
+	damage.add(minui::screen_space_rect{ 20, 100, 100, 40 });
+	damage.add(minui::screen_space_rect{ 20, 140, 100, 40 });
+	frame();
+	REQUIRE(s.damaged_regions.size() == 1);
+	REQUIRE(s.damaged_regions[0].y == 100);
+	REQUIRE(s.damaged_regions[0].height == 80);
+
+	// typing into an edit box damages the box repeatedly
+	for(int i = 0; i < 5; ++i)
+		damage.add(minui::screen_space_rect{ 200, 300, 300, 30 });
+	frame();
+	REQUIRE(s.damaged_regions.size() == 1);
+	REQUIRE(s.damaged_regions[0].width == 300);
+
+	// showing prompts over many controls stays under the region cap and keeps the prompts covered
+	damage.max_regions = 4;
+	for(int i = 0; i < 12; ++i)
+		damage.add(minui::screen_space_rect{ 10 + i * 60, 10 + (i % 3) * 200, 20, 20 });
+	frame();
+	REQUIRE(s.damaged_regions.size() == 4);
+	for(int i = 0; i < 12; ++i) {
+		minui::screen_space_rect p{ 10 + i * 60, 10 + (i % 3) * 200, 20, 20 };
+		bool covered = false;
+		for(auto& r : s.damaged_regions)
+			covered = covered || (r.x <= p.x && r.y <= p.y && p.x + p.width <= r.x + r.width && p.y + p.height <= r.y + r.height);
+		REQUIRE(covered);
+	}
+
+	// damage outside the workspace is dropped, and a resize redraws everything
+	damage.add(minui::screen_space_rect{ 900, 700, 10, 10 });
+	frame();
+	REQUIRE(s.damaged_regions.empty());
+	damage.set_bounds(minui::screen_space_rect{ 0, 0, 1024, 768 });
+	s.set_damaged_regions(damage.get_regions());
+	REQUIRE(s.damaged_regions.size() == 1);
+	REQUIRE(s.damaged_regions[0].width == 1024);
+}
+
+TEST_CASE("batched primitive submission", "headless") {
+	minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 2000 }, minui::em{ 1000 } }, 20);
+	headless_test_node n;
+	minui::headless::static_text t(n);
+
+	std::vector<minui::draw_primitive> batch;
+	batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 0, 0, 100, 20 }, .brush = 1, .type = minui::primitive_type::rectangle });
+	batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 4, 2, 16, 16 }, .handle = 3, .sub_slot = 2, .brush = 2, .type = minui::primitive_type::icon });
+	batch.push_back(minui::draw_primitive{ .layout = minui::layout_rect{ minui::em{ 100 }, minui::em{ 0 }, minui::em{ 400 }, minui::em{ 100 } }, .text = &t, .brush = 4, .type = minui::primitive_type::text });
+	s.submit_primitives(batch);
+
+	REQUIRE(s.batches_submitted == 1);
+	REQUIRE(s.commands.command_count == 3);
+
+	std::vector<minui::headless::command_type> types;
+	s.commands.for_each([&](minui::headless::command_header const& h, uint8_t const* payload) {
+		types.push_back(h.type);
+		if(h.type == minui::headless::command_type::icon) {
+			auto c = minui::headless::command_buffer::read<minui::headless::icon_command>(payload);
+			REQUIRE(c.ico.value == 3);
+			REQUIRE(c.sub_slot == 2);
+		}
+	});
+	REQUIRE(types == std::vector<minui::headless::command_type>{ minui::headless::command_type::rectangle, minui::headless::command_type::icon, minui::headless::command_type::text });
+}
+
+TEST_CASE("state sorted batching", "headless") {
+	minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 2000 }, minui::em{ 1000 } }, 20);
+
+	SECTION("separate buttons group by brush") {
+		// a row of buttons, each a background rectangle with an icon on top
+		std::vector<minui::draw_primitive> batch;
+		for(int32_t i = 0; i < 10; ++i) {
+			batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ i * 30, 0, 24, 24 }, .brush = 1, .type = minui::primitive_type::rectangle });
+			batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ i * 30 + 4, 4, 16, 16 }, .handle = 2, .brush = 3, .type = minui::primitive_type::icon });
+		}
+		s.submit_primitives(batch);
+
+		REQUIRE(s.batch_history.size() == 1);
+		REQUIRE(s.batch_history[0].primitives == 20);
+		REQUIRE(s.batch_history[0].state_changes_before == 19);
+		REQUIRE(s.batch_history[0].state_changes_after == 1);
+
+		std::vector<minui::headless::command_type> types;
+		s.commands.for_each([&](minui::headless::command_header const& h, uint8_t const*) {
+			types.push_back(h.type);
+		});
+		REQUIRE(types.size() == 20);
+		for(size_t i = 0; i < 10; ++i) {
+			REQUIRE(types[i] == minui::headless::command_type::rectangle);
+			REQUIRE(types[i + 10] == minui::headless::command_type::icon);
+		}
+	}
+	SECTION("overlapping primitives keep their order") {
+		std::vector<minui::draw_primitive> batch;
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 0, 0, 50, 50 }, .brush = 1, .type = minui::primitive_type::rectangle });
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 25, 25, 50, 50 }, .brush = 2, .type = minui::primitive_type::rectangle });
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 50, 50, 50, 50 }, .brush = 1, .type = minui::primitive_type::rectangle });
+		s.submit_primitives(batch);
+
+		REQUIRE(s.batch_history[0].state_changes_before == 2);
+		REQUIRE(s.batch_history[0].state_changes_after == 2);
+
+		std::vector<uint16_t> brushes;
+		s.commands.for_each([&](minui::headless::command_header const&, uint8_t const* payload) {
+			brushes.push_back(minui::headless::command_buffer::read<minui::headless::rectangle_command>(payload).brush);
+		});
+		REQUIRE(brushes == std::vector<uint16_t>{ 1, 2, 1 });
+	}
+	SECTION("highlight mode is preserved") {
+		std::vector<minui::draw_primitive> batch;
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 0, 0, 10, 10 }, .brush = 1, .type = minui::primitive_type::empty_rectangle });
+		batch.push_back(minui::draw_primitive{ .type = minui::primitive_type::line_highlight_mode, .flag = true });
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 20, 0, 10, 10 }, .brush = 2, .type = minui::primitive_type::empty_rectangle });
+		batch.push_back(minui::draw_primitive{ .type = minui::primitive_type::line_highlight_mode, .flag = false });
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 40, 0, 10, 10 }, .brush = 2, .type = minui::primitive_type::empty_rectangle });
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 60, 0, 10, 10 }, .brush = 1, .type = minui::primitive_type::empty_rectangle });
+		s.submit_primitives(batch);
+
+		// the highlighted rectangle may not join the unhighlighted one with the same brush
+		std::vector<std::pair<uint16_t, bool>> drawn;
+		bool highlight = false;
+		s.commands.for_each([&](minui::headless::command_header const& h, uint8_t const* payload) {
+			if(h.type == minui::headless::command_type::line_highlight_mode)
+				highlight = minui::headless::command_buffer::read<minui::headless::line_highlight_mode_command>(payload).highlight_on;
+			else
+				drawn.emplace_back(minui::headless::command_buffer::read<minui::headless::rectangle_command>(payload).brush, highlight);
+		});
+		REQUIRE(highlight == false);
+		REQUIRE(drawn == std::vector<std::pair<uint16_t, bool>>{ { 1, false }, { 1, false }, { 2, true }, { 2, false } });
+		REQUIRE(s.batch_history[0].state_changes_after < s.batch_history[0].state_changes_before);
+	}
+	SECTION("only recent batches are kept") {
+		auto limit = minui::headless::system::batch_history_limit;
+		for(size_t i = 0; i < limit + 10; ++i) {
+			std::vector<minui::draw_primitive> batch(i % 4 + 1, minui::draw_primitive{ .rect = minui::screen_space_rect{ 0, 0, 10, 10 }, .brush = 1, .type = minui::primitive_type::rectangle });
+			s.submit_primitives(batch);
+		}
+		REQUIRE(s.batch_history.size() == limit);
+		REQUIRE(s.batch_history.back().primitives == uint32_t((limit + 9) % 4 + 1));
+		REQUIRE(s.batch_history.front().primitives == uint32_t(10 % 4 + 1));
+	}
+}
+
+TEST_CASE("clip rectangles", "headless") {
+	minui::layout_rect workspace{ minui::em{ 0 }, minui::em{ 0 }, minui::em{ 2000 }, minui::em{ 1000 } };
+	minui::layout_rect inside{ minui::em{ 100 }, minui::em{ 100 }, minui::em{ 500 }, minui::em{ 200 } };
+	minui::layout_rect straddling{ minui::em{ 1800 }, minui::em{ 900 }, minui::em{ 500 }, minui::em{ 500 } };
+	minui::layout_rect outside{ minui::em{ 2000 }, minui::em{ 0 }, minui::em{ 500 }, minui::em{ 500 } };
+
+	REQUIRE(minui::intersects(workspace, inside));
+	REQUIRE(minui::intersects(workspace, straddling));
+	REQUIRE(!minui::intersects(workspace, outside)); // touching the edge is not overlapping
+	REQUIRE(minui::contains(workspace, inside));
+	REQUIRE(!minui::contains(workspace, straddling));
+	REQUIRE(minui::contains(inside, minui::layout_position{ minui::em{ 100 }, minui::em{ 299 } }));
+	REQUIRE(!minui::contains(inside, minui::layout_position{ minui::em{ 600 }, minui::em{ 150 } })); // the far edges are outside
+	REQUIRE(!minui::contains(inside, minui::layout_position{ minui::em{ 150 }, minui::em{ 300 } }));
+
+	auto i = minui::intersection(workspace, straddling);
+	REQUIRE(i.x.value == 1800);
+	REQUIRE(i.y.value == 900);
+	REQUIRE(i.width.value == 200);
+	REQUIRE(i.height.value == 100);
+	REQUIRE(minui::intersection(workspace, outside).width.value == 0);
+
+	SECTION("clip changes reach the backend and stop reordering") {
+		minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 2000 }, minui::em{ 1000 } }, 20);
+		std::vector<minui::draw_primitive> batch;
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 0, 0, 10, 10 }, .brush = 1, .type = minui::primitive_type::rectangle });
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 20, 0, 10, 10 }, .brush = 2, .type = minui::primitive_type::rectangle });
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 0, 0, 100, 100 }, .type = minui::primitive_type::clip, .flag = true });
+		batch.push_back(minui::draw_primitive{ .rect = minui::screen_space_rect{ 40, 0, 10, 10 }, .brush = 1, .type = minui::primitive_type::rectangle });
+		batch.push_back(minui::draw_primitive{ .type = minui::primitive_type::clip, .flag = false });
+		s.submit_primitives(batch);
+
+		std::vector<minui::headless::command_type> types;
+		std::vector<bool> clips;
+		s.commands.for_each([&](minui::headless::command_header const& h, uint8_t const* payload) {
+			types.push_back(h.type);
+			if(h.type == minui::headless::command_type::clip)
+				clips.push_back(minui::headless::command_buffer::read<minui::headless::clip_command>(payload).clip_on);
+		});
+		REQUIRE(types == std::vector<minui::headless::command_type>{ minui::headless::command_type::rectangle, minui::headless::command_type::rectangle, minui::headless::command_type::clip, minui::headless::command_type::rectangle, minui::headless::command_type::clip });
+		REQUIRE(clips == std::vector<bool>{ true, false });
+	}
+}
+
+TEST_CASE("frame arena", "frame memory") {
+	minui::frame_arena arena;
+	arena.initial_size = 256;
+
+	// the transient lists of a frame: pop-ups found while walking the tree, and per container scratch
+	auto frame = [&](int32_t count) {
+		minui::postponed_list pop_ups(&arena);
+		for(int32_t i = 0; i < count; ++i) {
+			std::pmr::vector<minui::layout_rect> covers(size_t(i % 8), &arena);
+			pop_ups.push_back(minui::postponed_render{ nullptr, minui::layout_position{ minui::em{ int16_t(i) }, minui::em{ 0 } } });
+		}
+		REQUIRE(pop_ups.size() == size_t(count));
+		REQUIRE(pop_ups.back().offset.x.value == count - 1);
+	};
+
+	SECTION("allocations are aligned and come from the arena") {
+		auto a = arena.allocate(3, 1);
+		auto b = arena.allocate(8, 64);
+		REQUIRE(reinterpret_cast<uintptr_t>(b) % 64 == 0);
+		REQUIRE(static_cast<std::byte*>(b) > static_cast<std::byte*>(a));
+		arena.deallocate(b, 8, 64);
+		arena.reset();
+		REQUIRE(arena.allocate(3, 1) == a); // reset rewinds to the start
+		REQUIRE(arena.heap_blocks == 1);
+	}
+	SECTION("steady state frames allocate nothing") {
+		// the first frame outgrows the initial block; the reset merges what it took into one block
+		frame(400);
+		REQUIRE(arena.heap_blocks > 1);
+		arena.reset();
+		auto blocks = arena.heap_blocks;
+		auto capacity = arena.capacity();
+
+		auto before = global_allocations.load();
+		for(int32_t i = 0; i < 10; ++i) {
+			frame(400);
+			arena.reset();
+		}
+		auto after = global_allocations.load();
+		REQUIRE(after == before);
+		REQUIRE(arena.heap_blocks == blocks);
+		REQUIRE(arena.capacity() == capacity);
+
+		// a bigger frame grows the arena once, then it settles again
+		frame(4000);
+		arena.reset();
+		before = global_allocations.load();
+		frame(4000);
+		arena.reset();
+		after = global_allocations.load();
+		REQUIRE(after == before);
+	}
+}
+
+TEST_CASE("single producer queue", "input queue") {
+	SECTION("values come out in order until the queue is full") {
+		minui::spsc_queue<int32_t> q(5);
+		REQUIRE(q.capacity() == 8);
+		for(int32_t i = 0; i < 8; ++i)
+			REQUIRE(q.push(i));
+		REQUIRE(!q.push(8));
+
+		int32_t v = -1;
+		for(int32_t i = 0; i < 8; ++i) {
+			REQUIRE(q.pop(v));
+			REQUIRE(v == i);
+		}
+		REQUIRE(!q.pop(v));
+		REQUIRE(q.empty());
+	}
+	SECTION("a second thread can feed it") {
+		minui::spsc_queue<uint32_t> q(64);
+		constexpr uint32_t count = 100000;
+		std::thread producer([&]() {
+			for(uint32_t i = 0; i < count; ) {
+				if(q.push(i))
+					++i;
+				else
+					std::this_thread::yield();
+			}
+		});
+		uint32_t received = 0;
+		bool in_order = true;
+		while(received < count) {
+			uint32_t v = 0;
+			if(q.pop(v)) {
+				in_order = in_order && v == received;
+				++received;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+		producer.join();
+		REQUIRE(in_order);
+		REQUIRE(q.empty());
+	}
+}
+
+TEST_CASE("input queue throughput", "[.][benchmark]") {
+	// the size of the root's queued input events
+	struct event {
+		uint32_t words[8] = { };
+		std::chrono::steady_clock::time_point at{ };
+	};
+	minui::spsc_queue<event> q(1024);
+	BENCHMARK("post and drain 1024 events") {
+		for(uint32_t i = 0; i < 1024; ++i)
+			q.push(event{ { i } });
+		event e;
+		uint32_t sum = 0;
+		while(q.pop(e))
+			sum += e.words[0];
+		return sum;
+	};
+}
+
+TEST_CASE("input latency", "latency") {
+	using clock = minui::latency_tracker::clock;
+	using namespace std::chrono_literals;
+	minui::latency_tracker latency;
+	auto t0 = clock::time_point{ } + 1s;
+
+	SECTION("each presented frame after input is one sample, from the earliest input") {
+		latency.input_arrived(t0 + 2ms);
+		latency.input_arrived(t0);
+		latency.input_handled(t0 + 3ms);
+		latency.layout_done(t0 + 5ms);
+		latency.render_done(t0 + 9ms);
+		latency.input_arrived(t0 + 10ms); // too late for this frame
+		latency.presented(t0 + 16ms);
+
+		auto samples = latency.recent();
+		REQUIRE(samples.size() == 1);
+		REQUIRE(samples[0].handled == 3ms);
+		REQUIRE(samples[0].laid_out == 5ms);
+		REQUIRE(samples[0].rendered == 9ms);
+		REQUIRE(samples[0].presented == 16ms);
+
+		latency.presented(t0 + 32ms); // nothing new was rendered
+		REQUIRE(latency.total_samples == 1);
+
+		// stages that did not run end with the next one
+		latency.render_done(t0 + 40ms);
+		latency.presented(t0 + 48ms);
+		REQUIRE(latency.total_samples == 2);
+		REQUIRE(latency.recent().back().handled == 30ms);
+		REQUIRE(latency.recent().back().presented == 38ms);
+	}
+	SECTION("input that changes nothing on screen is not a sample") {
+		latency.input_arrived(t0);
+		latency.nothing_to_render();
+		latency.render_done(t0 + 1ms);
+		latency.presented(t0 + 2ms);
+		REQUIRE(latency.total_samples == 0);
+	}
+	SECTION("percentiles cover the kept samples") {
+		for(int32_t i = 1; i <= 300; ++i) {
+			auto at = t0 + i * 100ms;
+			latency.input_arrived(at);
+			latency.render_done(at);
+			latency.presented(at + i * 1ms);
+		}
+		REQUIRE(latency.total_samples == 300);
+		auto samples = latency.recent();
+		REQUIRE(samples.size() == minui::latency_tracker::history_size);
+		REQUIRE(samples.front().presented == 45ms);
+		REQUIRE(samples.back().presented == 300ms);
+
+		auto p = latency.presented_percentiles();
+		REQUIRE(p.samples == 256);
+		REQUIRE(p.p50 == 172ms);
+		REQUIRE(p.p90 == 275ms);
+		REQUIRE(p.p99 == 298ms);
+		REQUIRE(p.max == 300ms);
+	}
+	SECTION("the headless backend reports presents") {
+		minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 2000 }, minui::em{ 1000 } }, 20);
+		s.latency = &latency;
+		latency.input_arrived(clock::now());
+		latency.render_done(clock::now());
+		s.present();
+		REQUIRE(s.frames_presented == 1);
+		REQUIRE(latency.total_samples == 1);
+		REQUIRE(latency.recent()[0].presented >= latency.recent()[0].rendered);
+		REQUIRE(latency.summary().find("over 1 frames") != std::string::npos);
+	}
+}
+
+// stands in for minui::root: draws a marker where the mouse is and a bar as long as the keys pressed so far
+struct replay_test_root {
+	minui::headless::system& s;
+	minui::layout_position mouse{ };
+	int32_t keys = 0;
+	int32_t updates = 0;
+	bool dirty = true;
+	std::vector<std::chrono::steady_clock::time_point> frames{ };
+
+	bool on_mouse_move(minui::layout_position p) {
+		mouse = p;
+		dirty = true;
+		return true;
+	}
+	bool on_mouse_lbutton(minui::click_type t) {
+		keys += 1 + int32_t(t);
+		dirty = true;
+		return true;
+	}
+	bool on_mouse_rbutton() {
+		return true;
+	}
+	bool on_mouse_lbutton_up() {
+		return true;
+	}
+	bool on_mouse_rbutton_up() {
+		return true;
+	}
+	bool on_mouse_scroll(float amount) {
+		keys += int32_t(amount * 10.0f);
+		dirty = true;
+		return true;
+	}
+	bool on_key_down(uint32_t, uint32_t vk_code, bool repeat) {
+		keys += int32_t(vk_code) + (repeat ? 1000 : 0);
+		dirty = true;
+		return true;
+	}
+	bool on_key_up(uint32_t, uint32_t) {
+		return true;
+	}
+	bool on_char(minui::native_char c) {
+		keys += int32_t(c);
+		dirty = true;
+		return true;
+	}
+	void on_workspace_resized(minui::resize_type, minui::layout_position) {
+		dirty = true;
+	}
+	void on_update() {
+		++updates;
+	}
+	void request_update() {
+		dirty = true;
+	}
+	void request_layout() {
+		dirty = true;
+	}
+	bool advance_frame(std::chrono::steady_clock::time_point now) {
+		frames.push_back(now);
+		return dirty;
+	}
+	void render() {
+		dirty = false;
+		s.rectangle(s.to_screen_space(minui::layout_rect{ mouse.x, mouse.y, minui::em{ 100 }, minui::em{ 100 } }), minui::rendering_modifiers::none, 0);
+		s.rectangle(minui::screen_space_rect{ 0, 0, keys, 10 }, minui::rendering_modifiers::none, 1);
+	}
+};
+
+TEST_CASE("input replay", "replay") {
+	using minui::replay::entry;
+	using minui::replay::entry_type;
+	using namespace std::chrono_literals;
+	auto origin = std::chrono::steady_clock::time_point{ } + 1h;
+
+	// a short session: the mouse moves over two frames, then a click, a key with a repeat and a resize
+	auto record_session = [](int16_t second_x) {
+		minui::replay::recorder rec(std::chrono::steady_clock::time_point{ });
+		rec.add(entry{ .type = entry_type::mouse_move, .time = 1000, .a = 100, .b = 200 });
+		rec.add(entry{ .type = entry_type::frame, .time = 1500 });
+		rec.add(entry{ .type = entry_type::render, .time = 1600 });
+		rec.add(entry{ .type = entry_type::mouse_move, .time = 17000, .a = second_x, .b = -300 });
+		rec.add(entry{ .type = entry_type::mouse_lbutton, .time = 17100, .a = int32_t(minui::click_type::doublec) });
+		rec.add(entry{ .type = entry_type::mouse_scroll, .time = 17200, .amount = -1.5f });
+		rec.add(entry{ .type = entry_type::key_down, .time = 17300, .a = 0x1E, .b = 0x41, .c = 0 });
+		rec.add(entry{ .type = entry_type::key_down, .time = 17400, .a = 0x1E, .b = 0x41, .c = 1 });
+		rec.add(entry{ .type = entry_type::key_up, .time = 17500, .a = 0x1E, .b = 0x41 });
+		rec.add(entry{ .type = entry_type::character, .time = 17500, .a = 'a' });
+		rec.add(entry{ .type = entry_type::update, .time = 17600 });
+		rec.add(entry{ .type = entry_type::frame, .time = 18000 });
+		rec.add(entry{ .type = entry_type::render, .time = 18100 });
+		rec.add(entry{ .type = entry_type::workspace_resized, .time = 20000, .a = int32_t(minui::resize_type::normal), .b = 3000, .c = 1500 });
+		rec.add(entry{ .type = entry_type::frame, .time = 33000 });
+		rec.add(entry{ .type = entry_type::render, .time = 33100 });
+		rec.add(entry{ .type = entry_type::frame, .time = 50000 }); // nothing changed
+		return std::vector<uint8_t>(rec.data().begin(), rec.data().end());
+	};
+	auto replay = [&](std::span<const uint8_t> recording) {
+		minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 2000 }, minui::em{ 1000 } }, 20);
+		replay_test_root r{ s };
+		auto result = minui::replay::run(recording, r, s, origin);
+		return std::make_pair(result, r);
+	};
+	auto session = record_session(400);
+
+	SECTION("entries read back as written") {
+		minui::replay::reader in(session);
+		std::vector<entry> entries;
+		while(auto e = in.next())
+			entries.push_back(*e);
+		REQUIRE(!in.failed);
+		REQUIRE(entries.size() == 17);
+		REQUIRE(entries[3].type == entry_type::mouse_move);
+		REQUIRE(entries[3].time == 17000);
+		REQUIRE(entries[3].b == -300);
+		REQUIRE(entries[5].amount == -1.5f);
+		REQUIRE(entries[7].c == 1);
+		REQUIRE(entries[9].a == 'a');
+		REQUIRE(entries[13].b == 3000);
+		REQUIRE(session.size() < 17 * 6); // compact
+	}
+	SECTION("replays are deterministic") {
+		auto [first, r1] = replay(session);
+		auto [second, r2] = replay(session);
+		REQUIRE(first.complete);
+		REQUIRE(first.entries == 17);
+		REQUIRE(first.frames.size() == 3);
+		REQUIRE(first.frames[1].time == 18100);
+		REQUIRE(first.frames[1].commands == 2);
+		REQUIRE(first.draw_hash == second.draw_hash);
+
+		REQUIRE(r1.updates == 1);
+		REQUIRE(r1.keys == 2 + (-15) + 0x41 + (0x41 + 1000) + 'a');
+		REQUIRE(r1.frames.size() == 4);
+		REQUIRE(r1.frames[1] == origin + 18000us);
+	}
+	SECTION("a different session draws differently") {
+		auto [first, r1] = replay(session);
+		auto [other, r2] = replay(record_session(500));
+		REQUIRE(other.frames.size() == first.frames.size());
+		REQUIRE(other.draw_hash != first.draw_hash);
+	}
+	SECTION("files round trip and damaged recordings are reported") {
+		auto path = std::filesystem::temp_directory_path() / "minui_replay_test.bin";
+		minui::replay::recorder rec(std::chrono::steady_clock::time_point{ });
+		minui::replay::reader in(session);
+		while(auto e = in.next())
+			rec.add(*e);
+		REQUIRE(rec.save(path));
+		auto loaded = minui::replay::load(path);
+		std::filesystem::remove(path);
+		REQUIRE(loaded == session);
+
+		loaded.pop_back(); // inside the last entry's time
+		auto [cut, r] = replay(loaded);
+		REQUIRE(!cut.complete);
+		REQUIRE(cut.frames.size() == 3);
+	}
+}
+
+struct update_test_node;
+
+struct update_test_context {
+	using function = void (*)(update_test_context&, update_test_node&);
+	std::array<function, 8> functions = { };
+	std::vector<update_test_node*> visited; // in the order the functions ran
+	bool record = false;
+	uint64_t sum = 0;
+};
+
+// A node with the update hooks of minui::ui_node. on_update is the depth first walk the core types did
+// before the update pass was scheduled by type; a node marked own_update keeps the default begin_update.
+struct update_test_node {
+	update_test_node* parent = nullptr;
+	uint32_t type_id = 0;
+	uint32_t behavior_flags = 0;
+	uint32_t depth = 0;
+	bool hidden = false;
+	bool own_update = false;
+	uint64_t value = 0;
+	std::vector<update_test_node*> children;
+
+	virtual minui::update_mode begin_update(update_test_context&) {
+		if(own_update)
+			return minui::update_mode::whole_subtree;
+		return hidden ? minui::update_mode::skip : minui::update_mode::with_function;
+	}
+	virtual void update_children(update_test_context&, std::pmr::vector<update_test_node*>& next) {
+		next.insert(next.end(), children.begin(), children.end());
+	}
+	virtual void on_update(update_test_context& c) {
+		if(hidden)
+			return;
+		c.functions[type_id](c, *this);
+		for(auto ch : children)
+			ch->on_update(c);
+	}
+	virtual ~update_test_node() = default;
+};
+
+// stands in for a user update function; every type gets a body of its own, a few kilobytes of code
+template<uint32_t T, size_t... I>
+uint64_t synthetic_mix(uint64_t h, std::index_sequence<I...>) {
+	((h = (h ^ (h >> ((I * 7 + T) % 29 + 3))) * (0x9E3779B97F4A7C15ull + 2 * (I * 8 + T))), ...);
+	return h;
+}
+template<uint32_t T>
+void synthetic_update(update_test_context& c, update_test_node& n) {
+	c.sum += synthetic_mix<T>(n.value, std::make_index_sequence<160>{ });
+	if(c.record)
+		c.visited.push_back(&n);
+}
+
+// a tree of node_count nodes with up to eight children each, whose types are interleaved among siblings
+static std::vector<std::unique_ptr<update_test_node>> make_update_tree(uint32_t node_count) {
+	std::vector<std::unique_ptr<update_test_node>> nodes;
+	nodes.reserve(node_count);
+	uint64_t seed = 0x9E3779B97F4A7C15ull;
+	auto next_random = [&]() {
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		return seed;
+	};
+	nodes.push_back(std::make_unique<update_test_node>());
+	for(uint32_t i = 0; nodes.size() < node_count; ++i) {
+		auto p = nodes[i].get();
+		auto count = 2 + uint32_t(next_random() % 7);
+		for(uint32_t j = 0; j < count && nodes.size() < node_count; ++j) {
+			auto n = std::make_unique<update_test_node>();
+			n->parent = p;
+			n->depth = p->depth + 1;
+			n->type_id = uint32_t(next_random() % 8);
+			n->value = next_random();
+			p->children.push_back(n.get());
+			nodes.push_back(std::move(n));
+		}
+	}
+	return nodes;
+}
+
+static void set_update_functions(update_test_context& c) {
+	c.functions = { synthetic_update<0>, synthetic_update<1>, synthetic_update<2>, synthetic_update<3>, synthetic_update<4>, synthetic_update<5>, synthetic_update<6>, synthetic_update<7> };
+}
+
+TEST_CASE("update scheduling", "update") {
+	auto nodes = make_update_tree(5000);
+	// the root has at least two children, each with at least two children
+	nodes[2]->children[0]->hidden = true;
+	nodes[1]->children[0]->own_update = true;
+	nodes[1]->children[1]->hidden = true;
+	nodes[1]->children[1]->own_update = true;
+
+	update_test_context c;
+	set_update_functions(c);
+	c.record = true;
+
+	nodes[0]->on_update(c);
+	auto walked = c.visited;
+	auto walked_sum = c.sum;
+
+	minui::update_scheduler<update_test_node, update_test_context> scheduler;
+	auto schedule = [&]() {
+		c.visited.clear();
+		c.sum = 0;
+		scheduler.run(c, *nodes[0], [&](uint32_t t) { return c.functions[t]; });
+		return c.visited;
+	};
+
+	// by default nothing is batched and the pass is the depth first walk
+	REQUIRE(schedule() == walked);
+	REQUIRE(scheduler.rounds == 0);
+	REQUIRE(scheduler.batches == 0);
+
+	// two of the eight types opt in
+	for(auto& n : nodes) {
+		if(n->type_id == 1 || n->type_id == 3)
+			n->behavior_flags = minui::behavior::update_batched;
+	}
+	auto scheduled = schedule();
+
+	// the node updating its own subtree does so depth first, batched types or not
+	auto under_own = [](update_test_node* n) {
+		for(auto p = n; p; p = p->parent)
+			if(p->own_update)
+				return true;
+		return false;
+	};
+	auto set_aside = [&](update_test_node* n) {
+		for(auto p = n; p; p = p->parent)
+			if(p->behavior_flags != 0)
+				return !under_own(n);
+		return false;
+	};
+
+	SECTION("the same nodes are updated") {
+		REQUIRE(scheduled.size() == walked.size());
+		REQUIRE(c.sum == walked_sum);
+		auto a = walked;
+		auto b = scheduled;
+		std::sort(a.begin(), a.end());
+		std::sort(b.begin(), b.end());
+		REQUIRE(a == b);
+		// nothing under a hidden node
+		for(auto n : scheduled) {
+			for(auto p = n; p; p = p->parent)
+				REQUIRE(!p->hidden);
+		}
+	}
+	SECTION("parents before children") {
+		std::unordered_map<update_test_node*, size_t> position;
+		for(size_t i = 0; i < scheduled.size(); ++i)
+			position[scheduled[i]] = i;
+		for(auto n : scheduled) {
+			if(n->parent)
+				REQUIRE(position.at(n->parent) < position.at(n));
+		}
+	}
+	SECTION("nodes outside batched subtrees keep depth first order") {
+		auto a = walked;
+		auto b = scheduled;
+		std::erase_if(a, set_aside);
+		std::erase_if(b, set_aside);
+		REQUIRE(!a.empty());
+		REQUIRE(a == b);
+		// and run before anything set aside
+		REQUIRE(std::equal(a.begin(), a.end(), scheduled.begin()));
+	}
+	SECTION("the first round runs each batched type once, in tree order") {
+		// the batched nodes with no batched ancestor
+		auto first_round = [&](uint32_t type) {
+			std::vector<update_test_node*> out;
+			for(auto n : walked) {
+				if(n->type_id == type && set_aside(n) && (!n->parent || !set_aside(n->parent)))
+					out.push_back(n);
+			}
+			return out;
+		};
+		auto ones = first_round(1);
+		auto threes = first_round(3);
+		REQUIRE(ones.size() + threes.size() <= scheduler.chunk_size);
+		auto first = scheduled.begin() + std::ptrdiff_t(walked.size() - std::count_if(walked.begin(), walked.end(), set_aside));
+		std::vector<update_test_node*> batch(first, first + std::ptrdiff_t(ones.size() + threes.size()));
+		REQUIRE(((batch[0]->type_id == 1 && std::equal(ones.begin(), ones.end(), batch.begin()) && std::equal(threes.begin(), threes.end(), batch.begin() + std::ptrdiff_t(ones.size())))
+			|| (batch[0]->type_id == 3 && std::equal(threes.begin(), threes.end(), batch.begin()) && std::equal(ones.begin(), ones.end(), batch.begin() + std::ptrdiff_t(threes.size())))));
+	}
+	SECTION("batched functions are counted once per run") {
+		uint32_t batched = 0;
+		for(auto n : scheduled) {
+			if(n->behavior_flags != 0 && !under_own(n))
+				++batched;
+		}
+		REQUIRE(scheduler.functions_batched == batched);
+		REQUIRE(scheduler.rounds >= 1);
+		// at most one batch per type for each slice of a round
+		REQUIRE(scheduler.batches >= scheduler.rounds);
+		REQUIRE(scheduler.batches <= 2 * (scheduler.rounds + batched / scheduler.chunk_size));
+		REQUIRE(scheduler.batches < batched);
+	}
+}
+
+//
+// a real root on the headless system
+//
+
+// what a project's generated file provides; the one data type is test_item, the item of the test columns
+static std::map<std::string, minui::user_function, std::less<>> test_user_functions;
+
+struct test_item {
+	int32_t value = 0;
+	int32_t id = 0;
+};
+constexpr uint16_t test_item_type = 1;
+
+namespace minui {
+uint32_t defined_datatypes() {
+	return 2;
+}
+uint32_t datatype_size(uint32_t data_type_id) {
+	return data_type_id == test_item_type ? uint32_t(sizeof(test_item)) : 0;
+}
+void run_datatype_constructor(char* address, uint32_t data_type_id) {
+	if(data_type_id == test_item_type)
+		new (address) test_item();
+}
+void run_datatype_destructor(char*, uint32_t) {
+}
+std::unique_ptr<type_erased_vector> make_vector_of(uint32_t data_type_id) {
+	if(data_type_id == test_item_type)
+		return std::make_unique<type_erased_vector_impl<test_item>>();
+	return nullptr;
+}
+user_function lookup_function(std::string_view name) {
+	if(auto it = test_user_functions.find(name); it != test_user_functions.end())
+		return it->second;
+	return nullptr;
+}
+}
+
+// A definitions file in the format root::load_definitions reads, with solid color brushes and no sounds,
+// icons, images or text, and the localization text to go with it. Element 0 is the base element.
+struct test_definitions {
+	struct element {
+		uint16_t class_id = 0;
+		minui::layout_rect position;
+		uint32_t flags = 0;
+		uint16_t background_brush = 0;
+		std::vector<uint32_t> children{ };
+		// stored after the node, in 8 byte slots
+		std::vector<minui::variable_definition> variables{ };
+		uint16_t variable_slots = 0;
+		// the names of functions in test_user_functions
+		std::string on_update{ };
+		std::string on_visible{ };
+		std::string on_hide{ };
+	};
+	std::vector<element> elements;
+	std::vector<minui::brush_color> brushes{ minui::brush_color{ 0.0f, 0.0f, 0.0f, 1.0f }, minui::brush_color{ 1.0f, 1.0f, 1.0f, 1.0f } };
+	// for the containers, by element
+	ankerl::unordered_dense::map<uint32_t, minui::column_properties> column_properties;
+	ankerl::unordered_dense::map<uint32_t, minui::page_ui_definitions> page_ui;
+	ankerl::unordered_dense::map<uint32_t, minui::child_data_type> child_data_types;
+	std::vector<minui::saved_text_information> text_information;
+	std::string text{ }; // as a localization file
+
+	std::vector<char> save() const {
+		using array_map = ankerl::unordered_dense::map<uint32_t, minui::array_reference>;
+		serialization::out_buffer buf;
+
+		buf.write(uint16_t(0)); // sounds
+		buf.write(uint16_t(brushes.size()));
+		for(auto& b : brushes) {
+			buf.write(true);
+			buf.write(b);
+			buf.write(true);
+			buf.write(b);
+			buf.write(0.0f);
+			buf.write(0.0f);
+			buf.write(0.0f);
+		}
+		buf.write(uint16_t(0)); // icons
+		buf.write(uint16_t(0)); // images
+
+		array_map fixed_children;
+		array_map on_update;
+		array_map on_visible;
+		array_map on_hide;
+		auto add_name = [](array_map& m, uint32_t i, std::string const& name) {
+			if(!name.empty())
+				m.insert_or_assign(i, minui::array_reference{ 0, uint32_t(name.size()) });
+		};
+		for(uint32_t i = 0; i < elements.size(); ++i) {
+			if(!elements[i].children.empty())
+				fixed_children.insert_or_assign(i, minui::array_reference{ 0, uint32_t(elements[i].children.size()) });
+			add_name(on_update, i, elements[i].on_update);
+			add_name(on_visible, i, elements[i].on_visible);
+			add_name(on_hide, i, elements[i].on_hide);
+		}
+
+		// the sizes of the maps in the order they are stored; the rest are left empty
+		std::array<std::pair<size_t, size_t>, 18> sizes{ };
+		auto size_of = [](auto const& m) {
+			return std::pair<size_t, size_t>(m.bucket_count(), m.size());
+		};
+		sizes[0] = size_of(fixed_children);
+		sizes[4] = size_of(column_properties);
+		sizes[5] = size_of(page_ui);
+		sizes[8] = size_of(child_data_types);
+		sizes[9] = size_of(on_update);
+		sizes[12] = size_of(on_visible);
+		sizes[13] = size_of(on_hide);
+
+		buf.write(uint32_t(elements.size()));
+		for(uint32_t i = 0; i < 18; ++i) {
+			buf.write(uint32_t(sizes[i].first));
+			buf.write(uint32_t(sizes[i].second));
+			if(i == 5)
+				buf.write(uint32_t(text_information.size()));
+		}
+
+		auto write_each = [&](auto&& field) {
+			for(auto& e : elements)
+				buf.write(field(e));
+		};
+		write_each([](element const&) { return minui::layout_position{ }; });
+		write_each([](element const& e) { return e.position; });
+		write_each([](element const&) { return minui::interactable_definition{ }; });
+		write_each([](element const&) { return minui::icon_handle{ }; });
+		write_each([](element const& e) { return e.class_id; });
+		write_each([](element const& e) { return e.flags; });
+		write_each([](element const&) { return uint16_t(0); });
+		write_each([](element const& e) { return e.background_brush; });
+		write_each([](element const&) { return uint16_t(0); });
+		write_each([](element const&) { return uint16_t(0); });
+
+		// the arrays are written after everything else, when the file is finalized
+		auto write_array_map = [&](array_map const& m, auto&& contents) {
+			using pair_t = std::pair<uint32_t, minui::array_reference>;
+			auto base_addr = buf.get_data_position() + offsetof(pair_t, second) + offsetof(minui::array_reference, file_offset);
+			buf.write_fixed(m.m_values.data(), m.size());
+			for(auto& v : m.m_values) {
+				buf.write_relocation(base_addr, [&, type = v.first](serialization::out_buffer& b) {
+					contents(b, elements[type]);
+				});
+				base_addr += sizeof(pair_t);
+			}
+			if(m.bucket_count() != 0)
+				buf.write_fixed(m.m_buckets, m.bucket_count());
+		};
+		write_array_map(fixed_children, [](serialization::out_buffer& b, element const& e) {
+			b.write_fixed(e.children.data(), e.children.size());
+		});
+
+		auto write_map = [&](auto const& m) {
+			buf.write_fixed(m.m_values.data(), m.size());
+			if(m.bucket_count() != 0)
+				buf.write_fixed(m.m_buckets, m.bucket_count());
+		};
+
+		for(auto& e : elements) {
+			auto base_addr = buf.get_data_position() + offsetof(minui::array_reference, file_offset);
+			buf.write(minui::array_reference{ 0, uint32_t(e.variables.size()) });
+			if(!e.variables.empty()) {
+				buf.write_relocation(base_addr, [&](serialization::out_buffer& b) {
+					b.write_fixed(e.variables.data(), e.variables.size());
+				});
+			}
+		}
+		write_each([](element const& e) { return e.variable_slots; });
+		write_each([](element const& e) { return minui::background_definition{ .image = minui::image_handle{ -1 }, .brush = e.background_brush }; });
+		write_map(column_properties);
+		write_map(page_ui);
+		buf.write_fixed(text_information.data(), text_information.size());
+		write_map(child_data_types);
+
+		write_array_map(on_update, [](serialization::out_buffer& b, element const& e) {
+			b.write_fixed(e.on_update.data(), e.on_update.size());
+		});
+		write_array_map(on_visible, [](serialization::out_buffer& b, element const& e) {
+			b.write_fixed(e.on_visible.data(), e.on_visible.size());
+		});
+		write_array_map(on_hide, [](serialization::out_buffer& b, element const& e) {
+			b.write_fixed(e.on_hide.data(), e.on_hide.size());
+		});
+
+		buf.finalize();
+		return std::vector<char>(buf.data(), buf.data() + buf.size());
+	}
+};
+
+// a root over its own headless system and definitions, laid out and drawn once
+struct test_root {
+	std::vector<char> definitions;
+	std::string text;
+	minui::headless::system s;
+	minui::root r;
+
+	test_root(test_definitions const& d, minui::layout_position workspace = minui::layout_position{ minui::em{ 4000 }, minui::em{ 3000 } }) :
+		definitions(d.save()), text(d.text), s(std::filesystem::path("."), workspace, 20), r(s, workspace) {
+		minui::text::populate_with_file_content(s.text_data, text.data(), text.data() + text.size());
+		r.load_definitions(definitions.data(), definitions.size());
+		r.make_base_element();
+		frame();
+	}
+	// one pass of the frame loop; returns whether anything was drawn
+	bool frame() {
+		s.commands.clear();
+		s.batch_history.clear();
+		if(!r.advance_frame(minui::root::frame_clock::now()))
+			return false;
+		r.render();
+		return true;
+	}
+	minui::ui_node& base() {
+		return *r.node_repository[0];
+	}
+	uint32_t count_commands(minui::headless::command_type type) const {
+		uint32_t count = 0;
+		s.commands.for_each([&](minui::headless::command_header const& h, uint8_t const*) {
+			if(h.type == type)
+				++count;
+		});
+		return count;
+	}
+};
+
+// a column of buttons over a background, with a panel of more buttons to the right
+static test_definitions button_panels() {
+	using minui::em;
+	auto button = [](int16_t x, int16_t y) {
+		return test_definitions::element{ .position = minui::layout_rect{ em{ x }, em{ y }, em{ 800 }, em{ 200 } }, .flags = minui::behavior::visually_interactable, .background_brush = 1 };
+	};
+	test_definitions d;
+	d.elements = {
+		test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } }, .children = { 1, 2, 3, 4 } },
+		button(100, 100), button(100, 400), button(100, 700),
+		test_definitions::element{ .position = minui::layout_rect{ em{ 2000 }, em{ 100 }, em{ 1500 }, em{ 2000 } }, .children = { 5, 6 } },
+		button(100, 100), button(100, 400)
+	};
+	return d;
+}
+
+// Adds a column of test_item rows, with the page controls it needs, and returns the column's element.
+// The rows are static text, which is at least a line high; rows with no height would never fill a page.
+static uint32_t add_item_column(test_definitions& d, minui::em height, uint32_t row_flags = 0) {
+	using minui::em;
+	auto column = uint32_t(d.elements.size());
+	d.elements.push_back(test_definitions::element{ .class_id = 5, .position = minui::layout_rect{ em{ 100 }, em{ 100 }, em{ 1000 }, height } });
+	d.elements.push_back(test_definitions::element{ .class_id = 9, .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 800 }, em{ 200 } }, .flags = row_flags, .background_brush = 1,
+		.variables = { minui::variable_definition{ .variable = 1, .data_type = test_item_type, .offset = 0, .raw_data = { } } }, .variable_slots = 1, .on_update = "row" });
+	d.elements.push_back(test_definitions::element{ .class_id = 13, .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 100 }, em{ 100 } }, .variable_slots = 1 });
+	d.elements.push_back(test_definitions::element{ .class_id = 14, .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 300 }, em{ 100 } }, .variable_slots = 1 });
+	uint16_t button = uint16_t(column + 2);
+	d.column_properties.insert_or_assign(column, minui::column_properties{ .minimum_width = em{ 800 } });
+	d.page_ui.insert_or_assign(column, minui::page_ui_definitions{ .page_icon = minui::icon_handle{ }, .left_button = button, .right_button = button, .left2_button = button, .right2_button = button, .text = uint16_t(column + 3) });
+	d.child_data_types.insert_or_assign(column, minui::child_data_type{ .variable = 1, .data_type = test_item_type, .child_control_type = uint16_t(column + 1) });
+	d.text = "page_numbers_h {current}/{max}\npage_numbers_v {current} {max}";
+	return column;
+}
+
+// a column of test_item rows on the base
+static test_definitions item_column() {
+	using minui::em;
+	test_definitions d;
+	d.elements = { test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } }, .children = { 1 } } };
+	add_item_column(d, em{ 1100 });
+	return d;
+}
+
+// a column of test_item rows that claim the mouse on the base, and a button on a panel beside it
+static test_definitions column_and_panel() {
+	using minui::em;
+	test_definitions d;
+	d.elements = { test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } }, .children = { 1, 5 } } };
+	auto row = add_item_column(d, em{ 1100 }, minui::behavior::visually_interactable) + 1;
+	d.elements[row].class_id = 12; // static text never claims the mouse
+	d.elements.push_back(test_definitions::element{ .position = minui::layout_rect{ em{ 2000 }, em{ 100 }, em{ 1500 }, em{ 2000 } }, .children = { 6 } });
+	d.elements.push_back(test_definitions::element{ .position = minui::layout_rect{ em{ 100 }, em{ 100 }, em{ 800 }, em{ 200 } }, .flags = minui::behavior::visually_interactable, .background_brush = 1 });
+	return d;
+}
+
+// layers on the base holding column_count instances of the same column, which are laid out in parallel
+static test_definitions layered_columns(uint32_t column_count) {
+	using minui::em;
+	test_definitions d;
+	d.elements = {
+		test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } }, .children = { 1 } },
+		test_definitions::element{ .class_id = 7, .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } } }
+	};
+	auto column = add_item_column(d, em{ 3000 });
+	d.elements[1].children.assign(column_count, column);
+	return d;
+}
+
+TEST_CASE("root from definitions", "root") {
+	test_root t(button_panels());
+
+	auto& base = t.base();
+	REQUIRE(base.child_count() == 4);
+	REQUIRE(base.get_child(3)->child_count() == 2);
+	REQUIRE(base.position.width.value == 4000);
+	REQUIRE(t.r.workspace_placement(*base.get_child(3)->get_child(1)).x.value == 2100);
+	REQUIRE(t.r.workspace_placement(*base.get_child(3)->get_child(1)).y.value == 500);
+
+	// the first frame draws every background
+	REQUIRE(t.s.damaged_regions.size() == 1);
+	REQUIRE(t.count_commands(minui::headless::command_type::rectangle) == 7);
+}
+
+TEST_CASE("static trees replay their display lists", "root") {
+	using minui::em;
+	static bool nudge = false;
+	test_user_functions["nudge"] = [](minui::root&, minui::ui_node& n) {
+		if(nudge)
+			n.position.x = n.position.x + em{ 50 };
+		nudge = false;
+	};
+	auto d = button_panels();
+	d.elements[2].on_update = "nudge";
+	nudge = false;
+	test_root t(d);
+	REQUIRE(t.r.nodes_recorded == 7);
+
+	// an update that changes nothing leaves nothing to draw
+	t.r.request_update();
+	REQUIRE(!t.frame());
+
+	// and a redraw of the unchanged tree replays every node
+	t.s.commands.clear();
+	t.r.render();
+	REQUIRE(t.r.nodes_recorded == 0);
+	REQUIRE(t.count_commands(minui::headless::command_type::rectangle) == 7);
+
+	// a node moved by its update is recorded again, with the base that holds it
+	nudge = true;
+	t.r.request_update();
+	REQUIRE(t.frame());
+	REQUIRE(t.r.nodes_recorded == 2);
+	REQUIRE(t.count_commands(minui::headless::command_type::rectangle) == 7);
+}
+
+TEST_CASE("root damage", "root") {
+	using minui::em;
+	static bool nudge = false;
+	test_user_functions["nudge"] = [](minui::root&, minui::ui_node& n) {
+		if(nudge)
+			n.position.x = n.position.x + em{ 50 };
+		nudge = false;
+	};
+	auto d = button_panels();
+	d.elements[3].on_update = "nudge";
+	nudge = false;
+	test_root t(d);
+
+	auto& base = t.base();
+	auto area = [&](minui::ui_node& n) {
+		auto p = t.r.workspace_placement(n);
+		return t.s.to_screen_space(minui::layout_rect{ p.x, p.y, n.position.width, n.position.height });
+	};
+	auto same = [](minui::screen_space_rect a, minui::screen_space_rect b) {
+		return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+	};
+
+	// hovering a button damages only that button
+	auto first = area(*base.get_child(0));
+	t.r.post_mouse_move(minui::layout_position{ em{ 500 }, em{ 200 } });
+	REQUIRE(t.frame());
+	REQUIRE(t.s.damaged_regions.size() == 1);
+	REQUIRE(same(t.s.damaged_regions[0], first));
+	// what a backend that posted the move reports as consumed, as calling the handler would have
+	REQUIRE(t.r.mouse_over_ui());
+	REQUIRE(t.r.on_mouse_move(minui::layout_position{ em{ 500 }, em{ 200 } }) == t.r.mouse_over_ui());
+
+	// moving to the next damages the one left and the one entered
+	auto second = area(*base.get_child(1));
+	t.r.post_mouse_move(minui::layout_position{ em{ 500 }, em{ 500 } });
+	REQUIRE(t.frame());
+	REQUIRE(t.s.damaged_regions.size() == 2);
+	REQUIRE(((same(t.s.damaged_regions[0], first) && same(t.s.damaged_regions[1], second)) || (same(t.s.damaged_regions[0], second) && same(t.s.damaged_regions[1], first))));
+
+	// an update that changes nothing damages nothing and keeps the last probe
+	auto probes = t.r.mouse_probes;
+	t.r.request_update();
+	REQUIRE(!t.frame());
+	REQUIRE(t.r.mouse_probes == probes);
+
+	// a node an update moves damages where it was and where it is, and the mouse is probed again
+	auto before = area(*base.get_child(2));
+	nudge = true;
+	t.r.request_update();
+	REQUIRE(t.frame());
+	auto after = area(*base.get_child(2));
+	REQUIRE(t.s.damaged_regions.size() == 1);
+	REQUIRE(same(t.s.damaged_regions[0], minui::screen_space_rect{ before.x, before.y, after.x + after.width - before.x, before.height }));
+	REQUIRE(t.r.mouse_probes == probes + 1);
+}
+
+TEST_CASE("root input latency", "root") {
+	using minui::em;
+	test_root t(button_panels());
+	t.s.latency = &t.r.latency;
+	auto present = [&]() {
+		REQUIRE(t.frame());
+		t.s.present();
+	};
+
+	// a handler called directly is timed, as is posted input
+	t.r.on_mouse_move(minui::layout_position{ em{ 500 }, em{ 200 } });
+	present();
+	REQUIRE(t.r.latency.total_samples == 1);
+	t.r.post_mouse_move(minui::layout_position{ em{ 500 }, em{ 500 } });
+	present();
+	REQUIRE(t.r.latency.total_samples == 2);
+
+	// the mouse move an update pass makes is not input
+	t.r.invalidate_render(&t.base());
+	t.r.request_update();
+	present();
+	REQUIRE(t.r.latency.total_samples == 2);
+}
+
+TEST_CASE("root input dispatch", "[.][benchmark]") {
+	using minui::em;
+	test_user_functions["row"] = [](minui::root&, minui::ui_node&) { };
+	test_root t(column_and_panel());
+	auto& column = *t.base().get_child(0);
+	auto& button = *t.base().get_child(1)->get_child(0);
+	std::vector<test_item> contents(200);
+	minui::span_data_source<test_item> source(contents);
+	static_cast<minui::imonotype_container*>(column.get_interface(minui::iface::monotype_container))->set_data_source(&source);
+	t.r.request_update();
+	t.frame();
+	auto center = [&](minui::ui_node& n) {
+		return t.r.workspace_placement(n) + minui::layout_position{ n.position.width / 2, n.position.height / 2 };
+	};
+
+	// each move is to a new position, so none of the direct ones reuses the last probe
+	auto over_button = center(button);
+	BENCHMARK("64 moves, direct") {
+		for(int16_t i = 0; i < 64; ++i)
+			t.r.on_mouse_move(over_button + minui::layout_position{ em{ i }, em{ 0 } });
+		return t.r.mouse_probes;
+	};
+	BENCHMARK("64 moves, posted and drained") {
+		for(int16_t i = 0; i < 64; ++i)
+			t.r.post_mouse_move(over_button + minui::layout_position{ em{ i }, em{ 0 } });
+		t.r.drain_input();
+		return t.r.mouse_probes;
+	};
+
+	// scrolling back and forth over the column changes its page each time, unless the scrolls are merged
+	t.r.on_mouse_move(center(column));
+	BENCHMARK("64 scrolls, direct") {
+		for(int32_t i = 0; i < 64; ++i)
+			t.r.on_mouse_scroll(i % 2 == 0 ? 1.0f : -1.0f);
+		return column.get_page_information().current_page;
+	};
+	BENCHMARK("64 scrolls, posted and drained") {
+		for(int32_t i = 0; i < 64; ++i)
+			t.r.post_mouse_scroll(i % 2 == 0 ? 1.0f : -1.0f);
+		t.r.drain_input();
+		return column.get_page_information().current_page;
+	};
+
+	// clicks are never merged, so this is the cost of the queue alone
+	t.r.on_mouse_move(over_button);
+	BENCHMARK("64 clicks, direct") {
+		for(int32_t i = 0; i < 64; ++i) {
+			t.r.on_mouse_lbutton(minui::click_type::singlec);
+			t.r.on_mouse_lbutton_up();
+		}
+		return t.r.needs_render;
+	};
+	BENCHMARK("64 clicks, posted and drained") {
+		for(int32_t i = 0; i < 64; ++i) {
+			t.r.post_input(minui::root::input_event{ .type = minui::root::input_event::kind::mouse_lbutton });
+			t.r.post_input(minui::root::input_event{ .type = minui::root::input_event::kind::mouse_lbutton_up });
+		}
+		t.r.drain_input();
+		return t.r.needs_render;
+	};
+	REQUIRE(t.r.input_events_coalesced > 0);
+}
+
+TEST_CASE("focus changes redraw what they change", "root") {
+	test_root t(button_panels());
+	auto& base = t.base();
+	t.r.set_window_focus(minui::focus_tracker{ &base, -1, -1 });
+	t.frame();
+
+	// with the prompts hidden, moving between groups of the same node changes nothing drawn
+	t.r.take_key_action(minui::focus_tracker{ &base, 0, 1 });
+	REQUIRE(!t.frame());
+	t.r.set_window_focus(minui::focus_tracker{ &base, 2, 3 });
+	REQUIRE(!t.frame());
+
+	// with them shown, only the nodes whose prompts change are drawn again
+	t.r.set_prompt_mode(minui::prompt_mode::keyboard);
+	t.frame();
+	t.r.take_key_action(minui::focus_tracker{ &base, 0, 1 });
+	REQUIRE(t.frame());
+	REQUIRE(t.r.nodes_recorded < 7);
+	REQUIRE(!t.s.damaged_regions.empty());
+}
+
+TEST_CASE("damage from common interactions", "root") {
+	using minui::em;
+	test_definitions d;
+	d.elements = {
+		test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } }, .children = { 1, 2, 3 } },
+		test_definitions::element{ .class_id = 11, .position = minui::layout_rect{ em{ 100 }, em{ 100 }, em{ 800 }, em{ 200 } }, .background_brush = 1 },
+		test_definitions::element{ .class_id = 11, .position = minui::layout_rect{ em{ 100 }, em{ 2500 }, em{ 800 }, em{ 200 } }, .background_brush = 1 },
+		test_definitions::element{ .class_id = 12, .position = minui::layout_rect{ em{ 2000 }, em{ 100 }, em{ 1000 }, em{ 300 } }, .flags = minui::behavior::interaction_focus }
+	};
+	test_root t(d);
+	auto& base = t.base();
+	auto area = [&](minui::ui_node& n) {
+		auto p = t.r.workspace_placement(n);
+		return t.s.to_screen_space(minui::layout_rect{ p.x, p.y, n.position.width, n.position.height });
+	};
+	auto centre = [&](minui::ui_node& n) {
+		auto p = t.r.workspace_placement(n);
+		return minui::layout_position{ p.x + n.position.width / 2, p.y + n.position.height / 2 };
+	};
+	// every damaged region lies within one of the nodes given
+	auto damage_within = [&](std::initializer_list<minui::ui_node*> nodes) {
+		for(auto& r : t.s.damaged_regions) {
+			bool inside = false;
+			for(auto n : nodes) {
+				auto a = area(*n);
+				inside = inside || (a.x <= r.x && a.y <= r.y && r.x + r.width <= a.x + a.width && r.y + r.height <= a.y + a.height);
+			}
+			if(!inside)
+				return false;
+		}
+		return true;
+	};
+	auto& button = *base.get_child(0);
+	auto& other_button = *base.get_child(1);
+	auto& edit = *base.get_child(2);
+	REQUIRE(!t.frame());
+
+	// clicking a button redraws the button, and nothing else
+	t.r.on_mouse_move(centre(button));
+	t.frame();
+	t.r.on_mouse_lbutton(minui::click_type::singlec);
+	t.r.on_mouse_lbutton_up();
+	REQUIRE(t.frame());
+	REQUIRE(!t.s.damaged_regions.empty());
+	REQUIRE(damage_within({ &button }));
+	REQUIRE(t.r.nodes_recorded <= 2);
+
+	// clicking into the edit control moves the focus there; typing and editing keys redraw only the control
+	t.r.on_mouse_move(centre(edit));
+	t.frame();
+	t.r.on_mouse_lbutton(minui::click_type::singlec);
+	t.r.on_mouse_lbutton_up();
+	t.frame();
+	REQUIRE(damage_within({ &button, &edit }));
+	for(auto c : { NATIVE('a'), NATIVE('b'), NATIVE('c') }) {
+		t.r.on_char(c);
+		REQUIRE(t.frame());
+		REQUIRE(!t.s.damaged_regions.empty());
+		REQUIRE(damage_within({ &edit }));
+	}
+	t.r.on_key_down(0, 0x25, false);
+	t.r.on_key_up(0, 0x25);
+	t.frame();
+	REQUIRE(damage_within({ &edit }));
+
+	// clicking away from the edit control redraws what loses and gains the focus
+	t.r.on_mouse_move(centre(other_button));
+	t.frame();
+	t.r.on_mouse_lbutton(minui::click_type::singlec);
+	t.r.on_mouse_lbutton_up();
+	t.frame();
+	REQUIRE(damage_within({ &edit, &other_button }));
+
+	// keys and characters that reach nothing redraw nothing
+	t.r.on_char(NATIVE('x'));
+	t.r.on_key_down(0, 0x58, false);
+	t.r.on_key_up(0, 0x58);
+	REQUIRE(!t.frame());
+}
+
+TEST_CASE("edit settings redraw the edit control", "root") {
+	using minui::em;
+	test_definitions d;
+	d.elements = {
+		test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } }, .children = { 1 } },
+		test_definitions::element{ .class_id = 12, .position = minui::layout_rect{ em{ 100 }, em{ 100 }, em{ 1000 }, em{ 300 } } }
+	};
+	test_root t(d);
+	auto& edit = *t.base().get_child(0);
+	auto& text = *static_cast<minui::ieditable_text*>(edit.get_interface(minui::iface::editable_text));
+	REQUIRE(!t.frame());
+	auto covers_edit = [&]() {
+		auto area = t.s.to_screen_space(minui::layout_rect{ em{ 100 }, em{ 100 }, em{ 1000 }, em{ 300 } });
+		for(auto& d : t.s.damaged_regions) {
+			if(d.x <= area.x && d.y <= area.y && d.x + d.width >= area.x + area.width && d.y + d.height >= area.y + area.height)
+				return true;
+		}
+		return false;
+	};
+
+	// each change draws the control again and damages it; setting what is already set does nothing
+	text.set_read_only(t.s, true);
+	REQUIRE(t.frame());
+	REQUIRE(t.r.nodes_recorded <= 2);
+	REQUIRE(covers_edit());
+	text.set_read_only(t.s, true);
+	REQUIRE(!t.frame());
+
+	text.set_starting_display_line(t.s, 1);
+	REQUIRE(t.frame());
+	REQUIRE(t.r.nodes_recorded <= 2);
+	REQUIRE(covers_edit());
+	text.set_starting_display_line(t.s, 1);
+	REQUIRE(!t.frame());
+}
+
+TEST_CASE("monotype column row rebinding", "root") {
+	static std::vector<int32_t> updated; // the value each updated row was bound to
+	test_user_functions["row"] = [](minui::root& r, minui::ui_node& n) {
+		if(auto item = minui::impl::get_local_data(r, &n, 1); item)
+			updated.push_back(reinterpret_cast<test_item const*>(item)->value);
+	};
+	test_root t(item_column());
+	auto& column = *t.base().get_child(0);
+	auto& items = *static_cast<minui::imonotype_container*>(column.get_interface(minui::iface::monotype_container));
+	auto page_rows = [&]() {
+		return column.child_count() - 1;
+	};
+
+	std::vector<test_item> contents(40);
+	for(int32_t i = 0; i < 40; ++i)
+		contents[i] = test_item{ i, i };
+	minui::span_data_source<test_item> source(contents);
+	items.set_data_source(&source);
+	updated.clear();
+	t.r.request_update();
+	t.frame();
+	auto rows = page_rows();
+	REQUIRE(rows > 1);
+	REQUIRE(updated.size() == rows);
+
+	// only the row whose item changed is updated, with the new item
+	contents[1].value = 100;
+	source.touch();
+	updated.clear();
+	t.r.request_update();
+	t.frame();
+	REQUIRE(updated == std::vector<int32_t>{ 100 });
+
+	// a resize that keeps the page leaves the rows alone
+	updated.clear();
+	column.force_resize(t.r, minui::layout_position{ column.position.width, column.position.height });
+	REQUIRE(updated.empty());
+
+	// a different source with the same items rebinds every row
+	minui::span_data_source<test_item> copy(contents);
+	items.set_data_source(&copy);
+	updated.clear();
+	t.r.request_update();
+	t.frame();
+	REQUIRE(updated.size() == rows);
+
+	// as do new items and a new page, even when the items there have the same bytes
+	std::fill(contents.begin(), contents.end(), test_item{ 7, 7 });
+	items.set_items(std::span<test_item const>(contents));
+	updated.clear();
+	t.r.request_update();
+	t.frame();
+	REQUIRE(updated.size() == rows);
+	updated.clear();
+	column.on_scroll(t.r, minui::layout_position{ }, 1);
+	REQUIRE(updated.size() == rows);
+	REQUIRE(items.get_item(*column.get_child(0)) != nullptr);
+
+	// items of another size are refused and the column keeps what it had
+	std::vector<int32_t> wrong(40);
+	REQUIRE(!items.set_items(std::span<int32_t const>(wrong)));
+	REQUIRE(items.get_item(*column.get_child(0)) != nullptr);
+}
+
+TEST_CASE("monotype column source shrinking", "root") {
+	static std::vector<int32_t> updated;
+	test_user_functions["row"] = [](minui::root& r, minui::ui_node& n) {
+		if(auto item = minui::impl::get_local_data(r, &n, 1); item)
+			updated.push_back(reinterpret_cast<test_item const*>(item)->value);
+	};
+	test_root t(item_column());
+	auto& column = *t.base().get_child(0);
+	auto& items = *static_cast<minui::imonotype_container*>(column.get_interface(minui::iface::monotype_container));
+
+	std::vector<test_item> contents(40);
+	for(int32_t i = 0; i < 40; ++i)
+		contents[i] = test_item{ i, i };
+	minui::span_data_source<test_item> source(contents);
+	items.set_data_source(&source);
+	t.r.request_update();
+	t.frame();
+	column.on_scroll(t.r, minui::layout_position{ }, 2);
+	REQUIRE(column.get_page_information().current_page == 2);
+
+	// the source shrinks below the current page before the column hears of it: the page reads as empty
+	// instead of reading past the end of the source, through a resize as well
+	contents.resize(3);
+	source.reset(contents);
+	REQUIRE(items.get_item(*column.get_child(0)) == nullptr);
+
+	// a resize moves back to the last page there is
+	updated.clear();
+	column.force_resize(t.r, minui::layout_position{ column.position.width, column.position.height });
+	REQUIRE(column.get_page_information().current_page == 0);
+	REQUIRE(updated == std::vector<int32_t>{ 0, 1, 2 });
+	REQUIRE(items.get_item(*column.get_child(0)) == contents.data());
+
+	// as does the next update
+	contents.assign(40, test_item{ });
+	source.reset(contents);
+	t.r.request_update();
+	t.frame();
+	column.on_scroll(t.r, minui::layout_position{ }, 2);
+	contents.resize(3);
+	source.reset(contents);
+	REQUIRE(items.get_item(*column.get_child(0)) == nullptr);
+	t.r.request_update();
+	t.frame();
+	REQUIRE(column.get_page_information().current_page == 0);
+	REQUIRE(items.get_item(*column.get_child(0)) == contents.data());
+
+	// and emptying it leaves nothing bound
+	contents.clear();
+	source.reset(contents);
+	t.r.request_update();
+	t.frame();
+	REQUIRE(column.get_page_information().current_page == 0);
+	REQUIRE(items.get_item(*column.get_child(0)) == nullptr);
+}
+
+TEST_CASE("page changes keep probe extents elsewhere", "root") {
+	using minui::em;
+	test_user_functions["row"] = [](minui::root&, minui::ui_node&) { };
+	test_root t(column_and_panel());
+	auto& column = *t.base().get_child(0);
+	auto& panel = *t.base().get_child(1);
+	auto& items = *static_cast<minui::imonotype_container*>(column.get_interface(minui::iface::monotype_container));
+
+	// a page and a half
+	std::vector<test_item> contents(40);
+	minui::span_data_source<test_item> source(contents);
+	items.set_data_source(&source);
+	t.r.request_update();
+	t.frame();
+	contents.resize((column.child_count() - 1) * 3 / 2);
+	source.reset(contents);
+	t.r.request_update();
+	t.frame();
+	REQUIRE(column.get_page_information().total_pages == 2);
+
+	auto hovered = [&]() {
+		return t.r.under_mouse.type_array[size_t(minui::mouse_interactivity::position)].node;
+	};
+	auto extent_valid = [&](minui::ui_node const& n) {
+		auto it = t.r.probe_extents.find(&n);
+		return it != t.r.probe_extents.end() && it->second.generation == t.r.probe_generation;
+	};
+	auto center = [&](minui::ui_node& n) {
+		return t.r.workspace_placement(n) + minui::layout_position{ n.position.width / 2, n.position.height / 2 };
+	};
+	auto last_row = column.get_child(column.child_count() - 2);
+	auto last_row_center = center(*last_row);
+	t.r.post_mouse_move(last_row_center);
+	t.frame();
+	REQUIRE(hovered() == last_row);
+	t.r.post_mouse_move(center(*panel.get_child(0)));
+	t.frame();
+	REQUIRE(hovered() == panel.get_child(0));
+	// the highlight moving redraws, and so drops, what holds the button; moving within it probes again
+	t.r.post_mouse_move(center(*panel.get_child(0)) + minui::layout_position{ em{ 10 }, em{ 0 } });
+	t.frame();
+	REQUIRE(extent_valid(panel));
+	REQUIRE(extent_valid(column));
+
+	// the last page leaves rows empty: the column and what holds it are probed again, the panel is not
+	column.on_scroll(t.r, minui::layout_position{ }, 1);
+	REQUIRE((last_row->behavior_flags & minui::behavior::functionally_hidden) != 0);
+	REQUIRE(extent_valid(panel));
+	REQUIRE(extent_valid(*panel.get_child(0)));
+	REQUIRE(!extent_valid(column));
+	REQUIRE(!extent_valid(t.base()));
+	t.frame();
+
+	// and a probe finds the page as it is now
+	t.r.post_mouse_move(last_row_center);
+	t.frame();
+	REQUIRE(hovered() != last_row);
+	auto first_row = column.get_child(0);
+	t.r.post_mouse_move(center(*first_row));
+	t.frame();
+	REQUIRE(hovered() == first_row);
+}
+
+// the position and flags of every node under n, depth first
+static void collect_layout(minui::ui_node const& n, std::vector<std::pair<minui::layout_rect, uint32_t>>& out) {
+	out.emplace_back(n.position, n.behavior_flags);
+	for(uint32_t i = 0; i < n.child_count(); ++i)
+		collect_layout(*n.get_child(i), out);
+}
+
+TEST_CASE("parallel layout", "root") {
+	using minui::em;
+	static std::thread::id update_thread;
+	static std::atomic<int32_t> off_thread_updates = 0;
+	test_user_functions["row"] = [](minui::root&, minui::ui_node&) {
+		if(std::this_thread::get_id() != update_thread)
+			off_thread_updates.fetch_add(1);
+	};
+	update_thread = std::this_thread::get_id();
+	off_thread_updates = 0;
+
+	// the same layouts, once on the calling thread and once on four threads
+	test_root serial(layered_columns(2));
+	test_root threaded(layered_columns(2));
+	threaded.r.set_layout_threads(4);
+
+	std::vector<test_item> contents(100);
+	for(int32_t i = 0; i < 100; ++i)
+		contents[i] = test_item{ i, i };
+	minui::span_data_source<test_item> source(contents);
+	for(auto t : { &serial, &threaded }) {
+		auto& layer = *t->base().get_child(0);
+		for(uint32_t i = 0; i < layer.child_count(); ++i)
+			static_cast<minui::imonotype_container*>(layer.get_child(i)->get_interface(minui::iface::monotype_container))->set_data_source(&source);
+		t->r.request_update();
+		t->frame();
+	}
+
+	for(int16_t height : { 1200, 2600, 800, 2000, 3000 }) {
+		std::vector<std::pair<minui::layout_rect, uint32_t>> expected;
+		std::vector<std::pair<minui::layout_rect, uint32_t>> found;
+		for(auto t : { &serial, &threaded }) {
+			auto generation = t->r.layout_generation;
+			t->base().get_child(0)->force_resize(t->r, minui::layout_position{ em{ 4000 }, em{ height } });
+			// rows hidden or shown on the workers invalidate the layout once the pass is over
+			REQUIRE(t->r.layout_generation != generation);
+			REQUIRE(t->frame());
+			collect_layout(t->base(), t == &serial ? expected : found);
+		}
+		REQUIRE(found == expected);
+
+		// every visible row holds its item
+		auto& layer = *threaded.base().get_child(0);
+		for(uint32_t i = 0; i < layer.child_count(); ++i) {
+			auto& column = *layer.get_child(i);
+			auto& items = *static_cast<minui::imonotype_container*>(column.get_interface(minui::iface::monotype_container));
+			for(uint32_t j = 0; j + 1 < column.child_count(); ++j) {
+				auto& row = *column.get_child(j);
+				if((row.behavior_flags & minui::behavior::functionally_hidden) == 0)
+					REQUIRE(reinterpret_cast<test_item const*>(items.get_item(row))->value == int32_t(j));
+			}
+		}
+	}
+	REQUIRE(off_thread_updates.load() == 0);
+}
+
+TEST_CASE("root recording replays", "root") {
+	using minui::em;
+	using minui::replay::entry_type;
+	test_user_functions["row"] = [](minui::root&, minui::ui_node&) { };
+	// the panel's button hides itself while the column is on an odd page, so updates change what is drawn
+	test_user_functions["follow"] = [](minui::root&, minui::ui_node& n) {
+		auto page = n.parent->parent->get_child(0)->get_page_information().current_page;
+		if(page % 2 == 1)
+			n.behavior_flags |= minui::behavior::visually_hidden;
+		else
+			n.behavior_flags &= ~minui::behavior::visually_hidden;
+	};
+	auto d = column_and_panel();
+	d.elements.back().on_update = "follow";
+
+	// a root showing a column of items, before anything is recorded
+	struct session {
+		test_root t;
+		std::vector<test_item> contents;
+		minui::span_data_source<test_item> source;
+		session(test_definitions const& d) : t(d), contents(40), source(contents) {
+			for(int32_t i = 0; i < 40; ++i)
+				contents[i] = test_item{ i, i };
+			auto& column = *t.base().get_child(0);
+			static_cast<minui::imonotype_container*>(column.get_interface(minui::iface::monotype_container))->set_data_source(&source);
+			t.r.request_update();
+			t.frame();
+		}
+	};
+	session recorded(d);
+	session replayed(d);
+	auto& t = recorded.t;
+	auto& column = *t.base().get_child(0);
+	auto& button = *t.base().get_child(1)->get_child(0);
+	auto center = [&](minui::ui_node& n) {
+		return t.r.workspace_placement(n) + minui::layout_position{ n.position.width / 2, n.position.height / 2 };
+	};
+
+	minui::replay::recorder rec;
+	t.r.recording = &rec;
+	auto draw_hash = minui::headless::draw_stream_hash(minui::headless::command_buffer{ });
+	uint32_t renders = 0;
+	auto frame = [&]() {
+		t.s.commands.clear();
+		if(t.r.advance_frame(minui::root::frame_clock::now())) {
+			t.r.render();
+			draw_hash = minui::headless::draw_stream_hash(t.s.commands, draw_hash);
+			++renders;
+		}
+	};
+
+	// clicks, scrolls, keys, a resize and updates, some handled directly and some posted
+	t.r.on_mouse_move(center(button));
+	t.r.on_mouse_lbutton(minui::click_type::singlec);
+	t.r.on_mouse_lbutton_up();
+	frame();
+	t.r.post_mouse_move(center(column));
+	t.r.post_mouse_scroll(1.0f);
+	frame();
+	t.r.request_update();
+	frame();
+	REQUIRE(column.get_page_information().current_page == 1);
+	REQUIRE((button.behavior_flags & minui::behavior::visually_hidden) != 0);
+	t.r.on_key_down(0x0F, 0x09, false);
+	t.r.on_key_up(0x0F, 0x09);
+	t.r.on_char(minui::native_char('a'));
+	frame();
+	t.s.workspace = minui::layout_position{ em{ 3000 }, em{ 2500 } };
+	t.r.on_workspace_resized(minui::resize_type::normal, t.s.workspace);
+	frame();
+	t.r.on_mouse_scroll(1.0f);
+	t.r.request_update();
+	frame();
+	REQUIRE(column.get_page_information().current_page == 2);
+	REQUIRE((button.behavior_flags & minui::behavior::visually_hidden) == 0);
+	t.r.recording = nullptr;
+	REQUIRE(renders > 3);
+
+	// what the root does for itself is left out: the updates that frames run, and the mouse moves that follow
+	// them, are replayed by replaying the frames
+	std::array<uint32_t, size_t(entry_type::count)> counts{ };
+	minui::replay::reader in(rec.data());
+	while(auto e = in.next())
+		++counts[size_t(e->type)];
+	REQUIRE(!in.failed);
+	REQUIRE(counts[size_t(entry_type::update)] == 0);
+	REQUIRE(counts[size_t(entry_type::request_update)] == 2);
+	REQUIRE(counts[size_t(entry_type::mouse_move)] == 2);
+	REQUIRE(counts[size_t(entry_type::mouse_scroll)] == 2);
+	REQUIRE(counts[size_t(entry_type::render)] == renders);
+
+	// replayed into a second root, the recording draws the same frames and leaves the same tree
+	auto result = minui::replay::run(rec.data(), replayed.t.r, replayed.t.s, rec.start);
+	REQUIRE(result.complete);
+	REQUIRE(result.entries == rec.entries);
+	REQUIRE(result.frames.size() == renders);
+	REQUIRE(result.draw_hash == draw_hash);
+
+	std::vector<std::pair<minui::layout_rect, uint32_t>> expected, actual;
+	collect_layout(t.base(), expected);
+	collect_layout(replayed.t.base(), actual);
+	REQUIRE(expected == actual);
+	auto& replayed_column = *replayed.t.base().get_child(0);
+	REQUIRE(replayed_column.get_page_information().current_page == 2);
+	REQUIRE(replayed.t.s.workspace.x == t.s.workspace.x);
+	REQUIRE(replayed.t.r.mouse_over_ui() == t.r.mouse_over_ui());
+	REQUIRE(replayed.t.r.latest_mouse_position.x == t.r.latest_mouse_position.x);
+	REQUIRE(replayed.t.r.latest_mouse_position.y == t.r.latest_mouse_position.y);
+}
+
+TEST_CASE("parallel layout scaling", "[.][benchmark]") {
+	using minui::em;
+	test_user_functions["row"] = [](minui::root&, minui::ui_node&) { };
+	std::vector<test_item> contents(1000);
+	minui::span_data_source<test_item> source(contents);
+
+	for(uint32_t threads : { 1u, 2u, 4u, 8u }) {
+		test_root t(layered_columns(64));
+		auto& layer = *t.base().get_child(0);
+		for(uint32_t i = 0; i < layer.child_count(); ++i)
+			static_cast<minui::imonotype_container*>(layer.get_child(i)->get_interface(minui::iface::monotype_container))->set_data_source(&source);
+		t.r.request_update();
+		t.frame();
+		t.r.set_layout_threads(threads);
+
+		// alternate the height so that every pass repaginates the columns
+		int16_t height = 3000;
+		BENCHMARK("resize 64 columns, threads: " + std::to_string(threads)) {
+			height = height == 3000 ? 2800 : 3000;
+			layer.force_resize(t.r, minui::layout_position{ em{ 4000 }, em{ height } });
+			return layer.get_child(0)->child_count();
+		};
+	}
+}
+
+// an element's on_update function with a body of its own, like the synthetic update functions above
+static uint64_t element_update_sum = 0;
+template<uint32_t T>
+void mixing_element_update(minui::root&, minui::ui_node& n) {
+	element_update_sum += synthetic_mix<T>(uint64_t(n.position.x.value) << 16 | uint16_t(n.position.y.value), std::make_index_sequence<160>{ });
+}
+
+// panel_count panels on the base, each holding sixteen elements of four types that interleave, with a
+// function of their own for each type; update_flags go on the elements
+static test_definitions mixed_panels(uint32_t panel_count, uint32_t update_flags) {
+	using minui::em;
+	test_user_functions["mixed0"] = mixing_element_update<0>;
+	test_user_functions["mixed1"] = mixing_element_update<1>;
+	test_user_functions["mixed2"] = mixing_element_update<2>;
+	test_user_functions["mixed3"] = mixing_element_update<3>;
+	test_definitions d;
+	d.elements = {
+		test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } } },
+		test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 1600 }, em{ 100 } } }
+	};
+	d.elements[0].children.assign(panel_count, 1);
+	for(int16_t k = 0; k < 4; ++k) {
+		d.elements[1].children.push_back(uint16_t(d.elements.size()));
+		d.elements.push_back(test_definitions::element{ .position = minui::layout_rect{ em{ int16_t(k * 100) }, em{ 0 }, em{ 100 }, em{ 100 } }, .flags = update_flags, .on_update = "mixed" + std::to_string(k) });
+	}
+	for(uint32_t i = 0; i < 12; ++i)
+		d.elements[1].children.push_back(d.elements[1].children[i % 4]);
+	return d;
+}
+
+TEST_CASE("root update pass", "[.][benchmark]") {
+	for(auto [name, flags] : { std::pair{ "depth first", 0u }, std::pair{ "batched by type", minui::behavior::update_batched } }) {
+		test_root t(mixed_panels(512, flags));
+		REQUIRE(t.base().child_count() == 512);
+
+		BENCHMARK(std::string("512 panels of 16 elements, ") + name) {
+			element_update_sum = 0;
+			t.r.on_update();
+			return element_update_sum;
+		};
+		REQUIRE(t.r.update_pass.functions_batched == (flags != 0 ? 512u * 16u : 0u));
+	}
+}
+
+// Three columns on the base sharing one row element: two of the same short column and one taller.
+static test_definitions shared_row_columns(uint32_t row_flags) {
+	using minui::em;
+	test_definitions d;
+	d.elements = { test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } } } };
+	auto short_column = add_item_column(d, em{ 1100 }, row_flags);
+	auto tall_column = uint32_t(d.elements.size());
+	d.elements.push_back(d.elements[short_column]);
+	d.elements[tall_column].position.height = em{ 2000 };
+	d.column_properties.insert_or_assign(tall_column, d.column_properties[short_column]);
+	d.page_ui.insert_or_assign(tall_column, d.page_ui[short_column]);
+	d.child_data_types.insert_or_assign(tall_column, d.child_data_types[short_column]);
+	d.elements[0].children = { short_column, short_column, tall_column };
+	return d;
+}
+
+TEST_CASE("uniform row measurements", "root") {
+	using minui::em;
+	test_user_functions["row"] = [](minui::root&, minui::ui_node&) { };
+	std::vector<test_item> contents(100);
+	minui::span_data_source<test_item> source(contents);
+
+	test_root uniform(shared_row_columns(minui::behavior::layout_uniform_size));
+	test_root measured(shared_row_columns(0));
+	REQUIRE(uniform.r.measurement_cache.size() > 0);
+	for(auto t : { &uniform, &measured }) {
+		for(uint32_t i = 0; i < 3; ++i)
+			static_cast<minui::imonotype_container*>(t->base().get_child(i)->get_interface(minui::iface::monotype_container))->set_data_source(&source);
+		t->r.request_update();
+		t->frame();
+	}
+
+	// one measurement for each column height, so the two short columns share theirs
+	auto& short_column = *uniform.base().get_child(0);
+	auto& tall_column = *uniform.base().get_child(2);
+	auto row_type = short_column.get_child(0)->type_id;
+	auto space_in = [](minui::ui_node& column) {
+		auto controls = column.get_child(column.child_count() - 1);
+		return minui::layout_position{ column.position.width, column.position.height - controls->position.height };
+	};
+	REQUIRE(uniform.r.measurement_cache.size() == 2);
+	REQUIRE(uniform.r.find_measurement(row_type, space_in(short_column), 0));
+	REQUIRE(uniform.r.find_measurement(row_type, space_in(tall_column), 0));
+
+	// and each column pages exactly as it does when every row is measured
+	auto visible_rows = [](minui::ui_node& column) {
+		uint32_t count = 0;
+		for(uint32_t j = 0; j + 1 < column.child_count(); ++j) {
+			if((column.get_child(j)->behavior_flags & minui::behavior::functionally_hidden) == 0)
+				++count;
+		}
+		return count;
+	};
+	for(uint32_t i = 0; i < 3; ++i) {
+		REQUIRE(visible_rows(*uniform.base().get_child(i)) == visible_rows(*measured.base().get_child(i)));
+		REQUIRE(visible_rows(*uniform.base().get_child(i)) > 0);
+	}
+	REQUIRE(visible_rows(tall_column) > visible_rows(short_column));
+	std::vector<std::pair<minui::layout_rect, uint32_t>> expected;
+	std::vector<std::pair<minui::layout_rect, uint32_t>> found;
+	collect_layout(measured.base(), expected);
+	collect_layout(uniform.base(), found);
+	REQUIRE(found.size() == expected.size());
+	for(size_t i = 0; i < found.size(); ++i)
+		REQUIRE(found[i].first == expected[i].first);
+
+	// type ids may mean other elements after a reload
+	uniform.r.load_definitions(uniform.definitions.data(), uniform.definitions.size());
+	REQUIRE(uniform.r.measurement_cache.empty());
+}
+
+TEST_CASE("row measurements follow their items", "root") {
+	// each row shows as many lines as its item's value
+	test_user_functions["row"] = [](minui::root& r, minui::ui_node& n) {
+		auto item = minui::impl::get_local_data(r, &n, 1);
+		if(!item)
+			return;
+		minui::text::formatted_text ft;
+		for(int32_t i = 1; i < reinterpret_cast<test_item const*>(item)->value; ++i)
+			ft.text_content += NATIVE("\n");
+		auto& text = *static_cast<minui::istatic_text*>(n.get_interface(minui::iface::static_text));
+		text.set_is_multiline(r.system, true);
+		text.set_text(r.system, std::move(ft));
+	};
+	auto d = item_column();
+	minui::saved_text_information row_text{ };
+	row_text.type_id = 2;
+	row_text.multiline = true;
+	d.text_information = { row_text };
+	test_root t(d);
+	auto& column = *t.base().get_child(0);
+	auto& items = *static_cast<minui::imonotype_container*>(column.get_interface(minui::iface::monotype_container));
+
+	std::vector<test_item> contents(40);
+	for(int32_t i = 0; i < 40; ++i)
+		contents[i] = test_item{ 1 + i % 3, 0 };
+	minui::span_data_source<test_item> source(contents);
+	items.set_data_source(&source);
+
+	// every visible row is as tall as its own item asks, although rows with equal items share a measurement
+	auto check_rows = [&]() {
+		uint32_t visible = 0;
+		for(uint32_t i = 0; i + 1 < column.child_count(); ++i) {
+			auto& row = *column.get_child(i);
+			if((row.behavior_flags & minui::behavior::functionally_hidden) != 0)
+				continue;
+			auto item = reinterpret_cast<test_item const*>(items.get_item(row));
+			REQUIRE(item);
+			REQUIRE(row.position.height.value == 100 * item->value);
+			++visible;
+		}
+		return visible;
+	};
+	auto relayout = [&]() {
+		t.r.request_update();
+		t.frame();
+		column.force_resize(t.r, minui::layout_position{ column.position.width, column.position.height });
+	};
+	relayout();
+	auto visible = check_rows();
+	REQUIRE(visible > 3);
+	REQUIRE(t.r.measurement_cache.size() == 3);
+
+	// a changed item is measured again, not given the size it had
+	contents[0].value = 3;
+	source.touch();
+	relayout();
+	check_rows();
+	REQUIRE(column.get_child(0)->position.height.value == 300);
+}
+
+TEST_CASE("content past the em range", "root") {
+	using minui::em;
+	// a vertical space filler stacking 40 blocks of 10 icon buttons upwards from its bottom, 400 ems in
+	// all, behind its first child, the separator
+	test_definitions d;
+	d.elements = {
+		test_definitions::element{ .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 4000 }, em{ 3000 } }, .children = { 1 } },
+		test_definitions::element{ .class_id = 2, .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 1000 }, em{ 3000 } } },
+		test_definitions::element{ .class_id = 2, .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 1000 }, em{ 1000 } } },
+		test_definitions::element{ .class_id = 11, .position = minui::layout_rect{ em{ 0 }, em{ 0 }, em{ 100 }, em{ 100 } } }
+	};
+	d.elements[1].children.assign(41, 2);
+	d.elements[2].children.assign(10, 3);
+	test_root t(d);
+
+	auto& filler = *t.base().get_child(0);
+	REQUIRE(filler.child_count() == 41);
+	for(uint32_t k = 1; k <= 40; ++k) {
+		auto& block = *filler.get_child(k);
+		auto expected = 3000 - int32_t(k) * 1000;
+		REQUIRE(t.r.workspace_content_placement(block).y.value == expected);
+		REQUIRE(block.position.y == minui::to_em(minui::content_em{ expected }));
+		REQUIRE(block.position.height == em{ 1000 });
+	}
+	// and so are the descendants of a block past the range, which stacks its buttons the same way
+	auto& last_button = *filler.get_child(40)->get_child(9);
+	REQUIRE(t.r.workspace_content_placement(last_button).y.value == 3000 - 40 * 1000 + (1000 - 9 * 100));
+	REQUIRE(t.r.workspace_placement(last_button).y.value == INT16_MIN);
+
+	// the blocks in view are drawn where they are; the rest are clamped out of it
+	REQUIRE(filler.get_child(3)->position.y == em{ 0 });
+	REQUIRE(t.r.workspace_placement(*filler.get_child(40)).y.value == INT16_MIN);
+	REQUIRE(filler.minimum_height(t.r).value == INT16_MAX);
+}
+
+TEST_CASE("update pass visibility", "root") {
+	using minui::em;
+	static bool hide_panel = false;
+	static uint32_t shown = 0;
+	static uint32_t hidden = 0;
+	test_user_functions["hide_panel"] = [](minui::root&, minui::ui_node& n) {
+		if(hide_panel)
+			n.behavior_flags |= minui::behavior::visually_hidden;
+		else
+			n.behavior_flags &= ~minui::behavior::visually_hidden;
+	};
+	test_user_functions["count_shown"] = [](minui::root&, minui::ui_node&) { ++shown; };
+	test_user_functions["count_hidden"] = [](minui::root&, minui::ui_node&) { ++hidden; };
+
+	auto d = button_panels();
+	d.elements[4].on_update = "hide_panel";
+	for(auto i : { 4, 5, 6 }) {
+		d.elements[i].on_visible = "count_shown";
+		d.elements[i].on_hide = "count_hidden";
+	}
+	hide_panel = false;
+	shown = 0;
+	hidden = 0;
+	test_root t(d);
+
+	auto& panel = *t.base().get_child(3);
+	auto& inner = *panel.get_child(0);
+	t.r.post_mouse_move(minui::layout_position{ em{ 2500 }, em{ 300 } });
+	t.frame();
+	REQUIRE(minui::node_is_visible(t.r, inner));
+	REQUIRE(t.r.under_mouse.type_array[size_t(minui::mouse_interactivity::position)].node == &inner);
+
+	// the panel hides itself in its update, without telling the root
+	hide_panel = true;
+	t.r.request_update();
+	t.frame();
+	REQUIRE(!minui::node_is_visible(t.r, panel));
+	REQUIRE(!minui::node_is_visible(t.r, inner));
+	REQUIRE(hidden == 3);
+	REQUIRE(shown == 0);
+	// the probe is redone, so nothing hidden stays under the mouse
+	REQUIRE(t.r.under_mouse.type_array[size_t(minui::mouse_interactivity::position)].node != &inner);
+
+	// a pass that changes nothing sends nothing
+	t.r.request_update();
+	t.frame();
+	REQUIRE(hidden == 3);
+
+	hide_panel = false;
+	t.r.request_update();
+	t.frame();
+	REQUIRE(minui::node_is_visible(t.r, inner));
+	REQUIRE(shown == 3);
+	REQUIRE(t.r.under_mouse.type_array[size_t(minui::mouse_interactivity::position)].node == &inner);
+}
+
+TEST_CASE("steady state root frames allocate nothing", "root") {
+	test_root t(button_panels());
+	using minui::em;
+
+	// hover over each button in turn, and off them all, then redraw
+	std::vector<minui::layout_position> path{
+		{ em{ 500 }, em{ 200 } }, { em{ 500 }, em{ 500 } }, { em{ 500 }, em{ 800 } },
+		{ em{ 2500 }, em{ 300 } }, { em{ 2500 }, em{ 600 } }, { em{ 1500 }, em{ 2500 } } };
+	auto run_path = [&]() {
+		uint32_t drawn = 0;
+		for(auto p : path) {
+			t.r.post_mouse_move(p);
+			t.r.request_update();
+			drawn += t.frame() ? 1 : 0;
+			t.r.invalidate_all_rendering();
+			drawn += t.frame() ? 1 : 0;
+		}
+		return drawn;
+	};
+	// the first times through grow the retained lists, caches and command buffers to their working size
+	run_path();
+	run_path();
+
+	auto before = global_allocations.load();
+	auto drawn = run_path();
+	REQUIRE(drawn >= uint32_t(path.size()));
+	REQUIRE(global_allocations.load() == before);
+}
+
+static uint32_t reference_over(uint32_t d, uint32_t s) {
+	uint32_t inv = 255 - (s >> 24);
+	uint32_t result = 0;
+	for(uint32_t shift = 0; shift < 32; shift += 8) {
+		uint32_t v = ((s >> shift) & 0xFF) + (((d >> shift) & 0xFF) * inv + 127) / 255;
+		result |= std::min(v, uint32_t(255)) << shift;
+	}
+	return result;
+}
+
+TEST_CASE("software rasterizer spans", "headless") {
+	// odd lengths so that the vector loops and the scalar tails both run
+	std::vector<uint32_t> source(37);
+	std::vector<uint32_t> dest(37);
+	std::vector<uint8_t> coverage(37);
+	for(uint32_t i = 0; i < 37; ++i) {
+		uint8_t a = uint8_t(i * 7);
+		source[i] = minui::headless::pack_rgba(uint8_t(a * (i % 3) / 2), uint8_t(a / 3), a, a);
+		dest[i] = minui::headless::pack_rgba(uint8_t(i * 5), uint8_t(200 - i), uint8_t(i * 3), 255);
+		coverage[i] = uint8_t(i * 11);
+	}
+
+	auto pixels = dest;
+	minui::headless::spans::blend_pixels(pixels.data(), source.data(), 37);
+	for(uint32_t i = 0; i < 37; ++i)
+		REQUIRE(pixels[i] == reference_over(dest[i], source[i]));
+
+	pixels = dest;
+	auto color = minui::headless::pack_rgba(64, 0, 128, 128);
+	minui::headless::spans::blend_solid(pixels.data(), 37, color);
+	for(uint32_t i = 0; i < 37; ++i)
+		REQUIRE(pixels[i] == reference_over(dest[i], color));
+
+	pixels = dest;
+	minui::headless::spans::blend_mask(pixels.data(), coverage.data(), 37, color);
+	for(uint32_t i = 0; i < 37; ++i) {
+		uint32_t scaled = 0;
+		for(uint32_t shift = 0; shift < 32; shift += 8)
+			scaled |= ((((color >> shift) & 0xFF) * coverage[i] + 127) / 255) << shift;
+		REQUIRE(pixels[i] == reference_over(dest[i], scaled));
+	}
+
+	minui::headless::spans::fill(pixels.data(), 37, color);
+	for(auto p : pixels)
+		REQUIRE(p == color);
+}
+
+TEST_CASE("software rasterizer", "headless") {
+	minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 2000 }, minui::em{ 1000 } }, 20);
+	s.add_color_brush(0, minui::brush_color{ 1.0f, 0.0f, 0.0f, 1.0f }, false);
+	s.add_color_brush(0, minui::brush_color{ 0.0f, 1.0f, 0.0f, 1.0f }, true);
+	s.add_color_brush(1, minui::brush_color{ 0.0f, 0.0f, 1.0f, 0.5f }, false);
+	s.set_brush_highlights(0, 0.0f, 0.5f, 0.0f);
+
+	auto black = minui::headless::pack_rgba(0, 0, 0, 255);
+	auto red = minui::headless::pack_rgba(255, 0, 0, 255);
+	auto green = minui::headless::pack_rgba(0, 255, 0, 255);
+	minui::headless::rasterizer r(64, 48);
+	r.clear(black);
+
+	SECTION("rectangles and shading") {
+		s.rectangle(minui::screen_space_rect{ 0, 0, 10, 10 }, minui::rendering_modifiers::none, 0);
+		s.rectangle(minui::screen_space_rect{ 10, 0, 10, 10 }, minui::rendering_modifiers::disabled, 0);
+		s.rectangle(minui::screen_space_rect{ 20, 0, 10, 10 }, minui::rendering_modifiers::none, 1);
+		s.rectangle(minui::screen_space_rect{ 30, 0, 10, 10 }, minui::rendering_modifiers::highlighted, 0);
+		r.draw(s);
+
+		REQUIRE(r.pixel(5, 5) == red);
+		REQUIRE(r.pixel(15, 5) == green);
+		REQUIRE(r.pixel(25, 5) == minui::headless::pack_rgba(0, 0, 128, 255));
+		REQUIRE(r.pixel(35, 5) == minui::headless::pack_rgba(255, 128, 128, 255));
+		REQUIRE(r.pixel(45, 5) == black);
+		REQUIRE(r.pixel(5, 10) == black);
+	}
+	SECTION("clip commands and regions") {
+		s.set_clip(minui::screen_space_rect{ 0, 0, 5, 5 }, true);
+		s.rectangle(minui::screen_space_rect{ 0, 0, 20, 20 }, minui::rendering_modifiers::none, 0);
+		s.set_clip(minui::screen_space_rect{ 0, 0, 0, 0 }, false);
+		s.rectangle(minui::screen_space_rect{ 30, 0, 20, 20 }, minui::rendering_modifiers::none, 0);
+		r.draw(s, minui::screen_space_rect{ 0, 0, 40, 48 });
+
+		REQUIRE(r.pixel(4, 4) == red);
+		REQUIRE(r.pixel(5, 4) == black);
+		REQUIRE(r.pixel(39, 4) == red);
+		REQUIRE(r.pixel(40, 4) == black);
+	}
+	SECTION("icons, images and backgrounds") {
+		minui::headless::bitmap mask(2, 2);
+		mask.pixels[0] = minui::headless::pack_rgba(0, 0, 0, 255);
+		mask.pixels[3] = minui::headless::pack_rgba(0, 0, 0, 255);
+		r.set_icon(minui::icon_handle{ 1 }, 0, std::move(mask));
+		s.icon(minui::icon_handle{ 1 }, minui::screen_space_rect{ 0, 0, 4, 4 }, 0);
+
+		// quadrants of distinct colors; the 9-slice keeps each corner in its own corner
+		minui::headless::bitmap img(4, 4);
+		for(int32_t y = 0; y < 4; ++y) {
+			for(int32_t x = 0; x < 4; ++x)
+				img.pixels[y * 4 + x] = minui::headless::pack_rgba(x < 2 ? 255 : 0, y < 2 ? 255 : 0, 0, 255);
+		}
+		r.set_image(minui::image_handle{ 2 }, 0, img);
+		s.background(minui::image_handle{ 2 }, 0, minui::screen_space_rect{ 10, 10, 20, 20 }, minui::layout_rect{ minui::em{ 512 }, minui::em{ 512 }, minui::em{ 512 }, minui::em{ 512 } });
+		s.image(minui::image_handle{ 2 }, minui::screen_space_rect{ 40, 0, 8, 8 });
+		r.draw(s);
+
+		REQUIRE(r.pixel(0, 0) == red);
+		REQUIRE(r.pixel(3, 3) == red);
+		REQUIRE(r.pixel(3, 0) == black);
+		REQUIRE(r.pixel(10, 10) == minui::headless::pack_rgba(255, 255, 0, 255));
+		REQUIRE(r.pixel(29, 10) == minui::headless::pack_rgba(0, 255, 0, 255));
+		REQUIRE(r.pixel(10, 29) == minui::headless::pack_rgba(255, 0, 0, 255));
+		REQUIRE(r.pixel(29, 29) == minui::headless::pack_rgba(0, 0, 0, 255));
+		REQUIRE(r.pixel(40, 0) == minui::headless::pack_rgba(255, 255, 0, 255));
+		REQUIRE(r.pixel(47, 7) == minui::headless::pack_rgba(0, 0, 0, 255));
+	}
+	SECTION("lines and text") {
+		s.line(minui::screen_space_point{ 0, 40 }, minui::screen_space_point{ 30, 40 }, 0.05f, 0);
+
+		r.set_glyph(NATIVE('a'), minui::headless::bitmap(1, 1, minui::headless::pack_rgba(0, 0, 0, 255)));
+		headless_test_node n;
+		minui::headless::static_text t(n);
+		minui::text::formatted_text ft;
+		ft.text_content = NATIVE("a a");
+		t.set_text(s, std::move(ft));
+		t.render(s, minui::layout_rect{ minui::em{ 0 }, minui::em{ 100 }, minui::em{ 300 }, minui::em{ 100 } }, 0);
+		r.draw(s);
+
+		REQUIRE(r.pixel(15, 40) == red);
+		REQUIRE(r.pixel(15, 41) == black);
+		REQUIRE(r.pixel(35, 40) == black);
+		// cells are 10 x 20 pixels: 'a', a space without a glyph, then 'a'
+		REQUIRE(r.pixel(5, 30) == red);
+		REQUIRE(r.pixel(15, 30) == black);
+		REQUIRE(r.pixel(25, 30) == red);
+		REQUIRE(r.pixel(35, 30) == black);
+	}
+}
+
+// overlapping translucent shapes, lines and icons that straddle tile edges
+static void record_tiling_scene(minui::headless::system& s, int32_t shift) {
+	s.commands.clear();
+	for(int32_t i = 0; i < 40; ++i) {
+		s.set_line_highlight_mode(i % 3 == 0);
+		auto x = (i * 37 + shift) % 300;
+		auto y = (i * 53) % 200;
+		s.rectangle(minui::screen_space_rect{ x, y, 70, 45 }, i % 4 == 0 ? minui::rendering_modifiers::highlighted : minui::rendering_modifiers::none, uint16_t(i % 2));
+		s.icon(minui::icon_handle{ 0 }, minui::screen_space_rect{ x + 60, y + 30, 16, 16 }, 0);
+		s.line(minui::screen_space_point{ x, y }, minui::screen_space_point{ x + 90, y + 55 }, 0.1f, 0);
+	}
+	s.set_clip(minui::screen_space_rect{ 100, 50, 130, 100 }, true);
+	s.rectangle(minui::screen_space_rect{ 0, 0, 320, 240 }, minui::rendering_modifiers::none, 1);
+	s.set_clip(minui::screen_space_rect{ 0, 0, 0, 0 }, false);
+}
+
+TEST_CASE("tiled rasterization", "headless") {
+	minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 1600 }, minui::em{ 1200 } }, 20);
+	s.add_color_brush(0, minui::brush_color{ 0.8f, 0.2f, 0.1f, 1.0f }, false);
+	s.add_color_brush(1, minui::brush_color{ 0.1f, 0.4f, 0.9f, 0.6f }, false);
+	s.set_brush_highlights(0, 0.2f, 0.4f, 0.1f);
+
+	minui::headless::bitmap mask(16, 16);
+	for(size_t i = 0; i < mask.pixels.size(); ++i)
+		mask.pixels[i] = minui::headless::pack_rgba(0, 0, 0, uint8_t(i * 7));
+	auto background = minui::headless::pack_rgba(10, 20, 30, 255);
+
+	minui::headless::rasterizer reference(320, 240);
+	reference.set_icon(minui::icon_handle{ 0 }, 0, mask);
+	minui::headless::rasterizer tiled(320, 240);
+	tiled.set_icon(minui::icon_handle{ 0 }, 0, mask);
+	tiled.tile_size = 48; // leaves partial tiles at the right and bottom edges
+
+	SECTION("matches the untiled replay for any thread count") {
+		for(bool ltr : { true, false }) {
+			s.left_to_right = ltr;
+			record_tiling_scene(s, 0);
+			reference.clear(background);
+			reference.draw(s);
+			for(uint32_t threads : { 1u, 2u, 4u, 8u }) {
+				minui::task_pool pool(threads);
+				tiled.clear(0);
+				tiled.draw_tiled(s, pool, background);
+				REQUIRE(tiled.tiles_drawn == 7 * 5);
+				REQUIRE(tiled.pixels == reference.pixels);
+			}
+		}
+	}
+	SECTION("only damaged tiles are redrawn") {
+		minui::task_pool pool(4);
+		record_tiling_scene(s, 0);
+		tiled.draw_tiled(s, pool, background);
+
+		// moving the scene damages everything, but only the damaged tiles may change
+		record_tiling_scene(s, 5);
+		reference.clear(background);
+		reference.draw(s);
+		auto before = tiled.pixels;
+		minui::screen_space_rect damaged[] = { minui::screen_space_rect{ 50, 50, 10, 10 }, minui::screen_space_rect{ 200, 100, 60, 10 } };
+		tiled.draw_tiled(s, pool, background, damaged);
+		REQUIRE(tiled.tiles_drawn == 3);
+		for(int32_t y = 0; y < 240; ++y) {
+			for(int32_t x = 0; x < 320; ++x) {
+				bool redrawn = (y / 48 == 1 && x / 48 == 1) || (y / 48 == 2 && (x / 48 == 4 || x / 48 == 5));
+				auto i = size_t(y) * 320 + size_t(x);
+				if(redrawn)
+					REQUIRE(tiled.pixels[i] == reference.pixels[i]);
+				else
+					REQUIRE(tiled.pixels[i] == before[i]);
+			}
+		}
+
+		tiled.draw_tiled(s, pool, background, std::span<const minui::screen_space_rect>{ });
+		REQUIRE(tiled.tiles_drawn == 0);
+	}
+}
+
+TEST_CASE("software rasterizer throughput", "[.][benchmark]") {
+	minui::headless::system s(std::filesystem::path("."), minui::layout_position{ minui::em{ 9600 }, minui::em{ 5400 } }, 20);
+	s.add_color_brush(0, minui::brush_color{ 0.2f, 0.3f, 0.4f, 1.0f }, false);
+	s.add_color_brush(1, minui::brush_color{ 1.0f, 1.0f, 1.0f, 0.5f }, false);
+	s.set_brush_highlights(0, 0.1f, 0.2f, 0.3f);
+
+	minui::headless::rasterizer r(1920, 1080);
+	minui::headless::bitmap mask(32, 32);
+	for(size_t i = 0; i < mask.pixels.size(); ++i)
+		mask.pixels[i] = minui::headless::pack_rgba(0, 0, 0, uint8_t(i * 13));
+	r.set_icon(minui::icon_handle{ 0 }, 0, std::move(mask));
+
+	BENCHMARK("1920x1080 clear") {
+		r.clear(minui::headless::pack_rgba(0, 0, 0, 255));
+		return r.pixels[0];
+	};
+	s.rectangle(minui::screen_space_rect{ 0, 0, 1920, 1080 }, minui::rendering_modifiers::none, 1);
+	BENCHMARK("1920x1080 translucent rectangle") {
+		r.draw(s);
+		return r.pixels[0];
+	};
+
+	// a screen of buttons: background, highlight shading on every other row, and an icon
+	s.commands.clear();
+	for(int32_t y = 0; y < 1080; y += 40) {
+		s.set_line_highlight_mode((y / 40) % 2 == 1);
+		for(int32_t x = 0; x < 1920; x += 160) {
+			s.rectangle(minui::screen_space_rect{ x, y, 150, 36 }, minui::rendering_modifiers::none, 0);
+			s.icon(minui::icon_handle{ 0 }, minui::screen_space_rect{ x + 4, y + 2, 32, 32 }, 1);
+		}
+	}
+	BENCHMARK("1920x1080 button grid") {
+		r.draw(s);
+		return r.pixels[0];
+	};
+	for(uint32_t threads : { 1u, 2u, 4u, 8u }) {
+		minui::task_pool pool(threads);
+		BENCHMARK("1920x1080 button grid, tiled, threads: " + std::to_string(threads)) {
+			r.draw_tiled(s, pool, minui::headless::pack_rgba(0, 0, 0, 255));
+			return r.pixels[0];
+		};
+	}
+}